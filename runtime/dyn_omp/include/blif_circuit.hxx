@@ -27,15 +27,17 @@
 #ifndef __BLIF_CIRCUIT_HXX__
 #define __BLIF_CIRCUIT_HXX__
 
+#include <stdint.h>
+#include <limits>
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <boost/graph/adjacency_list.hpp>
+#include <utility>
 
 /**
  * @brief Gate types
  */
-enum class GateType {
+enum class GateType: uint8_t {
   UNDEF     = 0,
 
   INPUT     = 1,
@@ -45,7 +47,14 @@ enum class GateType {
   XOR       = 5,
   OR        = 6,
   NOT       = 7,
-  BUFF      = 8
+  BUFF      = 8,
+  NAND      = 9,
+  NOR       = 10,
+  XNOR      = 11,
+  ANDNY     = 12,   /* (NOT a) AND b */
+  ANDYN     = 13,   /* a AND (NOT b) */
+  ORNY      = 14,   /* (NOT a) OR b */
+  ORYN      = 15    /* a OR (NOT b) */
 };
 
 /**
@@ -65,17 +74,121 @@ struct GateProperties {
 };
 
 /**
- * Boost graph based on adjacency list for representing circuits
+ * @brief Frozen boolean circuit in compressed sparse row form
+ * @details Gates are numbered densely in topological order, predecessors
+ *    of a gate have smaller numbers, so that per-gate data can be kept in
+ *    flat arrays. Fan-in and fan-out lists are stored as CSR arrays
+ *    (offsets and concatenated gate numbers), fan-ins in the order of
+ *    the gate inputs. A predecessor used twice appears twice. Gate types
+ *    and output flags are packed arrays, gate names are only needed for
+ *    input and output files.
  */
-typedef boost::adjacency_list<
-   boost::vecS, boost::vecS, boost::bidirectionalS,
-   GateProperties> Circuit;
+class Circuit {
+  public:
+    typedef unsigned int vertex_descriptor;
+
+    /**
+     * @brief Contiguous list of gates, e.g. a fan-in
+     */
+    class Range {
+      private:
+        const vertex_descriptor* first;
+        const vertex_descriptor* last;
+
+      public:
+        Range(const vertex_descriptor* first_p, const vertex_descriptor* last_p):
+          first(first_p), last(last_p) {}
+
+        const vertex_descriptor* begin() const { return first; }
+        const vertex_descriptor* end() const { return last; }
+        unsigned int size() const { return last - first; }
+        vertex_descriptor operator[](const unsigned int i) const { return first[i]; }
+    };
+
+  private:
+    std::vector<std::string> ids;
+    std::vector<GateType> types;
+    std::vector<uint8_t> outputs;
+
+    /* Fan-in (fan-out) of gate i is fanins[faninOffsets[i]..faninOffsets[i+1]) */
+    std::vector<unsigned int> faninOffsets;
+    std::vector<vertex_descriptor> fanins;
+    std::vector<unsigned int> fanoutOffsets;
+    std::vector<vertex_descriptor> fanouts;
+
+  public:
+    /**
+     * @brief Build circuit from a gate list and edges between them
+     * @details Gates are renumbered in a topological order close to
+     *    the order of \c gates, gates without inputs come just before
+     *    their first successor
+     *
+     * @param gates gate properties, in any order
+     * @param edges (source, destination) indexes in \c gates, in the
+     *    order of the destination gate inputs
+     */
+    Circuit(const std::vector<GateProperties>& gates,
+        const std::vector<std::pair<unsigned int, unsigned int>>& edges);
+
+    /**
+     * @brief Value used for no gate
+     */
+    static vertex_descriptor null_vertex() {
+      return std::numeric_limits<vertex_descriptor>::max();
+    }
+
+    /**
+     * @brief Number of gates
+     */
+    unsigned int size() const { return types.size(); }
+
+    const std::string& id(const vertex_descriptor node) const { return ids[node]; }
+    GateType type(const vertex_descriptor node) const { return types[node]; }
+    bool isOutput(const vertex_descriptor node) const { return outputs[node]; }
+
+    /**
+     * @brief Change gate type, e.g. of an input with a plain-text value
+     */
+    void setType(const vertex_descriptor node, const GateType type) {
+      types[node] = type;
+    }
+
+    Range fanin(const vertex_descriptor node) const {
+      return Range(fanins.data() + faninOffsets[node], fanins.data() + faninOffsets[node + 1]);
+    }
+
+    Range fanout(const vertex_descriptor node) const {
+      return Range(fanouts.data() + fanoutOffsets[node], fanouts.data() + fanoutOffsets[node + 1]);
+    }
+
+    unsigned int inDegree(const vertex_descriptor node) const {
+      return faninOffsets[node + 1] - faninOffsets[node];
+    }
+
+    unsigned int outDegree(const vertex_descriptor node) const {
+      return fanoutOffsets[node + 1] - fanoutOffsets[node];
+    }
+};
+
+/**
+ * @brief Gate type of a BLIF cover
+ * @details Rows give either the on-set or the off-set of the function.
+ *  Inputs the function does not depend on are dropped, 1-input gates
+ *  take their input first.
+ *
+ * @param[in] ttToken cover rows separated by ';'
+ * @param[in] inpCnt number of gate inputs, at most 2
+ * @param[out] support positions of the gate inputs which are kept
+ * @return gate type
+ */
+GateType parseTruthTableString(const std::string& ttToken, const unsigned int inpCnt,
+    std::vector<unsigned int>& support);
 
 /**
- * @brief Read blif file into boost graph
+ * @brief Read blif file into a circuit
  * 
  * @param[in] fn input file name
- * @return boost graph
+ * @return circuit
  */
 Circuit ReadBlifFile(const std::string& fn);
 
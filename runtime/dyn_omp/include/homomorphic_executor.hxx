@@ -30,21 +30,27 @@
 #include "blif_circuit.hxx"
 
 #include <unordered_map>
+#include <map>
 #include <string>
 #include <mutex>
 #include <chrono>
 #include <atomic>
+#include <vector>
 
 class HomomorphicExecutor {
   private:
     /* Executed circuit */
-    Circuit circuit;
+    const Circuit& circuit;
 
-    /* Homomorphic keys, ciphertexts, constants and parameters */
+    /* Homomorphic keys, ciphertext of each gate, constants and parameters */
     KeysShare* keys;
-    std::unordered_map<Circuit::vertex_descriptor, CipherText*> cipherTxts;
-    CipherText* ct_const_0;
-    CipherText* ct_const_1;
+    std::vector<CipherText*> cipherTxts;
+    std::vector<CipherText*> ct_const_0;
+    std::vector<CipherText*> ct_const_1;
+
+    /* Modulus level of each gate output, see FheParams::ModChain, empty
+        when ciphertexts are not switched */
+    std::vector<unsigned int> modLevels;
 
     /* Execution logs */
     std::unordered_map<std::string, double> execTime;
@@ -53,7 +59,7 @@ class HomomorphicExecutor {
 
     /* Number of allocated ciphertexts */
     std::atomic<int> allocatedCnt;
-    int maxAllocatedCnt = 0;
+    std::atomic<int> maxAllocatedCnt;
 
     /* Verbose flag and logging mutex */
     bool verbose;
@@ -70,9 +76,9 @@ class HomomorphicExecutor {
     void updateMeasures(const std::chrono::steady_clock::time_point& start, const std::string& name);
 
     /**
-     * @brief Prints out \c gate properties, used for logging
+     * @brief Prints out gate \c idx properties, used for logging
      */
-    void printGateInfo(const GateProperties& gate,
+    void printGateInfo(const Circuit::vertex_descriptor idx,
         const Circuit::vertex_descriptor pred1 = Circuit::null_vertex(),
         const Circuit::vertex_descriptor pred2 = Circuit::null_vertex());
 
@@ -96,9 +102,27 @@ class HomomorphicExecutor {
      */
     void Write(CipherText*& ct, const std::string& fn);
 
+    /**
+     * @brief Switches ciphertext \c ct down to the modulus level of
+     *    gate \c idx, if it is not already there
+     */
+    void ModSwitch(CipherText*& ct, const Circuit::vertex_descriptor idx);
+
+    /**
+     * @brief Computes the modulus level of each gate
+     * @details Gate outputs go through at most \c d multiplications
+     *    (AND, OR and, when the plaintext modulus is not 2, XOR gates)
+     *    on any path to circuit outputs, so they can be switched down to
+     *    level \c{FheParams::modLevel(d)}
+     */
+    void computeModLevels();
+
     /**
      * @brief Execute XOR gate
-     * @details \code{ct_res = ct_n1 XOR ct_n2}
+     * @details \code{ct_res = ct_n1 XOR ct_n2}, \c ct_res can be one of
+     *    the input ciphertexts (same for other gates). Gates use
+     *    arithmetic forms (e.g. \c{a + b - 2ab}) when the plaintext
+     *    modulus is not 2, as needed with slot batching.
      */
     void ExecuteXOR(
       CipherText *&ct_res,
@@ -130,20 +154,37 @@ class HomomorphicExecutor {
       CipherText *&ct_res,
       const CipherText* const ct_n1,
       const CipherText* const ct_n2);
+
+    /**
+     * @brief Execute gate with a negated input or output (NAND, NOR,
+     *    XNOR, ANDNY, ANDYN, ORNY or ORYN)
+     * @details Gates use a single multiplication and linear terms, e.g.
+     *    \code{ANDNY(ct_n1, ct_n2) = ct_n2 - ct_n1 * ct_n2}. XNOR does
+     *    not multiply when the plaintext modulus is 2.
+     */
+    void ExecuteNegated(
+      const GateType type,
+      CipherText *&ct_res,
+      const CipherText* const ct_n1,
+      const CipherText* const ct_n2);
   
   public:
     /**
      * @brief Builds a homomorphic executor object
      * 
-     * @param[in] circuit boolean circuit to execute homomorphically
+     * @param[in] circuit boolean circuit to execute homomorphically, it
+     *    must outlive the executor
      * @param[in] evalKeyFile evaluation key file name
      * @param[in] publicKeyFile public key file name
      * @param[in] verbose_p verbose execution
      * @param[in] stringOutput write outputs in string format
+     * @param[in] modSwitch switch ciphertexts to smaller moduli as the
+     *    remaining multiplicative depth decreases (RNS representation only)
      */
     HomomorphicExecutor(const Circuit& circuit,
               const std::string& evalKeyFile, const std::string& publicKeyFile,
-              const bool verbose_p, const bool stringOutput);
+              const bool verbose_p, const bool stringOutput,
+              const bool modSwitch = true);
 
     /**
      * @brief Destructs homomorphic executor object
@@ -157,8 +198,21 @@ class HomomorphicExecutor {
 
     /**
      * @brief Executes gate \c idx
+     * @details If \c reuse is not null, it is a predecessor of \c idx
+     *    which is not used anymore; its ciphertext is taken over and
+     *    used as output buffer, it is not copied
+     */
+    void ExecuteGate(const Circuit::vertex_descriptor idx,
+        const Circuit::vertex_descriptor reuse = Circuit::null_vertex());
+
+    /**
+     * @brief Measures the execution time of each gate type
+     * @details Logic gates are executed \c reps times
+     *    on fresh encryptions at the largest modulus, after a first
+     *    warm-up execution. The shortest time is kept, in seconds.
+     *    These executions are not logged.
      */
-    void ExecuteGate(const Circuit::vertex_descriptor idx);
+    std::map<GateType, double> measureGateCosts(const unsigned int reps = 3);
 
     /**
      * @brief Prints logged information about execution
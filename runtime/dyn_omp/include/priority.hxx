@@ -28,8 +28,9 @@
 
 #include "blif_circuit.hxx"
 
-#include <unordered_map>
-#include <boost/graph/adjacency_list.hpp>
+#include <map>
+#include <vector>
+#include <mutex>
 
 class Priority {
   public:
@@ -39,7 +40,8 @@ class Priority {
 
 class PriorityStatic: public Priority {
   protected:
-    std::unordered_map<Circuit::vertex_descriptor, int> priorities;
+    /* Priority of each gate */
+    std::vector<int> priorities;
   public:
     virtual int value(const Circuit::vertex_descriptor node) = 0;
 };
@@ -68,7 +70,10 @@ class PriorityInverseTopological: public PriorityStatic {
 class PriorityEarliest: public PriorityStatic {
   private:
     int lastValue = 0;
+    std::vector<bool> assigned;
+    std::mutex mtx;
   public:
+    PriorityEarliest(const Circuit& circuit);
     virtual int value(const Circuit::vertex_descriptor node);
 };
 
@@ -78,7 +83,10 @@ class PriorityEarliest: public PriorityStatic {
 class PriorityLatest: public PriorityStatic {
   private:
     int lastValue = 0;
+    std::vector<bool> assigned;
+    std::mutex mtx;
   public:
+    PriorityLatest(const Circuit& circuit);
     virtual int value(const Circuit::vertex_descriptor node);
 };
 
@@ -100,4 +108,18 @@ class PriorityMinOutDegree: public PriorityStatic {
     virtual int value(const Circuit::vertex_descriptor node);
 };
 
+/**
+ * @brief Node with the longest path to circuit outputs takes precedence
+ * @details Paths are weighted by the execution time of their gates,
+ *    \c costs gives it for each gate type (0 for missing types). Gates
+ *    on the critical path are executed first, which shortens the
+ *    makespan when more threads than critical gates are available.
+ */
+class PriorityCriticalPath: public PriorityStatic {
+  public:
+    PriorityCriticalPath(const Circuit& circuit,
+        const std::map<GateType, double>& costs);
+    virtual int value(const Circuit::vertex_descriptor node);
+};
+
 #endif
@@ -29,13 +29,37 @@
 #include "blif_circuit.hxx"
 #include "priority.hxx"
 
+#include <stdint.h>
+#include <atomic>
+#include <deque>
 #include <queue>
-#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
-#include <boost/graph/adjacency_list.hpp>
 
+/**
+ * @brief Decentralised work-stealing scheduler
+ * @details There is no scheduling thread: each worker has a deque of
+ *    ready operations. The worker which finishes a gate decrements the
+ *    atomic counters of its predecessors and successors and pushes the
+ *    ready successors (and the dead predecessors to delete) to its own
+ *    deque, highest priority last. Workers pop the back of their deque
+ *    and steal from the front of the others when it is empty.
+ *
+ *    With a budget of simultaneously allocated ciphertexts, operations
+ *    are taken in the same order as without one as long as the budget
+ *    allows, so that a budget not below the peak of the unbudgeted
+ *    schedule leaves it unchanged with a single worker. An input read
+ *    which leaves less than one ciphertext per worker in the budget is
+ *    admitted only if a consumer can follow without allocating, as
+ *    workers read inputs in parallel. Once the budget is reached,
+ *    operations which do not allocate (deletes and gates taking over the
+ *    ciphertext of a dead predecessor) are taken first, then gates
+ *    retiring a predecessor, other gates and input reads, from a
+ *    priority queue per class. The budget is only exceeded when nothing
+ *    else can progress, i.e. when no operation is running and all ready
+ *    gates allocate.
+ */
 class Scheduler {
   public:
     /**
@@ -48,60 +72,109 @@ class Scheduler {
         Delete,
         Done
       } type;
+
+      /* Predecessor whose ciphertext can be reused as output buffer
+          (\c node is its last successor), null vertex otherwise */
+      Circuit::vertex_descriptor reuse;
     };
     
   private:
-    /** 
-     * @brief Class used for comparing task priorities in the wait queue
-     */
-    class PriorityComparator {
-      private:
-        Priority* priority = nullptr;
-        
-      public:
-        PriorityComparator(Priority* const priority_p): priority(priority_p) {}
-
-        bool operator()(const Operation& x, const Operation& y) {
-          return priority->value(x.node) < priority->value(y.node);
-        }
+    /**
+     * @brief Deque of ready operations of a worker
+     */
+    struct WorkQueue {
+      std::deque<Operation> opers;
+      std::mutex mtx;
     };
-    
+
+    /**
+     * @brief Queued operation in a budget class, highest priority first
+     */
+    struct BudgetEntry {
+      int prio;
+      Operation oper;
+
+      bool operator<(const BudgetEntry& other) const {
+        return prio < other.prio;
+      }
+    };
+
+    /* Queued state of a gate: its operation waiting in a deque */
+    enum Queued: uint8_t {
+      NONE,
+      DELETE,
+      EXECUTE,
+      ALLOCATE
+    };
+
   private:
-    Circuit circuit;
+    const Circuit& circuit;
+    Priority* priority;
 
     /* Number of gate successors/predecessors remaining to execute */
-    std::unordered_map<Circuit::vertex_descriptor, int> succ2ExecCnt;
-    std::unordered_map<Circuit::vertex_descriptor, int> pred2ExecCnt;    
-
-    /* Queue of finished schedule operations and synchronization variables */
-    std::queue<Operation> finishedQueue;
-    std::mutex finishedQueueMtx;
-    std::condition_variable finishedQueueCond;
-
-    /* Priority queue for available schedule operations and synchronization variables */
-    std::priority_queue<Operation, std::vector<Operation>, PriorityComparator> waitQueue;
-    std::mutex waitQueueMtx;
-    std::condition_variable waitQueueCond;
-    
-    unsigned int executedCnt = 0;
+    std::vector<std::atomic<int>> succ2ExecCnt;
+    std::vector<std::atomic<int>> pred2ExecCnt;
+
+    /* Worker deques, number of operations they hold and of operations
+        taken and not done yet */
+    std::vector<WorkQueue> queues;
+    std::vector<std::atomic<uint8_t>> queued;
+    std::atomic<unsigned int> queuedCnt;
+    std::atomic<unsigned int> runningCnt;
+
+    /* Budget of simultaneously allocated ciphertexts (0 for no limit),
+        number of allocated ciphertexts and of budget overruns */
+    const unsigned int maxLive;
+    std::atomic<unsigned int> liveCnt;
+    std::atomic<unsigned int> overrunCnt;
+
+    /* Gates whose ciphertext is taken over by a successor */
+    std::vector<uint8_t> taken;
+
+    /* With a budget, queued operations by budget class too. Entries of
+        operations taken from deques are dropped when found, operations
+        whose class decreases are added again to their new class */
+    std::vector<std::priority_queue<BudgetEntry>> budgetQueues;
+    std::mutex budgetMtx;
+
+    /* Idle workers wait for a state change (new operations or, with a
+        budget, finished ones) or for the end of execution */
+    std::atomic<unsigned int> epoch;
+    std::atomic<unsigned int> sleepingCnt;
+    std::mutex sleepMtx;
+    std::condition_variable sleepCond;
+
+    std::atomic<unsigned int> executedCnt;
 
   public:
     /**
-     * @brief Initialize scheduler object
+     * @brief Initialize scheduler object for \c nrWorkers workers
+     * @details \c circuit must outlive the scheduler
+     *
+     * @param maxLive maximal number of simultaneously allocated
+     *    ciphertexts, 0 for no limit
      */
-    Scheduler(const Circuit& circuit, Priority* const priority_p);
+    Scheduler(const Circuit& circuit, Priority* const priority_p,
+        const unsigned int nrWorkers = 1, const unsigned int maxLive = 0);
 
-    /** @brief Get next operation to schedule
+    /** @brief Get next operation to schedule for worker \c worker,
+     *    waits until one is ready
      */
-    Operation next();
+    Operation next(const unsigned int worker);
 
-    /** @brief Notify operation finished
+    /** @brief Notify operation (execute or delete) finished by worker
+     *    \c worker
      */
-    void done(const Operation& oper);
+    void done(const unsigned int worker, const Operation& oper);
 
-    /** @brief Execute scheduling loop
+    /** @brief Return the number of operations waiting for a thread
      */
-    void doSchedule();
+    unsigned int pending();
+
+    /** @brief Return the number of gates executed over the ciphertext
+     *    budget
+     */
+    unsigned int overruns();
 
   private:
 
@@ -111,34 +184,101 @@ class Scheduler {
     void initScheduler();
 
     /**
-     * @brief Gets next finished operation
+     * @brief Pop the back of the worker deque or steal the front of
+     *    another one
+     * @param force take a gate over the ciphertext budget if needed
+     * @return false if no operation can be taken
      */
-    Operation popFinishedQueue();
+    bool popOrSteal(const unsigned int worker, Operation& oper,
+        const bool force = false);
 
     /**
-     * @brief Push a schedule operation corresponding to \c node to the wait queue
+     * @brief Returns true if \c oper allocates a ciphertext
      */
-    void pushWaitQueue(const Circuit::vertex_descriptor node, const Operation::Type type);
+    static bool allocates(const Operation& oper);
 
     /**
-     * @brief Specialization of \c pushWaitQueue for delete operations
+     * @brief Reserve the ciphertext allocated by \c oper, if any,
+     *    within the budget
+     * @return false if \c oper must wait
      */
-    void pushDeleteCmd(const Circuit::vertex_descriptor node);
-    
+    bool admit(const Operation& oper);
+
+    /**
+     * @brief Cancel the reservation of @c admit
+     */
+    void unadmit(const Operation& oper);
+
+    /**
+     * @brief Queued state of \c oper while it waits in a deque
+     */
+    static Queued queuedState(const Operation& oper);
+
+    /**
+     * @brief Take \c oper, found in a deque or a budget class
+     * @return false if it was already taken from the other one
+     */
+    bool claim(const Operation& oper);
+
+    /**
+     * @brief Pop the operation which best fits the budget from the
+     *    budget classes, over the budget if \c force is set
+     * @return false if no operation can be taken
+     */
+    bool popBudget(Operation& oper, const bool force);
+
+    /**
+     * @brief Add queued allocating gates among \c nodes to their
+     *    current budget class, see @c budgetClass
+     */
+    void reclassify(const std::vector<Circuit::vertex_descriptor>& nodes);
+
+    /**
+     * @brief Budget class of a queued operation, the lower the better:
+     *    0 allocates nothing, 1 gate retiring a predecessor, 2 other
+     *    gate, 3 input read a consumer can follow, 4 other input read
+     * @details The class of a queued operation can only decrease
+     */
+    unsigned int budgetClass(const Operation& oper);
+
+    /**
+     * @brief Returns true if a consumer of input \c node can execute
+     *    without allocating once \c node is read
+     */
+    bool consumerCanFollow(const Circuit::vertex_descriptor node);
+
+    /**
+     * @brief Returns true if executing \c node deletes a predecessor
+     */
+    bool retiresPredecessor(const Circuit::vertex_descriptor node);
+
+    /**
+     * @brief Account for a finished operation and wake up workers
+     *    waiting for it
+     */
+    void finish();
+
+    /**
+     * @brief Push operations to the back of the deque of \c worker
+     */
+    void push(const unsigned int worker, const std::vector<Operation>& opers);
+
     /**
-     * @brief Specialization of \c pushWaitQueue for gate execute operations
+     * @brief Build the execute operation of a ready gate
+     * @details A predecessor for which \c node is the last successor to
+     *    execute is handed over for output buffer reuse
      */
-    void pushExecuteCmd(const Circuit::vertex_descriptor node);
+    Operation executeCmd(const Circuit::vertex_descriptor node);
 
     /**
-     * @brief Executes finishing schedule operations (delete memory, etc.)
+     * @brief Wake up sleeping workers
      */
-    void executeOperFinished(const Operation& oper);
+    void wakeUp(const bool all);
 
     /**
      * @brief returns true when all gate execute operations are done
      */
-    bool schedFinished() ;
+    bool schedFinished();
 };
 
 #endif
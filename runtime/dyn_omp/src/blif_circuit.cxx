@@ -23,6 +23,9 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
 
 #include <boost/algorithm/string.hpp>
 namespace ba = boost::algorithm;
@@ -30,29 +33,100 @@ namespace ba = boost::algorithm;
 using namespace std;
 
 /**
- * Mapping between BLIF truth tables and gate types
+ * Gate types of 2-input functions, indexed by their truth table: bit
+ *  \c{2a + b} is the function value for inputs \c a and \c b
  */
-unordered_map<string, GateType> truthTable2gate = {
-  {"0;", GateType::CONST_0},
-  {"1;", GateType::CONST_1},
-  {"01 1;10 1;", GateType::XOR},
-  {"10 1;01 1;", GateType::XOR},
-  {"11 1;", GateType::AND},
-  {"00 0;", GateType::OR},
-  {"0 1;", GateType::NOT},
-  {"1 1;", GateType::BUFF},
+const GateType truthTable2gate[16] = {
+  GateType::CONST_0,  /* 0000 */
+  GateType::NOR,      /* 0001 */
+  GateType::ANDNY,    /* 0010 */
+  GateType::NOT,      /* 0011, NOT a */
+  GateType::ANDYN,    /* 0100 */
+  GateType::NOT,      /* 0101, NOT b */
+  GateType::XOR,      /* 0110 */
+  GateType::NAND,     /* 0111 */
+  GateType::AND,      /* 1000 */
+  GateType::XNOR,     /* 1001 */
+  GateType::BUFF,     /* 1010, b */
+  GateType::ORNY,     /* 1011 */
+  GateType::BUFF,     /* 1100, a */
+  GateType::ORYN,     /* 1101 */
+  GateType::OR,       /* 1110 */
+  GateType::CONST_1,  /* 1111 */
 };
 
-GateType parseTruthTableString(const string& ttToken) {
-  GateType type = GateType::UNDEF;
+/**
+ * Parse the BLIF cover \c ttToken (rows separated by ';') of a gate with
+ *  \c inpCnt inputs. Inputs the function does not depend on are removed
+ *  from \c support, which gives the positions of gate inputs.
+ */
+GateType parseTruthTableString(const string& ttToken, const unsigned int inpCnt,
+    vector<unsigned int>& support) {
+  if (inpCnt > 2) {
+    throw runtime_error("ERROR: Unsupported gate with " + to_string(inpCnt) +
+                        " inputs and truth table " + ttToken);
+  }
+
+  /* Function values, bit i for the input values given by the bits of i
+      (first input most significant) */
+  const unsigned int full = (1u << (1u << inpCnt)) - 1;
+  unsigned int onSet = 0, offSet = 0;
+
+  vector<string> rows;
+  ba::split(rows, ttToken, ba::is_any_of(";"), ba::token_compress_on);
+  for (const string& row: rows) {
+    if (row.empty()) continue;
+
+    vector<string> tokens;
+    ba::split(tokens, row, ba::is_space(), ba::token_compress_on);
+    const string pattern = tokens.size() == 2 ? tokens[0] : "";
+    const string& value = tokens.back();
+    if (tokens.size() != (inpCnt > 0 ? 2u : 1u) or pattern.size() != inpCnt or
+        (value != "0" and value != "1")) {
+      throw runtime_error("ERROR: Malformed truth table " + ttToken);
+    }
 
-  try {
-    type = truthTable2gate.at(ttToken);
-  } catch (out_of_range& exc) {
-    throw runtime_error("ERROR: Unknown gate with truth table " + ttToken);
+    unsigned int matches = 0;
+    for (unsigned int i = 0; i < (1u << inpCnt); ++i) {
+      bool match = true;
+      for (unsigned int k = 0; k < inpCnt; ++k) {
+        const char bit = (i >> (inpCnt - 1 - k)) & 1 ? '1' : '0';
+        if (pattern[k] != '-' and pattern[k] != bit) match = false;
+      }
+      if (match) matches |= 1u << i;
+    }
+    (value == "1" ? onSet : offSet) |= matches;
   }
-  
-  return type;
+
+  /* Rows give either the on-set or the off-set, no rows is constant 0 */
+  if (onSet != 0 and offSet != 0) {
+    throw runtime_error("ERROR: Truth table with both on-set and off-set rows " + ttToken);
+  }
+  unsigned int tt = offSet != 0 ? full & ~offSet : onSet;
+
+  /* Functions are extended to 2 inputs */
+  support.clear();
+  if (inpCnt == 0) {
+    tt = tt ? 0xF : 0x0;
+  } else if (inpCnt == 1) {
+    tt = (tt & 1 ? 0x3 : 0x0) | (tt & 2 ? 0xC : 0x0);
+    support.push_back(0);
+  } else {
+    support.push_back(0);
+    support.push_back(1);
+  }
+
+  /* Inputs which do not change the function value are dropped */
+  const bool dependsOnA = ((tt >> 2) & 0x3) != (tt & 0x3);
+  const bool dependsOnB = ((tt >> 1) & 0x5) != (tt & 0x5);
+  if (support.size() == 2 and not dependsOnB) support.pop_back();
+  if (support.size() >= 1 and not dependsOnA) support.erase(support.begin());
+  if (inpCnt == 2 and support.size() == 1 and support[0] == 1) {
+    /* function of b only, 1-input gates take it as first input */
+    tt = (tt & 1 ? 0x3 : 0x0) | (tt & 2 ? 0xC : 0x0);
+  }
+
+  return truthTable2gate[tt];
 }
 
 struct GateRaw {
@@ -143,49 +217,157 @@ void ReadBlifFileRaw(string fn,
   blifFile.close();
 }
 
+Circuit::Circuit(const vector<GateProperties>& gates,
+    const vector<pair<unsigned int, unsigned int>>& edges) {
+  const unsigned int n = gates.size();
+
+  /* Fan-ins of original gates, in edge order */
+  vector<unsigned int> offsets(n + 1, 0);
+  for (auto edge: edges) {
+    offsets[edge.second + 1]++;
+  }
+  for (unsigned int i = 0; i < n; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+  vector<unsigned int> preds(edges.size());
+  vector<unsigned int> pos(offsets.begin(), offsets.end() - 1);
+  for (auto edge: edges) {
+    preds[pos[edge.second]++] = edge.first;
+  }
+
+  vector<unsigned int> succCnt(n + 1, 0);
+  for (auto edge: edges) {
+    succCnt[edge.first + 1]++;
+  }
+  for (unsigned int i = 0; i < n; ++i) {
+    succCnt[i + 1] += succCnt[i];
+  }
+  vector<unsigned int> succs(edges.size());
+  pos.assign(succCnt.begin(), succCnt.end() - 1);
+  for (auto edge: edges) {
+    succs[pos[edge.first]++] = edge.second;
+  }
+
+  /* Topological order closest to the gate list order, gates without
+      inputs (inputs, constants) are placed just before their first
+      successor so that a topological schedule does not read all inputs
+      first */
+  vector<unsigned int> rank(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    rank[i] = i;
+    if (offsets[i + 1] == offsets[i]) {
+      /* unused gates without inputs go last */
+      rank[i] = n;
+      for (unsigned int j = succCnt[i]; j < succCnt[i + 1]; ++j) {
+        rank[i] = min(rank[i], succs[j]);
+      }
+    }
+  }
+
+  typedef pair<unsigned int, unsigned int> RankedGate;
+  priority_queue<RankedGate, vector<RankedGate>, greater<RankedGate>> ready;
+  vector<unsigned int> predCnt(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    predCnt[i] = offsets[i + 1] - offsets[i];
+    if (predCnt[i] == 0) ready.emplace(rank[i], i);
+  }
+
+  vector<unsigned int> order;
+  order.reserve(n);
+  while (not ready.empty()) {
+    const unsigned int g = ready.top().second;
+    ready.pop();
+    order.push_back(g);
+    for (unsigned int j = succCnt[g]; j < succCnt[g + 1]; ++j) {
+      if (--predCnt[succs[j]] == 0) ready.emplace(rank[succs[j]], succs[j]);
+    }
+  }
+  if (order.size() != n) {
+    throw runtime_error("ERROR: Circuit has a combinational cycle");
+  }
+
+  vector<vertex_descriptor> renum(n);
+  for (unsigned int k = 0; k < n; ++k) {
+    renum[order[k]] = k;
+  }
+
+  ids.reserve(n);
+  types.reserve(n);
+  outputs.reserve(n);
+  faninOffsets.reserve(n + 1);
+  fanins.reserve(edges.size());
+  faninOffsets.push_back(0);
+  for (unsigned int k = 0; k < n; ++k) {
+    const unsigned int g = order[k];
+    ids.push_back(gates[g].id);
+    types.push_back(gates[g].type);
+    outputs.push_back(gates[g].isOutput);
+    for (unsigned int j = offsets[g]; j < offsets[g + 1]; ++j) {
+      fanins.push_back(renum[preds[j]]);
+    }
+    faninOffsets.push_back(fanins.size());
+  }
+
+  /* Fan-outs are sorted by successor number */
+  fanoutOffsets.assign(n + 1, 0);
+  for (const vertex_descriptor pred: fanins) {
+    fanoutOffsets[pred + 1]++;
+  }
+  for (unsigned int k = 0; k < n; ++k) {
+    fanoutOffsets[k + 1] += fanoutOffsets[k];
+  }
+  fanouts.resize(fanins.size());
+  pos.assign(fanoutOffsets.begin(), fanoutOffsets.end() - 1);
+  for (unsigned int k = 0; k < n; ++k) {
+    for (const vertex_descriptor pred: fanin(k)) {
+      fanouts[pos[pred]++] = k;
+    }
+  }
+}
+
 Circuit ReadBlifFile(const string& fn) {
   vector<GateRaw> circuitRaw;
   vector<string> inpNodes, outNodes;
   ReadBlifFileRaw(fn, circuitRaw, inpNodes, outNodes);
 
-  Circuit circuit;
-  unordered_map<string, Circuit::vertex_descriptor> id2vertex;
+  vector<GateProperties> gates;
+  vector<pair<unsigned int, unsigned int>> edges;
+  unordered_map<string, unsigned int> id2gate;
 
   for (auto id: inpNodes) {
-    id2vertex[id] = add_vertex(GateProperties(id, GateType::INPUT), circuit);
+    id2gate[id] = gates.size();
+    gates.push_back(GateProperties(id, GateType::INPUT));
   }
-  for (auto gateRaw: circuitRaw) {
-    id2vertex[gateRaw.output] = add_vertex(GateProperties(gateRaw.output), circuit);
+  for (auto& gateRaw: circuitRaw) {
+    id2gate[gateRaw.output] = gates.size();
+    gates.push_back(GateProperties(gateRaw.output));
   }
   for (auto id: outNodes) {
-    circuit[id2vertex.at(id)].isOutput = true;
+    gates[id2gate.at(id)].isOutput = true;
   }
 
-  for (auto gateRaw: circuitRaw) {
-    Circuit::vertex_descriptor out = id2vertex.at(gateRaw.output);
-  
-    for (auto inp: gateRaw.inputs) {
-      add_edge(id2vertex.at(inp), out, circuit);
-    }
+  vector<unsigned int> support;
+  for (auto& gateRaw: circuitRaw) {
+    const unsigned int out = id2gate.at(gateRaw.output);
+
+    gates[out].type = parseTruthTableString(gateRaw.truthTable,
+                                            gateRaw.inputs.size(), support);
 
-    circuit[out].type = parseTruthTableString(gateRaw.truthTable);
+    for (const unsigned int k: support) {
+      edges.emplace_back(id2gate.at(gateRaw.inputs[k]), out);
+    }
   }
   
-  return circuit;
+  return Circuit(gates, edges);
 }
 
 void UpdateCircuitWithClearInputs(Circuit& circuit, const unordered_map<string, bool>& clearInps) {
   if (clearInps.size() == 0) return;
 
-  Circuit::vertex_iterator vi, vi_end;
-
-  for (tie(vi, vi_end) = vertices(circuit); vi != vi_end; vi++) {
-    if (clearInps.find(circuit[*vi].id) != clearInps.end()) {
-      if (clearInps.at(circuit[*vi].id)) {
-        circuit[*vi].type = GateType::CONST_1;
-      } else {
-        circuit[*vi].type = GateType::CONST_0;
-      }
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    auto it = clearInps.find(circuit.id(node));
+    if (it != clearInps.end()) {
+      circuit.setType(node, it->second ? GateType::CONST_1 : GateType::CONST_0);
     }
   }
-}
\ No newline at end of file
+}
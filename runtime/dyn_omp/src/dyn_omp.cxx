@@ -33,6 +33,7 @@
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
 #include <thread>
+#include <atomic>
 #include <chrono>
 
 using namespace std;
@@ -47,7 +48,8 @@ enum class PriorityType {
   Earliest,
   Latest,
   MaxOutDegree,
-  MinOutDegree
+  MinOutDegree,
+  CriticalPath
 };
 
 /* Command line options structure */
@@ -60,6 +62,9 @@ struct Options {
   int nrThreads;
   bool verbose;
   bool stringOutput;
+  bool noModSwitch;
+  bool noIntraGate;
+  unsigned int maxCiphertexts;
   PriorityType priority = PriorityType::Topological;
 
   static PriorityType parsePriority(const string& token) {
@@ -91,6 +96,7 @@ private:
         priority2string[PriorityType::Latest] = "latest";
         priority2string[PriorityType::MaxOutDegree] = "max-out";
         priority2string[PriorityType::MinOutDegree] = "min-out";
+        priority2string[PriorityType::CriticalPath] = "crit-path";
 
         for (auto it: priority2string) {
           string2priority[it.second] = it.first;
@@ -136,7 +142,10 @@ Options parseArgs(int argc, char** argv) {
       ("eval-key", po::value<string>(&options.EvalKeyFile)->default_value("fhe_key.evk"), "evaluation key")
       ("strout", po::bool_switch(&options.stringOutput)->default_value(false), "output ciphertexts in string format")
       ("clear-inps", po::value<string>(&options.ClearInputsFile)->default_value(""), "clear inputs file")
+      ("no-mod-switch", po::bool_switch(&options.noModSwitch)->default_value(false), "keep ciphertexts at the largest modulus")
       ("threads", po::value<int>(&options.nrThreads)->default_value(1), "number of parallel execution threads")
+      ("no-intra-gate", po::bool_switch(&options.noIntraGate)->default_value(false), "do not split gates over the threads left idle by a shallow ready queue")
+      ("max-ciphertexts", po::value<unsigned int>(&options.maxCiphertexts)->default_value(0), "memory budget, maximal number of simultaneously allocated ciphertexts (0 for no limit)")
       ("priority", po::value<PriorityType>(&options.priority), priorityHelp.c_str())
       ("help,h", "produce help message")
       ("verbose,v", po::bool_switch(&options.verbose)->default_value(false), "enable verbosity")
@@ -249,7 +258,8 @@ int main(int argc, char **argv)
 
   /* Create homomorphic execution environment */
   HomomorphicExecutor* homExec = new HomomorphicExecutor(circuit,
-      options.EvalKeyFile, options.PublicKeyFile, options.verbose, options.stringOutput);
+      options.EvalKeyFile, options.PublicKeyFile, options.verbose, options.stringOutput,
+      not options.noModSwitch);
 
   /* Create priority object in function of cmd line parameter */
   Priority* priority = nullptr;
@@ -261,10 +271,10 @@ int main(int argc, char **argv)
       priority = new PriorityInverseTopological(circuit);
       break;
     case PriorityType::Earliest:
-      priority = new PriorityEarliest();
+      priority = new PriorityEarliest(circuit);
       break;
     case PriorityType::Latest:
-      priority = new PriorityLatest();
+      priority = new PriorityLatest(circuit);
       break;
     case PriorityType::MaxOutDegree:
       priority = new PriorityMaxOutDegree(circuit);
@@ -272,6 +282,18 @@ int main(int argc, char **argv)
     case PriorityType::MinOutDegree:
       priority = new PriorityMinOutDegree(circuit);
       break;
+    case PriorityType::CriticalPath: {
+      /* Gates are weighted by their cost, measured by a short warm-up */
+      const map<GateType, double> costs = homExec->measureGateCosts();
+      if (options.verbose) {
+        cout << "Gate costs: XOR " << costs.at(GateType::XOR)
+             << ", AND " << costs.at(GateType::AND)
+             << ", OR " << costs.at(GateType::OR)
+             << ", NOT " << costs.at(GateType::NOT) << " seconds" << endl;
+      }
+      priority = new PriorityCriticalPath(circuit, costs);
+      break;
+    }
     default:
       throw runtime_error("ERROR: priority object not created");
   }
@@ -280,19 +302,41 @@ int main(int argc, char **argv)
     cout << "Priority: " << Options::toString(options.priority) << endl;
   }
 
-  /* Create scheduler */
-  Scheduler* sched = new Scheduler(circuit, priority);
+  /* Create scheduler, one work deque per thread */
+  Scheduler* sched = new Scheduler(circuit, priority, options.nrThreads,
+                                   options.maxCiphertexts);
+
+  /* Worker threads use the parameters read by the main thread */
+  shared_ptr<const FheContext> context = FheContext::current();
+
+  /* Threads with no ready gate to execute help the running ones through
+      the thread pool, each running gate gets an equal share of them */
+  const unsigned int nrThreads = options.nrThreads;
+  const bool intraGate = not options.noIntraGate and nrThreads > 1;
+  if (intraGate) {
+    ThreadPool::resize(nrThreads - 1);
+  }
+  atomic<unsigned int> running(0);
 
-  function<void ()> doWork = [homExec, sched, &circuit]() {
+  function<void (unsigned int)> doWork = [homExec, sched, &circuit, context,
+                                          nrThreads, intraGate, &running](unsigned int worker) {
+    FheContext::Scope scope(context);
     Scheduler::Operation oper;
     do {
-      oper = sched->next();
+      oper = sched->next(worker);
 
       if (oper.type == Scheduler::Operation::Type::Execute) {
-        homExec->ExecuteGate(oper.node);
-        sched->done(oper);
+        const unsigned int busy = ++running;
+        if (intraGate) {
+          const unsigned int used = busy + sched->pending();
+          ThreadPool::setWidth(used < nrThreads ? nrThreads / busy : 1);
+        }
+        homExec->ExecuteGate(oper.node, oper.reuse);
+        running--;
+        sched->done(worker, oper);
       } else if (oper.type == Scheduler::Operation::Type::Delete) {
         homExec->DeleteGateData(oper.node);
+        sched->done(worker, oper);
       }
     } while (oper.type != Scheduler::Operation::Type::Done);
 
@@ -308,12 +352,9 @@ int main(int argc, char **argv)
   /* Create threads and start homomorphic executors */
   vector<thread> ths;
   for (int i = 0; i < options.nrThreads; i++) {
-    ths.push_back(thread(doWork));
+    ths.push_back(thread(doWork, i));
   }
 
-  /* Start scheduling */
-  sched->doSchedule();
-
   for (int i = 0; i < options.nrThreads; i++) {
     ths[i].join();
   }
@@ -322,6 +363,11 @@ int main(int argc, char **argv)
       duration_cast<duration<double>>(steady_clock::now() - start);
   cout << "Total execution real time " << execTime.count() << " seconds" << endl;
   homExec->printExecTime();
+  if (sched->overruns() > 0) {
+    cout << "Gates executed over the ciphertext budget " << sched->overruns() << endl;
+  }
+
+  ThreadPool::resize(0);
 
   delete sched;
   delete priority;
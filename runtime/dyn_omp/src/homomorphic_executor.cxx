@@ -31,48 +31,74 @@ void HomomorphicExecutor::updateMeasures(const steady_clock::time_point& start,
   execCnt[name]++;
 }
 
-void HomomorphicExecutor::printGateInfo(const GateProperties& gate,
+void HomomorphicExecutor::printGateInfo(const Circuit::vertex_descriptor idx,
     const Circuit::vertex_descriptor pred1,
     const Circuit::vertex_descriptor pred2) {
+  const string& id = circuit.id(idx);
 
   lock_guard<mutex> lck(verboseMtx);
-  switch (gate.type) {
+  switch (circuit.type(idx)) {
     case GateType::INPUT:
-      cout << gate.id << "\t= READ('" << inpsDir + gate.id + ".ct" << "')";
+      cout << id << "\t= READ('" << inpsDir + id + ".ct" << "')";
       break;
     case GateType::XOR:
-      cout << gate.id << "\t= XOR(" << circuit[pred1].id << ", " << circuit[pred2].id << ")";
+      cout << id << "\t= XOR(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
       break;
     case GateType::AND:
-      cout << gate.id << "\t= AND(" << circuit[pred1].id << ", " << circuit[pred2].id << ")";
+      cout << id << "\t= AND(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
       break;
     case GateType::OR:
-      cout << gate.id << "\t= OR(" << circuit[pred1].id << ", " << circuit[pred2].id << ")";
+      cout << id << "\t= OR(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
       break;
     case GateType::NOT:
-      cout << gate.id << "\t= NOT(" << circuit[pred1].id << ")";
+      cout << id << "\t= NOT(" << circuit.id(pred1) << ")";
       break;
     case GateType::CONST_0:
-      cout << gate.id << "\t= 0";
+      cout << id << "\t= 0";
       break;
     case GateType::CONST_1:
-      cout << gate.id << "\t= 1";
+      cout << id << "\t= 1";
       break;
     case GateType::BUFF:
-      cout << gate.id << "\t= " << circuit[pred1].id;
+      cout << id << "\t= " << circuit.id(pred1);
+      break;
+    case GateType::NAND:
+      cout << id << "\t= NAND(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::NOR:
+      cout << id << "\t= NOR(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::XNOR:
+      cout << id << "\t= XNOR(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::ANDNY:
+      cout << id << "\t= ANDNY(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::ANDYN:
+      cout << id << "\t= ANDYN(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::ORNY:
+      cout << id << "\t= ORNY(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
+      break;
+    case GateType::ORYN:
+      cout << id << "\t= ORYN(" << circuit.id(pred1) << ", " << circuit.id(pred2) << ")";
       break;
     case GateType::UNDEF:
-      throw runtime_error("Should never arrive here, UNDEF gate type " + gate.id);
+      throw runtime_error("Should never arrive here, UNDEF gate type " + id);
       break;
   }
 
-  if (gate.isOutput) {
-    cout << " -> WRITE('" << outsDir + gate.id + ".ct" << "')";
+  if (circuit.isOutput(idx)) {
+    cout << " -> WRITE('" << outsDir + id + ".ct" << "')";
   }
   cout << endl;
 
 }
 
+void HomomorphicExecutor::Allocate(CipherText*& ct) {
+  ct = new CipherText(0);
+}
+
 void HomomorphicExecutor::Copy(CipherText*& ct, const CipherText* const ct_cpy) {
   steady_clock::time_point start = steady_clock::now();
 
@@ -85,6 +111,10 @@ void HomomorphicExecutor::Read(CipherText*& ct, const string& fn) {
   steady_clock::time_point start = steady_clock::now();
 
   ct->read(fn);
+  if (FheParams::get().RnsQ != nullptr) {
+    CipherText::toRns(*ct);
+    CipherText::toNtt(*ct);
+  }
 
   updateMeasures(start, "READ");
 }
@@ -92,21 +122,81 @@ void HomomorphicExecutor::Read(CipherText*& ct, const string& fn) {
 void HomomorphicExecutor::Write(CipherText*& ct, const string& fn) {
   steady_clock::time_point start = steady_clock::now();
 
-  ct->write(fn, not stringOutput);
+  /* outputs are written at the smallest modulus */
+  const unsigned int level = modLevels.empty() ? 0 : FheParams::modLevel(0);
+  if (ct->level() < level) {
+    CipherText ct_out(*ct);
+    CipherText::mod_switch(ct_out, level);
+    ct_out.write(fn, not stringOutput);
+  } else {
+    ct->write(fn, not stringOutput);
+  }
 
   updateMeasures(start, "WRITE");
 }
 
+void HomomorphicExecutor::ModSwitch(CipherText*& ct,
+    const Circuit::vertex_descriptor idx) {
+  if (modLevels.empty() or ct->level() >= modLevels[idx]) return;
+
+  steady_clock::time_point start = steady_clock::now();
+
+  CipherText::mod_switch(*ct, modLevels[idx]);
+
+  updateMeasures(start, "MODSWITCH");
+}
+
+/* Gates which multiply ciphertexts */
+static bool isMultiplicative(const GateType type) {
+  switch (type) {
+    case GateType::AND:
+    case GateType::OR:
+    case GateType::NAND:
+    case GateType::NOR:
+    case GateType::ANDNY:
+    case GateType::ANDYN:
+    case GateType::ORNY:
+    case GateType::ORYN:
+      return true;
+    case GateType::XOR:
+    case GateType::XNOR:
+      return FheParams::get().T != 2;
+    default:
+      return false;
+  }
+}
+
+void HomomorphicExecutor::computeModLevels() {
+  /* reverse topological order, successors come first */
+  vector<unsigned int> depth(circuit.size());
+  modLevels.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = circuit.size(); node-- > 0; ) {
+    unsigned int d = 0;
+    for (const Circuit::vertex_descriptor succ: circuit.fanout(node)) {
+      d = max(d, depth[succ] + (isMultiplicative(circuit.type(succ)) ? 1 : 0));
+    }
+    depth[node] = d;
+    modLevels[node] = FheParams::modLevel(d);
+  }
+}
+
 void HomomorphicExecutor::ExecuteXOR(
   CipherText *&ct_res,
   const CipherText* const ct_n1,
   const CipherText* const ct_n2)
 {
-  Copy(ct_res, ct_n1);
-
   steady_clock::time_point start = steady_clock::now();
 
-  CipherText::add(*ct_res, *ct_n2);
+  if (FheParams::get().T == 2) {
+    CipherText::add(*ct_res, *ct_n1, *ct_n2);
+  } else {
+    /* ct_n1 + ct_n2 - 2 * ct_n1 * ct_n2 */
+    CipherText prod(0);
+    CipherText::multiply(prod, *ct_n1, *ct_n2, *keys->EvalKey);
+    CipherText::add(*ct_res, *ct_n1, *ct_n2);
+    CipherText::sub(*ct_res, prod);
+    CipherText::sub(*ct_res, prod);
+  }
 
   updateMeasures(start, "XOR");
 }
@@ -115,11 +205,14 @@ void HomomorphicExecutor::ExecuteNOT(
   CipherText *&ct_res,
   const CipherText* const ct_n1)
 {
-  Copy(ct_res, ct_n1);
-
   steady_clock::time_point start = steady_clock::now();
 
-  CipherText::add(*ct_res, *ct_const_1);
+  const CipherText* const one = ct_const_1[ct_n1->level()];
+  if (FheParams::get().T == 2) {
+    CipherText::add(*ct_res, *ct_n1, *one);
+  } else {
+    CipherText::sub(*ct_res, *one, *ct_n1);
+  }
 
   updateMeasures(start, "NOT");
 }
@@ -129,11 +222,9 @@ void HomomorphicExecutor::ExecuteAND(
   const CipherText* const ct_n1,
   const CipherText* const ct_n2)
 {
-  Copy(ct_res, ct_n1);
-
   steady_clock::time_point start = steady_clock::now();
 
-  CipherText::multiply(*ct_res, *ct_n2, *keys->EvalKey);
+  CipherText::multiply(*ct_res, *ct_n1, *ct_n2, *keys->EvalKey);
 
   updateMeasures(start, "AND");
 }
@@ -143,23 +234,101 @@ void HomomorphicExecutor::ExecuteOR(
   const CipherText* const ct_n1,
   const CipherText* const ct_n2)
 {
-  Copy(ct_res, ct_n1);
-
   steady_clock::time_point start = steady_clock::now();
 
-  CipherText::multiply(*ct_res, *ct_n2, *keys->EvalKey);
-  CipherText::add(*ct_res, *ct_n1);
-  CipherText::add(*ct_res, *ct_n2);
+  /* ct_n1 + ct_n2 - ct_n1 * ct_n2 */
+  if (ct_res == ct_n1 or ct_res == ct_n2 or FheParams::get().T != 2) {
+    CipherText prod(0);
+    CipherText::multiply(prod, *ct_n1, *ct_n2, *keys->EvalKey);
+    CipherText::add(*ct_res, *ct_n1, *ct_n2);
+    CipherText::sub(*ct_res, prod);
+  } else {
+    CipherText::multiply(*ct_res, *ct_n1, *ct_n2, *keys->EvalKey);
+    CipherText::add(*ct_res, *ct_n1);
+    CipherText::add(*ct_res, *ct_n2);
+  }
 
   updateMeasures(start, "OR");
 }
 
+void HomomorphicExecutor::ExecuteNegated(
+  const GateType type,
+  CipherText *&ct_res,
+  const CipherText* const ct_n1,
+  const CipherText* const ct_n2)
+{
+  steady_clock::time_point start = steady_clock::now();
+
+  /* Product first, ct_res can be one of the input ciphertexts */
+  CipherText prod(0);
+  if (type != GateType::XNOR or FheParams::get().T != 2) {
+    CipherText::multiply(prod, *ct_n1, *ct_n2, *keys->EvalKey);
+  }
+  const CipherText& one = *ct_const_1[max(ct_n1->level(), ct_n2->level())];
+
+  string name;
+  switch (type) {
+    case GateType::NAND:
+      /* 1 - ct_n1 * ct_n2 */
+      CipherText::sub(*ct_res, one, prod);
+      name = "NAND";
+      break;
+    case GateType::NOR:
+      /* 1 - ct_n1 - ct_n2 + ct_n1 * ct_n2 */
+      CipherText::add(prod, one);
+      CipherText::add(*ct_res, *ct_n1, *ct_n2);
+      CipherText::sub(*ct_res, prod, *ct_res);
+      name = "NOR";
+      break;
+    case GateType::XNOR:
+      /* 1 - ct_n1 - ct_n2 + 2 * ct_n1 * ct_n2 */
+      CipherText::add(*ct_res, *ct_n1, *ct_n2);
+      if (FheParams::get().T != 2) {
+        CipherText::sub(*ct_res, prod, *ct_res);
+        CipherText::add(*ct_res, prod);
+      }
+      CipherText::add(*ct_res, one);
+      name = "XNOR";
+      break;
+    case GateType::ANDNY:
+      /* ct_n2 - ct_n1 * ct_n2 */
+      CipherText::sub(*ct_res, *ct_n2, prod);
+      name = "ANDNY";
+      break;
+    case GateType::ANDYN:
+      /* ct_n1 - ct_n1 * ct_n2 */
+      CipherText::sub(*ct_res, *ct_n1, prod);
+      name = "ANDYN";
+      break;
+    case GateType::ORNY:
+      /* 1 - ct_n1 + ct_n1 * ct_n2 */
+      CipherText::add(prod, one);
+      CipherText::sub(*ct_res, prod, *ct_n1);
+      name = "ORNY";
+      break;
+    case GateType::ORYN:
+      /* 1 - ct_n2 + ct_n1 * ct_n2 */
+      CipherText::add(prod, one);
+      CipherText::sub(*ct_res, prod, *ct_n2);
+      name = "ORYN";
+      break;
+    default:
+      throw runtime_error("Gate type is not a negated gate");
+  }
+
+  updateMeasures(start, name);
+}
+
 HomomorphicExecutor::HomomorphicExecutor(const Circuit& circuit_p,
           const string& evalKeyFile, const string& publicKeyFile,
-          const bool verbose_p, const bool stringOutput_p):
+          const bool verbose_p, const bool stringOutput_p,
+          const bool modSwitch):
     circuit(circuit_p), verbose(verbose_p), stringOutput(stringOutput_p)
 {
+  const FheParams& params = FheParams::get();
+
   allocatedCnt = 0;
+  maxAllocatedCnt = 0;
 
   /* Read evaluation key and public key files */
   keys = new KeysShare();
@@ -167,7 +336,9 @@ HomomorphicExecutor::HomomorphicExecutor(const Circuit& circuit_p,
   keys->readPublicKey(publicKeyFile);
 
   /* Initialize execution metrics data structures */
-  const string operNames[] = {"READ", "WRITE", "XOR", "AND", "OR", "NOT", "COPY"};
+  const string operNames[] = {"READ", "WRITE", "XOR", "AND", "OR", "NOT",
+                              "NAND", "NOR", "XNOR", "ANDNY", "ANDYN", "ORNY", "ORYN",
+                              "COPY", "MODSWITCH"};
   for (const string &operName : operNames) {
     execMtx[operName] = new mutex();
     execTime[operName] = 0.0;
@@ -175,25 +346,37 @@ HomomorphicExecutor::HomomorphicExecutor(const Circuit& circuit_p,
   }
 
   /* For each circuit gate create a corresponding ciphertext pointer */
-  Circuit::vertex_iterator vi, vi_end;
-  for (tie(vi,vi_end) = vertices(circuit); vi != vi_end; vi++) {
-    cipherTxts[*vi] = nullptr;
+  cipherTxts.assign(circuit.size(), nullptr);
+
+  /* Modulus switching needs the RNS representation */
+  if (modSwitch and params.ModChain.size() > 1) {
+    computeModLevels();
   }
 
-  /* Define constant ciphertexts */
-  ct_const_0 = new CipherText(EncDec::Encrypt(0));
-  ct_const_1 = new CipherText(EncDec::Encrypt(1));
+  /* Define constant ciphertexts, at each modulus level */
+  for (unsigned int l = 0; l < params.ModChain.size(); ++l) {
+    ct_const_0.push_back(new CipherText(EncDec::Encrypt(0)));
+    ct_const_1.push_back(new CipherText(EncDec::Encrypt(1)));
+    if (params.RnsQ != nullptr) {
+      CipherText::toRns(*ct_const_0[l]);
+      CipherText::toRns(*ct_const_1[l]);
+      CipherText::mod_switch(*ct_const_0[l], l);
+      CipherText::mod_switch(*ct_const_1[l], l);
+      CipherText::toNtt(*ct_const_0[l]);
+      CipherText::toNtt(*ct_const_1[l]);
+    }
+  }
 }
 
 HomomorphicExecutor::~HomomorphicExecutor() {
-  for (auto it: cipherTxts) {
-    if (it.second != nullptr) {
-      delete it.second;
+  for (CipherText* ct: cipherTxts) {
+    if (ct != nullptr) {
+      delete ct;
     }
   }
 
-  delete ct_const_0;
-  delete ct_const_1;
+  for (CipherText* ct: ct_const_0) delete ct;
+  for (CipherText* ct: ct_const_1) delete ct;
   delete keys;
 
   for (auto it(execMtx.begin()); it != execMtx.end(); it++) {
@@ -202,69 +385,163 @@ HomomorphicExecutor::~HomomorphicExecutor() {
 }
 
 void HomomorphicExecutor::DeleteGateData(const Circuit::vertex_descriptor idx) {
-  delete cipherTxts[idx];
-  cipherTxts[idx] = nullptr;
-  allocatedCnt--;
+  /* ciphertext might have been taken over by a successor */
+  if (cipherTxts[idx] != nullptr) {
+    delete cipherTxts[idx];
+    cipherTxts[idx] = nullptr;
+    allocatedCnt--;
+  }
 }
 
-void HomomorphicExecutor::ExecuteGate(const Circuit::vertex_descriptor idx) {
+void HomomorphicExecutor::ExecuteGate(const Circuit::vertex_descriptor idx,
+    const Circuit::vertex_descriptor reuse) {
   /* Get gate properties and predecessors */
-  GateProperties gate = circuit[idx];
-  Circuit::vertex_descriptor pred1, pred2;
+  const GateType type = circuit.type(idx);
+  const Circuit::Range fanin = circuit.fanin(idx);
+  Circuit::vertex_descriptor pred1 = Circuit::null_vertex();
+  Circuit::vertex_descriptor pred2 = Circuit::null_vertex();
 
-  if (in_degree(idx, circuit) >= 1) {
-    pred1 = *inv_adjacent_vertices(idx, circuit).first;
+  if (fanin.size() >= 1) {
+    pred1 = fanin[0];
     assert(cipherTxts[pred1] != nullptr);
   }
-  if (in_degree(idx, circuit) >= 2) {
-    pred2 = *(inv_adjacent_vertices(idx, circuit).first + 1);
+  if (fanin.size() >= 2) {
+    pred2 = fanin[1];
     assert(cipherTxts[pred2] != nullptr);
   }
 
   if (verbose) {
-    printGateInfo(gate, pred1, pred2);
+    printGateInfo(idx, pred1, pred2);
+  }
+
+  /* Input ciphertexts, then output ciphertext (can be one of inputs) */
+  const CipherText* const ct_n1 = fanin.size() >= 1 ? cipherTxts[pred1] : nullptr;
+  const CipherText* const ct_n2 = fanin.size() >= 2 ? cipherTxts[pred2] : nullptr;
+
+  if (reuse != Circuit::null_vertex()) {
+    assert(reuse == pred1 or reuse == pred2);
+    cipherTxts[idx] = cipherTxts[reuse];
+    cipherTxts[reuse] = nullptr;
+    allocatedCnt--;
+  } else if (type != GateType::INPUT and type != GateType::CONST_0 and
+      type != GateType::CONST_1 and type != GateType::BUFF) {
+    Allocate(cipherTxts[idx]);
   }
 
   /* Execute gate operation homomorphically */
-  switch (gate.type) {
+  switch (type) {
       case GateType::INPUT:
         cipherTxts[idx] = new CipherText();
-        Read(cipherTxts[idx], inpsDir + gate.id + ".ct");
+        Read(cipherTxts[idx], inpsDir + circuit.id(idx) + ".ct");
         break;
       case GateType::XOR:
-        ExecuteXOR(cipherTxts[idx], cipherTxts[pred1], cipherTxts[pred2]);
+        ExecuteXOR(cipherTxts[idx], ct_n1, ct_n2);
         break;
       case GateType::AND:
-        ExecuteAND(cipherTxts[idx], cipherTxts[pred1], cipherTxts[pred2]);
+        ExecuteAND(cipherTxts[idx], ct_n1, ct_n2);
         break;
       case GateType::OR:
-        ExecuteOR(cipherTxts[idx], cipherTxts[pred1], cipherTxts[pred2]);
+        ExecuteOR(cipherTxts[idx], ct_n1, ct_n2);
         break;
       case GateType::NOT:
-        ExecuteNOT(cipherTxts[idx], cipherTxts[pred1]);
+        ExecuteNOT(cipherTxts[idx], ct_n1);
         break;
       case GateType::CONST_0:
-        Copy(cipherTxts[idx], ct_const_0);
+        Copy(cipherTxts[idx], ct_const_0[modLevels.empty() ? 0 : modLevels[idx]]);
         break;
       case GateType::CONST_1:
-        Copy(cipherTxts[idx], ct_const_1);
+        Copy(cipherTxts[idx], ct_const_1[modLevels.empty() ? 0 : modLevels[idx]]);
         break;
       case GateType::BUFF:
-        Copy(cipherTxts[idx], cipherTxts[pred1]);
+        if (cipherTxts[idx] == nullptr) {
+          Copy(cipherTxts[idx], ct_n1);
+        }
+        break;
+      case GateType::NAND:
+      case GateType::NOR:
+      case GateType::XNOR:
+      case GateType::ANDNY:
+      case GateType::ANDYN:
+      case GateType::ORNY:
+      case GateType::ORYN:
+        ExecuteNegated(type, cipherTxts[idx], ct_n1, ct_n2);
         break;
       default:
-        throw runtime_error("Gate type " + gate.id + " is not supported");
+        throw runtime_error("Gate type " + circuit.id(idx) + " is not supported");
   }
 
   assert(cipherTxts[idx] != nullptr);
 
-  allocatedCnt++;
-  maxAllocatedCnt = max((int)allocatedCnt, maxAllocatedCnt);
+  /* Smaller moduli are enough for the remaining multiplicative depth */
+  ModSwitch(cipherTxts[idx], idx);
+
+  const int cnt = ++allocatedCnt;
+  int maxCnt = maxAllocatedCnt;
+  while (maxCnt < cnt and not maxAllocatedCnt.compare_exchange_weak(maxCnt, cnt));
 
   /* If gate is output write its value */
-  if (gate.isOutput) {
-    Write(cipherTxts[idx], outsDir + gate.id + ".ct");
+  if (circuit.isOutput(idx)) {
+    Write(cipherTxts[idx], outsDir + circuit.id(idx) + ".ct");
+  }
+}
+
+map<GateType, double> HomomorphicExecutor::measureGateCosts(const unsigned int reps) {
+  /* Constants are trivial encryptions (a single polynomial) whose
+      products skip relinearization, gates are timed on fresh
+      encryptions prepared as read inputs are */
+  CipherText ct_enc_1(EncDec::Encrypt(1, *keys->PublicKey));
+  CipherText ct_enc_0(EncDec::Encrypt(0, *keys->PublicKey));
+  if (FheParams::get().RnsQ != nullptr) {
+    CipherText::toRns(ct_enc_1);
+    CipherText::toRns(ct_enc_0);
+    CipherText::toNtt(ct_enc_1);
+    CipherText::toNtt(ct_enc_0);
   }
+  const CipherText* const ct_n1 = &ct_enc_1;
+  const CipherText* const ct_n2 = &ct_enc_0;
+  const GateType types[] = {GateType::XOR, GateType::AND, GateType::OR, GateType::NOT,
+                            GateType::NAND, GateType::NOR, GateType::XNOR,
+                            GateType::ANDNY, GateType::ANDYN, GateType::ORNY,
+                            GateType::ORYN};
+
+  map<GateType, double> costs;
+  for (const GateType type: types) {
+    double best = 0;
+    for (unsigned int r = 0; r <= reps; ++r) {
+      CipherText* ct_res = nullptr;
+      Allocate(ct_res);
+
+      steady_clock::time_point start = steady_clock::now();
+      switch (type) {
+        case GateType::XOR:
+          ExecuteXOR(ct_res, ct_n1, ct_n2);
+          break;
+        case GateType::AND:
+          ExecuteAND(ct_res, ct_n1, ct_n2);
+          break;
+        case GateType::OR:
+          ExecuteOR(ct_res, ct_n1, ct_n2);
+          break;
+        case GateType::NOT:
+          ExecuteNOT(ct_res, ct_n1);
+          break;
+        default:
+          ExecuteNegated(type, ct_res, ct_n1, ct_n2);
+          break;
+      }
+      const double elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+      delete ct_res;
+
+      /* first execution initializes tables and caches */
+      if (r == 1 or (r > 1 and elapsed < best)) best = elapsed;
+    }
+    costs[type] = best;
+  }
+
+  for (auto& it: execTime) it.second = 0.0;
+  for (auto& it: execCnt) it.second = 0;
+
+  return costs;
 }
 
 void HomomorphicExecutor::printExecTime() {
@@ -275,6 +552,14 @@ void HomomorphicExecutor::printExecTime() {
   cout << "NOT gates execution time " << execTime["NOT"] << " seconds, #execs " << execCnt["NOT"] << endl;
   cout << "AND gates execution time " << execTime["AND"] << " seconds, #execs " << execCnt["AND"] << endl;
   cout << "OR gates execution time " << execTime["OR"] << " seconds, #execs " << execCnt["OR"] << endl;
+  cout << "NAND gates execution time " << execTime["NAND"] << " seconds, #execs " << execCnt["NAND"] << endl;
+  cout << "NOR gates execution time " << execTime["NOR"] << " seconds, #execs " << execCnt["NOR"] << endl;
+  cout << "XNOR gates execution time " << execTime["XNOR"] << " seconds, #execs " << execCnt["XNOR"] << endl;
+  cout << "ANDNY gates execution time " << execTime["ANDNY"] << " seconds, #execs " << execCnt["ANDNY"] << endl;
+  cout << "ANDYN gates execution time " << execTime["ANDYN"] << " seconds, #execs " << execCnt["ANDYN"] << endl;
+  cout << "ORNY gates execution time " << execTime["ORNY"] << " seconds, #execs " << execCnt["ORNY"] << endl;
+  cout << "ORYN gates execution time " << execTime["ORYN"] << " seconds, #execs " << execCnt["ORYN"] << endl;
+  cout << "MODSWITCH time " << execTime["MODSWITCH"] << " seconds, #execs " << execCnt["MODSWITCH"] << endl;
   cout << "WRITE time " << execTime["WRITE"] << " seconds, #execs " << execCnt["WRITE"] << endl;
   cout << "Maximal number of simultaneously allocated ciphertexts " << maxAllocatedCnt << endl;
 }
@@ -20,69 +20,106 @@
 
 #include "priority.hxx"
 
-#include <vector>
-#include <boost/graph/topological_sort.hpp>
+#include <algorithm>
 
 using namespace std;
 
+/* Gates are numbered in topological order */
 PriorityTopological::PriorityTopological(const Circuit& circuit) {
-  vector<Circuit::vertex_descriptor> topo_order;
-  topological_sort(circuit, back_inserter(topo_order));
-  int prior = 0;
-  for (auto it = topo_order.rbegin(); it != topo_order.rend(); it++) {
-    priorities.emplace(*it, prior--);
+  priorities.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    priorities[node] = -(int)node;
   }
 }
 
 int PriorityTopological::value(const Circuit::vertex_descriptor node) {
-  return priorities.at(node);
+  return priorities[node];
 }
 
 PriorityInverseTopological::PriorityInverseTopological(const Circuit& circuit) {
-  vector<Circuit::vertex_descriptor> topo_order;
-  topological_sort(circuit, back_inserter(topo_order));
-  int prior = 0;
-  for (auto it = topo_order.rbegin(); it != topo_order.rend(); it++) {
-    priorities.emplace(*it, prior++);
+  priorities.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    priorities[node] = node;
   }
 }
 
 int PriorityInverseTopological::value(const Circuit::vertex_descriptor node) {
-  return priorities.at(node);
+  return priorities[node];
 } 
 
+PriorityEarliest::PriorityEarliest(const Circuit& circuit):
+    assigned(circuit.size(), false) {
+  priorities.resize(circuit.size());
+}
+
 int PriorityEarliest::value(const Circuit::vertex_descriptor node) {
-  if (priorities.find(node) == priorities.end()) {
-    priorities.emplace(node, lastValue--);
+  lock_guard<mutex> lck(mtx);
+  if (not assigned[node]) {
+    priorities[node] = lastValue--;
+    assigned[node] = true;
   }
-  return priorities.at(node);
+  return priorities[node];
+}
+
+PriorityLatest::PriorityLatest(const Circuit& circuit):
+    assigned(circuit.size(), false) {
+  priorities.resize(circuit.size());
 }
 
 int PriorityLatest::value(const Circuit::vertex_descriptor node) {
-  if (priorities.find(node) == priorities.end()) {
-    priorities.emplace(node, lastValue++);
+  lock_guard<mutex> lck(mtx);
+  if (not assigned[node]) {
+    priorities[node] = lastValue++;
+    assigned[node] = true;
   }
-  return priorities.at(node);
+  return priorities[node];
 }
 
 PriorityMaxOutDegree::PriorityMaxOutDegree(const Circuit& circuit) {
-  for(auto it = vertices(circuit); it.first != it.second; ++it.first) {
-    const Circuit::vertex_descriptor& node = *(it.first);
-    priorities.emplace(node, out_degree(node, circuit));
+  priorities.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    priorities[node] = circuit.outDegree(node);
   }
 }
 
 int PriorityMaxOutDegree::value(const Circuit::vertex_descriptor node) {
-  return priorities.at(node);
+  return priorities[node];
 }
 
 PriorityMinOutDegree::PriorityMinOutDegree(const Circuit& circuit) {
-  for(auto it = vertices(circuit); it.first != it.second; ++it.first) {
-    const Circuit::vertex_descriptor& node = *(it.first);
-    priorities.emplace(node, -out_degree(node, circuit));
+  priorities.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    priorities[node] = -(int)circuit.outDegree(node);
   }
 }
 
 int PriorityMinOutDegree::value(const Circuit::vertex_descriptor node) {
-  return priorities.at(node);
+  return priorities[node];
+}
+
+PriorityCriticalPath::PriorityCriticalPath(const Circuit& circuit,
+    const map<GateType, double>& costs) {
+  /* Reverse topological order, successors come first */
+  vector<double> length(circuit.size());
+  double maxLength = 0;
+  for (Circuit::vertex_descriptor node = circuit.size(); node-- > 0; ) {
+    double l = 0;
+    for (const Circuit::vertex_descriptor succ: circuit.fanout(node)) {
+      l = max(l, length[succ]);
+    }
+    auto it = costs.find(circuit.type(node));
+    length[node] = l + (it != costs.end() ? it->second : 0);
+    maxLength = max(maxLength, length[node]);
+  }
+
+  /* Path lengths are scaled to integers */
+  const double scale = maxLength > 0 ? (1 << 30) / maxLength : 0;
+  priorities.resize(circuit.size());
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    priorities[node] = (int)(length[node] * scale);
+  }
+}
+
+int PriorityCriticalPath::value(const Circuit::vertex_descriptor node) {
+  return priorities[node];
 }
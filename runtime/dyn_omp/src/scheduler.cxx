@@ -20,120 +20,402 @@
 
 #include "scheduler.hxx"
 
+#include <algorithm>
+
 using namespace std;
 
+/* See Scheduler::budgetClass */
+static const unsigned int BUDGET_CLASSES = 5;
+
 Scheduler::Scheduler(const Circuit& circuit_p,
-          Priority* const priority_p):
+          Priority* const priority_p, const unsigned int nrWorkers,
+          const unsigned int maxLive_p):
     circuit(circuit_p),
-    waitQueue(Scheduler::PriorityComparator(priority_p)) {
+    priority(priority_p),
+    succ2ExecCnt(circuit_p.size()),
+    pred2ExecCnt(circuit_p.size()),
+    queues(max(nrWorkers, 1u)),
+    queued(circuit_p.size()),
+    queuedCnt(0),
+    runningCnt(0),
+    maxLive(maxLive_p),
+    liveCnt(0),
+    overrunCnt(0),
+    taken(circuit_p.size(), 0),
+    budgetQueues(maxLive_p > 0 ? BUDGET_CLASSES : 0),
+    epoch(0),
+    sleepingCnt(0),
+    executedCnt(0) {
 
   initScheduler();
 }
 
-Scheduler::Operation Scheduler::next() {
+Scheduler::Operation Scheduler::next(const unsigned int worker) {
   Scheduler::Operation oper;
-  unique_lock<mutex> lck(waitQueueMtx);
+  while (true) {
+    const unsigned int seen = epoch;
+    if (popOrSteal(worker, oper)) break;
 
-  while (waitQueue.empty() and not schedFinished()) {
-    waitQueueCond.wait(lck);
-  }
+    if (schedFinished()) {
+      return Scheduler::Operation{Circuit::null_vertex(), Scheduler::Operation::Type::Done,
+                                  Circuit::null_vertex()};
+    }
 
-  if (schedFinished()) {
-    oper = Scheduler::Operation{Circuit::null_vertex(), Scheduler::Operation::Type::Done};
-  } else {
-    oper = waitQueue.top();
-    waitQueue.pop();
+    /* Nothing runs which could release a ciphertext, a single worker
+        exceeds the budget */
+    unsigned int idle = 0;
+    if (maxLive > 0 and queuedCnt > 0 and runningCnt.compare_exchange_strong(idle, 1)) {
+      const bool found = popOrSteal(worker, oper, true);
+      runningCnt--;
+      if (found) break;
+      continue;
+    }
+
+    /* A state change after the check below finds the worker sleeping */
+    sleepingCnt++;
+    unique_lock<mutex> lck(sleepMtx);
+    while (epoch == seen and not schedFinished()) {
+      sleepCond.wait(lck);
+    }
+    lck.unlock();
+    sleepingCnt--;
   }
 
   return oper;
 }
 
-void Scheduler::done(const Scheduler::Operation& oper) {
-  unique_lock<mutex> lck(finishedQueueMtx);
-  finishedQueue.push(oper);
-  lck.unlock();
-  finishedQueueCond.notify_one();
-}
+void Scheduler::done(const unsigned int worker, const Scheduler::Operation& oper) {
+  if (oper.type == Scheduler::Operation::Type::Delete) {
+    if (not taken[oper.node]) liveCnt--;
+    finish();
+    return;
+  }
+
+  vector<Scheduler::Operation> opers;
 
-void Scheduler::doSchedule() {
-  while (not schedFinished()) {
-    Scheduler::Operation oper = popFinishedQueue();
-    if (oper.type == Scheduler::Operation::Type::Execute) {
-      executeOperFinished(oper);
+  /* Gates without successors are not needed anymore */
+  if (circuit.outDegree(oper.node) == 0) {
+    opers.push_back(Scheduler::Operation{oper.node, Scheduler::Operation::Type::Delete,
+                                         Circuit::null_vertex()});
+  }
+
+  /* Queued gates whose budget class may decrease: the last successor
+      of a predecessor, which now retires it, and the inputs of gates
+      which may now follow them without allocating */
+  vector<Circuit::vertex_descriptor> improved;
+  auto inputsOf = [&](const Circuit::vertex_descriptor node) {
+    for (const Circuit::vertex_descriptor pred: circuit.fanin(node)) {
+      if (circuit.inDegree(pred) == 0) improved.push_back(pred);
+    }
+  };
+
+  /* Predecessors whose last successor is executed are deleted */
+  for (const Circuit::vertex_descriptor pred: circuit.fanin(oper.node)) {
+    const int left = --succ2ExecCnt[pred];
+    if (left == 0) {
+      opers.push_back(Scheduler::Operation{pred, Scheduler::Operation::Type::Delete,
+                                           Circuit::null_vertex()});
+    } else if (left == 1 and maxLive > 0) {
+      for (const Circuit::vertex_descriptor succ: circuit.fanout(pred)) {
+        improved.push_back(succ);
+        inputsOf(succ);
+      }
     }
   }
 
-  waitQueueCond.notify_all();
+  /* Successors whose last predecessor is executed are ready, the one
+      with the highest priority is pushed last and executed next */
+  vector<Circuit::vertex_descriptor> ready;
+  for (const Circuit::vertex_descriptor succ: circuit.fanout(oper.node)) {
+    const int left = --pred2ExecCnt[succ];
+    if (left == 0) {
+      ready.push_back(succ);
+    } else if (left == 1 and maxLive > 0) {
+      inputsOf(succ);
+    }
+  }
+  reclassify(improved);
+
+  stable_sort(ready.begin(), ready.end(),
+      [this](const Circuit::vertex_descriptor x, const Circuit::vertex_descriptor y) {
+        return priority->value(x) < priority->value(y);
+      });
+
+  /* Deletes go last to release memory first */
+  vector<Scheduler::Operation> execs;
+  for (const Circuit::vertex_descriptor succ: ready) {
+    execs.push_back(executeCmd(succ));
+  }
+  execs.insert(execs.end(), opers.begin(), opers.end());
+
+  push(worker, execs);
+
+  /* Sleeping workers are done with the last gate */
+  if (++executedCnt == circuit.size()) {
+    wakeUp(true);
+  }
+  finish();
+}
+
+unsigned int Scheduler::pending() {
+  return queuedCnt;
+}
+
+unsigned int Scheduler::overruns() {
+  return overrunCnt;
 }
 
 void Scheduler::initScheduler() {
-  /* Input nodes (in_degree == 0) are available for execution directly */
-  for(auto it = vertices(circuit); it.first != it.second; ++it.first) {
-    const Circuit::vertex_descriptor& node = *(it.first);
-    if (in_degree(node, circuit) == 0) {
-      pushExecuteCmd(node);
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    succ2ExecCnt[node] = circuit.outDegree(node);
+    pred2ExecCnt[node] = circuit.inDegree(node);
+    queued[node] = Queued::NONE;
+  }
+
+  /* Input nodes (in_degree == 0) are available for execution directly,
+      they are dealt to workers by decreasing priority */
+  vector<Circuit::vertex_descriptor> inputs;
+  for (Circuit::vertex_descriptor node = 0; node < circuit.size(); ++node) {
+    if (circuit.inDegree(node) == 0) {
+      inputs.push_back(node);
     }
   }
+  stable_sort(inputs.begin(), inputs.end(),
+      [this](const Circuit::vertex_descriptor x, const Circuit::vertex_descriptor y) {
+        return priority->value(x) > priority->value(y);
+      });
+
+  vector<vector<Scheduler::Operation>> dealt(queues.size());
+  for (unsigned int i = 0; i < inputs.size(); ++i) {
+    dealt[i % queues.size()].push_back(executeCmd(inputs[i]));
+  }
+  for (unsigned int w = 0; w < queues.size(); ++w) {
+    reverse(dealt[w].begin(), dealt[w].end());
+    push(w, dealt[w]);
+  }
 }
 
-Scheduler::Operation Scheduler::popFinishedQueue() {
-  unique_lock<mutex> lck(finishedQueueMtx);
-  finishedQueueCond.wait(lck, [this]{return !this->finishedQueue.empty();});
-  Scheduler::Operation oper = finishedQueue.front();
-  finishedQueue.pop();
-  return oper;
+bool Scheduler::popOrSteal(const unsigned int worker, Scheduler::Operation& oper,
+    const bool force) {
+  if (queuedCnt == 0) return false;
+
+  /* Same order with and without a budget while it allows */
+  for (unsigned int k = 0; k < queues.size(); ++k) {
+    const unsigned int victim = (worker + k) % queues.size();
+    const bool own = victim == worker;
+    deque<Scheduler::Operation>& opers = queues[victim].opers;
+    lock_guard<mutex> lck(queues[victim].mtx);
+    auto end = [&]() -> const Scheduler::Operation& {
+      return own ? opers.back() : opers.front();
+    };
+    auto drop = [&]() {
+      if (own) {
+        opers.pop_back();
+      } else {
+        opers.pop_front();
+      }
+    };
+
+    /* operations taken from the budget classes are dropped */
+    while (not opers.empty() and queued[end().node] != queuedState(end())) {
+      drop();
+    }
+    if (opers.empty()) continue;
+
+    oper = end();
+    if (not admit(oper)) break;
+    drop();
+    if (not claim(oper)) {
+      unadmit(oper);
+      continue;
+    }
+    queuedCnt--;
+    runningCnt++;
+    return true;
+  }
+
+  return maxLive > 0 and popBudget(oper, force);
 }
 
-void Scheduler::pushWaitQueue(const Circuit::vertex_descriptor node, const Scheduler::Operation::Type type) {
-  lock_guard<mutex> lck(waitQueueMtx);
-  waitQueue.push(Scheduler::Operation{node, type});
-  waitQueueCond.notify_one();
+bool Scheduler::popBudget(Scheduler::Operation& oper, const bool force) {
+  lock_guard<mutex> lck(budgetMtx);
+
+  /* Lowest budget class first, then highest priority */
+  unsigned int cls = 0;
+  while (cls < budgetQueues.size()) {
+    priority_queue<BudgetEntry>& entries = budgetQueues[cls];
+    if (entries.empty()) {
+      cls++;
+      continue;
+    }
+
+    const BudgetEntry best = entries.top();
+    if (queued[best.oper.node] != queuedState(best.oper)) {
+      entries.pop();
+      continue;
+    }
+
+    /* a class decrease missed by reclassify */
+    const unsigned int now = budgetClass(best.oper);
+    if (now < cls) {
+      entries.pop();
+      budgetQueues[now].push(best);
+      cls = now;
+      continue;
+    }
+
+    const bool admitted = admit(best.oper);
+    if (not admitted and not force) return false;
+    entries.pop();
+    if (not claim(best.oper)) {
+      if (admitted) unadmit(best.oper);
+      continue;
+    }
+    if (not admitted and liveCnt++ >= maxLive) overrunCnt++;
+
+    oper = best.oper;
+    queuedCnt--;
+    runningCnt++;
+    return true;
+  }
+
+  return false;
+}
+
+void Scheduler::reclassify(const vector<Circuit::vertex_descriptor>& nodes) {
+  if (nodes.empty()) return;
+
+  lock_guard<mutex> lck(budgetMtx);
+  for (const Circuit::vertex_descriptor node: nodes) {
+    if (queued[node] != Queued::ALLOCATE) continue;
+    const Scheduler::Operation oper{node, Scheduler::Operation::Type::Execute,
+                                    Circuit::null_vertex()};
+    budgetQueues[budgetClass(oper)].push(BudgetEntry{priority->value(node), oper});
+  }
 }
 
-void Scheduler::pushDeleteCmd(const Circuit::vertex_descriptor node) {
-  pushWaitQueue(node, Scheduler::Operation::Type::Delete);
+bool Scheduler::allocates(const Scheduler::Operation& oper) {
+  return oper.type == Scheduler::Operation::Type::Execute and
+         oper.reuse == Circuit::null_vertex();
 }
 
-void Scheduler::pushExecuteCmd(const Circuit::vertex_descriptor node) {
-  pushWaitQueue(node, Scheduler::Operation::Type::Execute);
+Scheduler::Queued Scheduler::queuedState(const Scheduler::Operation& oper) {
+  if (oper.type == Scheduler::Operation::Type::Delete) return Queued::DELETE;
+  return allocates(oper) ? Queued::ALLOCATE : Queued::EXECUTE;
 }
 
-void Scheduler::executeOperFinished(const Scheduler::Operation& oper) {
-  if (out_degree(oper.node, circuit) > 0) {
-    succ2ExecCnt.emplace(oper.node, out_degree(oper.node, circuit));
-  } else {
-    pushDeleteCmd(oper.node);
+bool Scheduler::claim(const Scheduler::Operation& oper) {
+  uint8_t state = queuedState(oper);
+  return queued[oper.node].compare_exchange_strong(state, Queued::NONE);
+}
+
+bool Scheduler::admit(const Scheduler::Operation& oper) {
+  if (not allocates(oper)) return true;
+  if (maxLive == 0) {
+    liveCnt++;
+    return true;
+  }
+
+  /* An input read filling the budget would block its consumers. Each
+      worker may be reading one, checked against the count the
+      reservation is made on */
+  const bool blocks = circuit.inDegree(oper.node) == 0 and
+                      not consumerCanFollow(oper.node);
+  const unsigned int headroom = blocks ? queues.size() : 0;
+  unsigned int live = liveCnt;
+  while (live + headroom < maxLive) {
+    if (liveCnt.compare_exchange_weak(live, live + 1)) return true;
   }
+  return false;
+}
 
-  /* Update <successors to execute> counter for current node predecessors 
-      and push delete predecessor commands when needed */
-  for(auto it = inv_adjacent_vertices(oper.node, circuit); it.first != it.second; ++it.first) {
-    const Circuit::vertex_descriptor& pred = *(it.first);
-    succ2ExecCnt[pred]--;
-    if (succ2ExecCnt[pred] == 0) {
-      pushDeleteCmd(pred);
+void Scheduler::unadmit(const Scheduler::Operation& oper) {
+  if (allocates(oper)) liveCnt--;
+}
+
+unsigned int Scheduler::budgetClass(const Scheduler::Operation& oper) {
+  if (not allocates(oper)) return 0;
+  if (circuit.inDegree(oper.node) > 0) {
+    return retiresPredecessor(oper.node) ? 1 : 2;
+  }
+  return consumerCanFollow(oper.node) ? 3 : 4;
+}
+
+bool Scheduler::consumerCanFollow(const Circuit::vertex_descriptor node) {
+  for (const Circuit::vertex_descriptor succ: circuit.fanout(node)) {
+    if (pred2ExecCnt[succ] == 1 and retiresPredecessor(succ)) return true;
+  }
+  return false;
+}
+
+bool Scheduler::retiresPredecessor(const Circuit::vertex_descriptor node) {
+  for (const Circuit::vertex_descriptor pred: circuit.fanin(node)) {
+    if (succ2ExecCnt[pred] == 1) return true;
+  }
+  return false;
+}
+
+void Scheduler::finish() {
+  runningCnt--;
+  if (maxLive > 0) {
+    epoch++;
+    if (sleepingCnt > 0) wakeUp(true);
+  }
+}
+
+void Scheduler::push(const unsigned int worker, const vector<Scheduler::Operation>& opers) {
+  if (opers.empty()) return;
+
+  /* counted before they can be taken */
+  queuedCnt += opers.size();
+  for (const Scheduler::Operation& oper: opers) {
+    queued[oper.node] = queuedState(oper);
+  }
+  if (maxLive > 0) {
+    lock_guard<mutex> lck(budgetMtx);
+    for (const Scheduler::Operation& oper: opers) {
+      budgetQueues[budgetClass(oper)].push(
+          BudgetEntry{priority->value(oper.node), oper});
     }
   }
 
-  /* Update <predecessors to execute> counter for current node successors 
-      and push execute successor commands when needed */
-  for(auto it = adjacent_vertices(oper.node, circuit); it.first != it.second; ++it.first) {
-    const Circuit::vertex_descriptor& succ = *(it.first);
-    if (in_degree(succ, circuit) == 1) {
-      pushExecuteCmd(succ); 
-    } else {
-      if (pred2ExecCnt.find(succ) == pred2ExecCnt.end()) {
-        pred2ExecCnt.emplace(succ, in_degree(succ, circuit));
-      }
-      pred2ExecCnt[succ]--;
-      if (pred2ExecCnt[succ] == 0) {
-        pushExecuteCmd(succ);
-      }
+  WorkQueue& queue = queues[worker];
+  {
+    lock_guard<mutex> lck(queue.mtx);
+    queue.opers.insert(queue.opers.end(), opers.begin(), opers.end());
+  }
+
+  epoch++;
+  if (sleepingCnt > 0) {
+    wakeUp(opers.size() > 1);
+  }
+}
+
+Scheduler::Operation Scheduler::executeCmd(const Circuit::vertex_descriptor node) {
+  /* All other successors of a predecessor with a single remaining
+      successor are done, its ciphertext will not be read anymore. A
+      predecessor used twice by the gate keeps a count of 2. */
+  Circuit::vertex_descriptor reuse = Circuit::null_vertex();
+  for (const Circuit::vertex_descriptor pred: circuit.fanin(node)) {
+    if (succ2ExecCnt[pred] == 1) {
+      reuse = pred;
+      taken[pred] = 1;
+      break;
     }
   }
-  executedCnt++;    
+
+  return Scheduler::Operation{node, Scheduler::Operation::Type::Execute, reuse};
+}
+
+void Scheduler::wakeUp(const bool all) {
+  lock_guard<mutex> lck(sleepMtx);
+  if (all) {
+    sleepCond.notify_all();
+  } else {
+    sleepCond.notify_one();
+  }
 }
 
 bool Scheduler::schedFinished() {
-  return executedCnt == num_vertices(circuit);
+  return executedCnt == circuit.size();
 }
@@ -0,0 +1,159 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_blif_circuit.cxx
+ * @brief BLIF covers and circuit loading
+ */
+
+#include "blif_circuit.hxx"
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Covers of 0, 1 and 2 inputs, the first input is a */
+static const struct {
+  const char* cover;
+  unsigned int inpCnt;
+  GateType type;
+  vector<unsigned int> support;
+} COVERS[] = {
+  /* on-set rows */
+  {"11 1;",         2, GateType::AND,     {0, 1}},
+  {"01 1;10 1;",    2, GateType::XOR,     {0, 1}},
+  {"1- 1;-1 1;",    2, GateType::OR,      {0, 1}},
+  {"00 1;",         2, GateType::NOR,     {0, 1}},
+  {"00 1;11 1;",    2, GateType::XNOR,    {0, 1}},
+  {"01 1;",         2, GateType::ANDNY,   {0, 1}},
+  {"10 1;",         2, GateType::ANDYN,   {0, 1}},
+  {"0- 1;-1 1;",    2, GateType::ORNY,    {0, 1}},
+  {"1- 1;-0 1;",    2, GateType::ORYN,    {0, 1}},
+  /* off-set rows */
+  {"11 0;",         2, GateType::NAND,    {0, 1}},
+  {"00 0;",         2, GateType::OR,      {0, 1}},
+  {"01 0;10 0;",    2, GateType::XNOR,    {0, 1}},
+  {"10 0;",         2, GateType::ORNY,    {0, 1}},
+  {"0- 0;-1 0;",    2, GateType::ANDYN,   {0, 1}},
+  /* unused inputs are dropped, b alone is taken as first input */
+  {"1- 1;",         2, GateType::BUFF,    {0}},
+  {"0- 1;",         2, GateType::NOT,     {0}},
+  {"-1 1;",         2, GateType::BUFF,    {1}},
+  {"-0 1;",         2, GateType::NOT,     {1}},
+  {"-1 0;",         2, GateType::NOT,     {1}},
+  {"10 1;11 1;",    2, GateType::BUFF,    {0}},
+  {"01 1;11 1;",    2, GateType::BUFF,    {1}},
+  {"-- 1;",         2, GateType::CONST_1, {}},
+  {"-- 0;",         2, GateType::CONST_0, {}},
+  {"0- 1;1- 1;",    2, GateType::CONST_1, {}},
+  {"",              2, GateType::CONST_0, {}},
+  /* 1 and 0 inputs */
+  {"1 1;",          1, GateType::BUFF,    {0}},
+  {"0 1;",          1, GateType::NOT,     {0}},
+  {"1 0;",          1, GateType::NOT,     {0}},
+  {"- 1;",          1, GateType::CONST_1, {}},
+  {"1;",            0, GateType::CONST_1, {}},
+  {"0;",            0, GateType::CONST_0, {}},
+  {"",              0, GateType::CONST_0, {}},
+};
+
+/* Covers which are rejected */
+static const struct {
+  const char* cover;
+  unsigned int inpCnt;
+} INVALID_COVERS[] = {
+  {"11 1;00 0;",    2},   /* on-set and off-set rows */
+  {"1- 1;-0 0;",    2},
+  {"111 1;",        3},   /* more than 2 inputs */
+  {"1-- 1;",        3},
+  {"1 1;",          2},   /* pattern size */
+  {"11 1;",         1},
+  {"11 2;",         2},   /* value */
+  {"11;",           2},
+};
+
+TEST(BlifCover, GateTypes) {
+  for (const auto& c: COVERS) {
+    vector<unsigned int> support = {7, 7, 7};
+    EXPECT_EQ(parseTruthTableString(c.cover, c.inpCnt, support), c.type)
+        << "cover \"" << c.cover << "\"";
+    EXPECT_EQ(support, c.support) << "cover \"" << c.cover << "\"";
+  }
+}
+
+TEST(BlifCover, Rejected) {
+  for (const auto& c: INVALID_COVERS) {
+    vector<unsigned int> support;
+    EXPECT_THROW(parseTruthTableString(c.cover, c.inpCnt, support), runtime_error)
+        << "cover \"" << c.cover << "\"";
+  }
+}
+
+TEST(BlifCircuit, Load) {
+  char fileName[] = "/tmp/dyn_omp_blif_XXXXXX";
+  const int fd = mkstemp(fileName);
+  ASSERT_GE(fd, 0);
+  FILE* stream = fdopen(fd, "w");
+  fputs(".model test\n"
+        ".inputs a b\n"
+        ".outputs x y z\n"
+        ".names a b x\n"
+        "00 0\n"
+        ".names a b y\n"
+        "-0 1\n"
+        ".names a b z\n"
+        "11 0\n"
+        ".end\n", stream);
+  fclose(stream);
+
+  const Circuit circuit = ReadBlifFile(fileName);
+  remove(fileName);
+
+  const struct {
+    const char* id;
+    GateType type;
+    vector<string> fanin;
+  } expected[] = {
+    {"a", GateType::INPUT, {}},
+    {"b", GateType::INPUT, {}},
+    {"x", GateType::OR,    {"a", "b"}},
+    {"y", GateType::NOT,   {"b"}},
+    {"z", GateType::NAND,  {"a", "b"}},
+  };
+  ASSERT_EQ(circuit.size(), 5u);
+  for (const auto& gate: expected) {
+    Circuit::vertex_descriptor node = 0;
+    while (node < circuit.size() and circuit.id(node) != gate.id) node++;
+    ASSERT_LT(node, circuit.size()) << gate.id;
+
+    EXPECT_EQ(circuit.type(node), gate.type) << gate.id;
+    EXPECT_EQ(circuit.isOutput(node), circuit.inDegree(node) > 0) << gate.id;
+    vector<string> fanin;
+    for (const Circuit::vertex_descriptor pred: circuit.fanin(node)) {
+      fanin.push_back(circuit.id(pred));
+    }
+    EXPECT_EQ(fanin, gate.fanin) << gate.id;
+  }
+}
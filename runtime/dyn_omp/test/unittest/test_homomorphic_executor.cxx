@@ -0,0 +1,151 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_homomorphic_executor.cxx
+ * @brief Gates on encrypted, clear and constant inputs
+ */
+
+#include "fhe_test.hxx"
+#include "blif_circuit.hxx"
+#include "homomorphic_executor.hxx"
+#include "priority.hxx"
+#include "scheduler.hxx"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/* Gates with a negated input or output and their truth */
+static const pair<GateType, bool (*)(bool, bool)> NEGATED_GATES[] = {
+  {GateType::NAND,  [](bool a, bool b) { return not (a and b); }},
+  {GateType::NOR,   [](bool a, bool b) { return not (a or b); }},
+  {GateType::XNOR,  [](bool a, bool b) { return a == b; }},
+  {GateType::ANDNY, [](bool a, bool b) { return not a and b; }},
+  {GateType::ANDYN, [](bool a, bool b) { return a and not b; }},
+  {GateType::ORNY,  [](bool a, bool b) { return not a or b; }},
+  {GateType::ORYN,  [](bool a, bool b) { return a or not b; }},
+};
+
+/* Operands: encrypted inputs, clear inputs and constant gates */
+static const pair<const char*, bool> OPERANDS[] = {
+  {"enc_0", false}, {"enc_1", true},
+  {"clear_0", false}, {"clear_1", true},
+  {"const_0", false}, {"const_1", true},
+};
+
+class HomomorphicExecutorGates: public FheTest {
+  protected:
+    char* cwd = nullptr;
+
+    void SetUp() override {
+      FheTest::SetUp();
+
+      /* The executor reads inputs and writes outputs in the working
+          directory */
+      cwd = getcwd(nullptr, 0);
+      ASSERT_EQ(chdir(dir.c_str()), 0);
+      ASSERT_EQ(system("mkdir input output"), 0);
+    }
+
+    void TearDown() override {
+      ASSERT_EQ(chdir(cwd), 0);
+      free(cwd);
+      FheTest::TearDown();
+    }
+
+    /* Each negated gate on each pair of operands */
+    void checkNegatedGates() {
+      vector<GateProperties> gates;
+      vector<pair<unsigned int, unsigned int>> edges;
+      for (const auto& operand: OPERANDS) {
+        const string id = operand.first;
+        if (id.compare(0, 5, "const") == 0) {
+          gates.push_back(GateProperties(id, operand.second ? GateType::CONST_1
+                                                            : GateType::CONST_0));
+        } else {
+          gates.push_back(GateProperties(id, GateType::INPUT));
+        }
+      }
+
+      vector<bool> expected;
+      const unsigned int nrOperands = gates.size();
+      for (const auto& gate: NEGATED_GATES) {
+        for (unsigned int x = 0; x < nrOperands; ++x) {
+          for (unsigned int y = 0; y < nrOperands; ++y) {
+            edges.emplace_back(x, gates.size());
+            edges.emplace_back(y, gates.size());
+            gates.push_back(GateProperties("o" + to_string(expected.size()),
+                                           gate.first, true));
+            expected.push_back(gate.second(OPERANDS[x].second, OPERANDS[y].second));
+          }
+        }
+      }
+
+      Circuit circuit(gates, edges);
+      UpdateCircuitWithClearInputs(circuit, {{"clear_0", false}, {"clear_1", true}});
+
+      encrypt(0).write("input/enc_0.ct");
+      encrypt(1).write("input/enc_1.ct");
+
+      /* Executed as dyn_omp does, dead operands are taken over */
+      {
+        HomomorphicExecutor executor(circuit, "fhe_key.evk", "fhe_key.pk",
+                                     false, false);
+        PriorityTopological priority(circuit);
+        Scheduler scheduler(circuit, &priority);
+        Scheduler::Operation oper = scheduler.next(0);
+        while (oper.type != Scheduler::Operation::Type::Done) {
+          if (oper.type == Scheduler::Operation::Type::Execute) {
+            executor.ExecuteGate(oper.node, oper.reuse);
+          } else {
+            executor.DeleteGateData(oper.node);
+          }
+          scheduler.done(0, oper);
+          oper = scheduler.next(0);
+        }
+      }
+
+      for (unsigned int i = 0; i < expected.size(); ++i) {
+        const unsigned int k = i % (nrOperands * nrOperands);
+        CipherText ct;
+        ct.read("output/o" + to_string(i) + ".ct");
+        EXPECT_EQ(decrypt(ct), expected[i] ? 1u : 0u)
+            << "gate " << (unsigned int)NEGATED_GATES[i / (nrOperands * nrOperands)].first
+            << " on " << OPERANDS[k / nrOperands].first
+            << ", " << OPERANDS[k % nrOperands].first;
+      }
+    }
+};
+
+typedef WithRns<HomomorphicExecutorGates> HomomorphicExecutorGatesRns;
+
+TEST_F(HomomorphicExecutorGates, NegatedGates) {
+  checkNegatedGates();
+}
+
+TEST_F(HomomorphicExecutorGatesRns, NegatedGates) {
+  checkNegatedGates();
+}
@@ -0,0 +1,288 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_scheduler.cxx
+ * @brief Circuit numbering and ciphertext budget of the scheduler
+ */
+
+#include "blif_circuit.hxx"
+#include "priority.hxx"
+#include "scheduler.hxx"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+typedef vector<pair<unsigned int, unsigned int>> Edges;
+
+/* Ripple carry adder listed as the compiler does, all half adders
+    first, inputs are never taken over as output buffers */
+static Circuit adder(const unsigned int bits) {
+  vector<GateProperties> gates;
+  Edges edges;
+  auto gate = [&](const string& id, const GateType type,
+      const vector<unsigned int>& preds) {
+    for (const unsigned int pred: preds) {
+      edges.emplace_back(pred, gates.size());
+    }
+    gates.push_back(GateProperties(id, type));
+    return gates.size() - 1;
+  };
+
+  vector<unsigned int> a, b, p, g;
+  for (unsigned int i = 0; i < bits; ++i) {
+    a.push_back(gate("a_" + to_string(i), GateType::INPUT, {}));
+  }
+  for (unsigned int i = 0; i < bits; ++i) {
+    b.push_back(gate("b_" + to_string(i), GateType::INPUT, {}));
+  }
+  for (unsigned int i = 0; i < bits; ++i) {
+    p.push_back(gate("p_" + to_string(i), GateType::XOR, {a[i], b[i]}));
+  }
+  for (unsigned int i = 0; i < bits; ++i) {
+    g.push_back(gate("g_" + to_string(i), GateType::AND, {a[i], b[i]}));
+  }
+  unsigned int carry = g[0];
+  gates[p[0]].isOutput = true;
+  for (unsigned int i = 1; i < bits; ++i) {
+    const unsigned int s = gate("s_" + to_string(i), GateType::XOR, {p[i], carry});
+    gates[s].isOutput = true;
+    const unsigned int t = gate("t_" + to_string(i), GateType::AND, {p[i], carry});
+    carry = gate("c_" + to_string(i), GateType::OR, {g[i], t});
+  }
+  gates[carry].isOutput = true;
+
+  return Circuit(gates, edges);
+}
+
+/* Random circuit of 1- and 2-input gates reading recent gates */
+static Circuit randomCircuit(const unsigned int n, const unsigned int seed) {
+  mt19937 rng(seed);
+  vector<GateProperties> gates;
+  Edges edges;
+  for (unsigned int i = 0; i < n; ++i) {
+    if (i < 5 or rng() % 50 == 0) {
+      gates.push_back(GateProperties("g" + to_string(i), GateType::INPUT));
+      continue;
+    }
+    gates.push_back(GateProperties("g" + to_string(i), GateType::AND));
+    const unsigned int k = 1 + rng() % 2;
+    for (unsigned int j = 0; j < k; ++j) {
+      edges.emplace_back(i - 1 - rng() % min(i, 64u), i);
+    }
+  }
+  return Circuit(gates, edges);
+}
+
+/* Balanced XOR tree, listed level by level */
+static Circuit tree(const unsigned int leaves) {
+  vector<GateProperties> gates;
+  Edges edges;
+  vector<unsigned int> level;
+  for (unsigned int i = 0; i < leaves; ++i) {
+    level.push_back(gates.size());
+    gates.push_back(GateProperties("x_" + to_string(i), GateType::INPUT));
+  }
+  while (level.size() > 1) {
+    vector<unsigned int> next;
+    for (unsigned int i = 0; i + 1 < level.size(); i += 2) {
+      edges.emplace_back(level[i], gates.size());
+      edges.emplace_back(level[i + 1], gates.size());
+      next.push_back(gates.size());
+      gates.push_back(GateProperties("g_" + to_string(gates.size()), GateType::XOR));
+    }
+    if (level.size() % 2 == 1) next.push_back(level.back());
+    level = next;
+  }
+  gates[level[0]].isOutput = true;
+  return Circuit(gates, edges);
+}
+
+struct Usage {
+  unsigned int peak;
+  unsigned int overruns;
+  unsigned int errors;
+};
+
+/* Execute the operations of the scheduler and count live ciphertexts
+    as the homomorphic executor allocates them */
+static Usage execute(const Circuit& circuit, const unsigned int nrWorkers,
+    const unsigned int maxLive) {
+  const unsigned int n = circuit.size();
+  vector<atomic<int>> executed(n), deleted(n), live(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    executed[i] = deleted[i] = live[i] = 0;
+  }
+  atomic<unsigned int> liveCnt(0), peak(0), errors(0);
+
+  PriorityTopological priority(circuit);
+  Scheduler scheduler(circuit, &priority, nrWorkers, maxLive);
+
+  vector<thread> workers;
+  for (unsigned int w = 0; w < nrWorkers; ++w) {
+    workers.emplace_back([&, w]() {
+      Scheduler::Operation oper;
+      do {
+        oper = scheduler.next(w);
+        if (oper.type == Scheduler::Operation::Type::Execute) {
+          for (const Circuit::vertex_descriptor pred: circuit.fanin(oper.node)) {
+            if (executed[pred] != 1 or deleted[pred] != 0) errors++;
+          }
+          if (oper.reuse != Circuit::null_vertex()) {
+            if (live[oper.reuse].exchange(0) != 1) errors++;
+          } else {
+            const unsigned int cnt = ++liveCnt;
+            unsigned int prev = peak;
+            while (prev < cnt and not peak.compare_exchange_weak(prev, cnt));
+          }
+          live[oper.node] = 1;
+          if (executed[oper.node]++ != 0) errors++;
+        } else if (oper.type == Scheduler::Operation::Type::Delete) {
+          for (const Circuit::vertex_descriptor succ: circuit.fanout(oper.node)) {
+            if (executed[succ] != 1) errors++;
+          }
+          if (deleted[oper.node]++ != 0) errors++;
+          if (live[oper.node].exchange(0) == 1) liveCnt--;
+        }
+        if (oper.type != Scheduler::Operation::Type::Done) {
+          scheduler.done(w, oper);
+        }
+      } while (oper.type != Scheduler::Operation::Type::Done);
+    });
+  }
+  for (thread& worker: workers) {
+    worker.join();
+  }
+
+  for (unsigned int i = 0; i < n; ++i) {
+    if (executed[i] != 1 or deleted[i] != 1) errors++;
+  }
+  if (liveCnt != 0) errors++;
+  return Usage{peak, scheduler.overruns(), errors};
+}
+
+TEST(CircuitOrder, InputsBeforeFirstConsumer) {
+  vector<GateProperties> gates = {
+    GateProperties("x", GateType::INPUT),
+    GateProperties("y", GateType::INPUT),
+    GateProperties("z", GateType::INPUT),
+    GateProperties("u", GateType::INPUT),
+    GateProperties("g1", GateType::AND),
+    GateProperties("g2", GateType::XOR, true),
+  };
+  const Edges edges = {{0, 4}, {1, 4}, {4, 5}, {2, 5}};
+  const Circuit circuit(gates, edges);
+
+  const vector<string> order = {"x", "y", "g1", "z", "g2", "u"};
+  ASSERT_EQ(circuit.size(), order.size());
+  for (unsigned int k = 0; k < order.size(); ++k) {
+    EXPECT_EQ(circuit.id(k), order[k]);
+  }
+}
+
+TEST(SchedulerBudget, ExecutesAllOperations) {
+  const Circuit circuit = randomCircuit(1000, 1);
+  for (const unsigned int nrWorkers: {1u, 4u}) {
+    for (const unsigned int maxLive: {0u, 4u, 20u}) {
+      EXPECT_EQ(execute(circuit, nrWorkers, maxLive).errors, 0u)
+          << nrWorkers << " workers, budget " << maxLive;
+    }
+  }
+}
+
+TEST(SchedulerBudget, UnbudgetedPeakIsNeverExceeded) {
+  vector<pair<string, Circuit>> circuits;
+  for (const unsigned int bits: {8u, 16u, 32u}) {
+    circuits.emplace_back("adder " + to_string(bits), adder(bits));
+  }
+  for (const unsigned int n: {60u, 300u, 1000u}) {
+    for (unsigned int seed = 1; seed <= 20; ++seed) {
+      circuits.emplace_back("random " + to_string(n) + "/" + to_string(seed),
+                            randomCircuit(n, seed));
+    }
+  }
+
+  for (const pair<string, Circuit>& c: circuits) {
+    const unsigned int peak = execute(c.second, 1, 0).peak;
+    for (const unsigned int maxLive: {peak, peak + 1, peak + 5}) {
+      const Usage r = execute(c.second, 1, maxLive);
+      EXPECT_LE(r.peak, maxLive) << c.first << ", budget " << maxLive;
+      EXPECT_EQ(r.overruns, 0u) << c.first << ", budget " << maxLive;
+      EXPECT_EQ(r.errors, 0u) << c.first << ", budget " << maxLive;
+    }
+  }
+}
+
+TEST(SchedulerBudget, InputsAreReadWithTheirConsumers) {
+  /* All inputs read up front would hold 64 ciphertexts */
+  const Circuit circuit = adder(32);
+  const unsigned int peak = execute(circuit, 1, 0).peak;
+  EXPECT_LT(peak, 16u);
+
+  const Usage r = execute(circuit, 1, peak - 1);
+  EXPECT_LT(r.peak, peak + 2);
+  EXPECT_EQ(r.errors, 0u);
+}
+
+TEST(SchedulerBudget, BindingBudgetWithWorkers) {
+  /* Parallel workers read more inputs than a single one, which fits
+      trees in their depth */
+  for (const unsigned int leaves: {64u, 100u, 256u}) {
+    const Circuit circuit = tree(leaves);
+    const unsigned int peak = execute(circuit, 1, 0).peak;
+    for (const unsigned int nrWorkers: {2u, 4u, 8u}) {
+      EXPECT_GT(execute(circuit, nrWorkers, 0).peak, peak + 2)
+          << "tree " << leaves << ", " << nrWorkers << " workers";
+      for (const unsigned int maxLive: {peak, peak + 2}) {
+        const Usage r = execute(circuit, nrWorkers, maxLive);
+        EXPECT_LE(r.peak, maxLive) << "tree " << leaves << ", "
+            << nrWorkers << " workers, budget " << maxLive;
+        EXPECT_EQ(r.overruns, 0u) << "tree " << leaves << ", "
+            << nrWorkers << " workers, budget " << maxLive;
+        EXPECT_EQ(r.errors, 0u);
+      }
+    }
+  }
+}
+
+TEST(SchedulerBudget, OverrunsAreCounted) {
+  /* Budgets below what the circuits need, the peak goes over them only
+      by gates forced when nothing else could progress */
+  for (unsigned int seed = 1; seed <= 10; ++seed) {
+    const Circuit circuit = randomCircuit(300, seed);
+    const unsigned int peak = execute(circuit, 1, 0).peak;
+    for (const unsigned int nrWorkers: {1u, 4u}) {
+      for (const unsigned int maxLive: {peak - 1, peak / 2, 2u}) {
+        const Usage r = execute(circuit, nrWorkers, maxLive);
+        EXPECT_LE(r.peak, maxLive + r.overruns) << "random " << seed << ", "
+            << nrWorkers << " workers, budget " << maxLive;
+        EXPECT_EQ(r.errors, 0u);
+      }
+    }
+  }
+}
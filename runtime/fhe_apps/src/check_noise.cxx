@@ -0,0 +1,214 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file check_noise.cxx
+ * @brief Statistical test of the noise samplers output distribution
+ */
+
+#include "fv.hxx"
+
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <math.h>
+
+#include <boost/program_options.hpp>
+
+using namespace std;
+namespace po = boost::program_options;
+
+struct Options {
+  string FheParamsFile;
+  unsigned int PolyCnt;
+  double Threshold;
+};
+
+Options parseArgs(int argc, char** argv) {
+  Options options;
+
+  po::options_description config("Options");
+  config.add_options()
+      ("fhe-params", po::value<string>(&options.FheParamsFile)->default_value("fhe_params.xml"), "FHE parameters file")
+      ("poly-cnt", po::value<unsigned int>(&options.PolyCnt)->default_value(1000), "Number of sampled polynomials per distribution")
+      ("threshold", po::value<double>(&options.Threshold)->default_value(4.0), "Maximal accepted z-score of test statistics")
+      ("help,h", "produce help message")
+  ;
+
+  try {
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(config)
+                  .run(),
+              vm);
+
+    if (vm.count("help")) {
+      cout << "Check that sampled noise polynomials follow the discrete Gaussian distributions of the parameters" << endl;
+      cout << "Exit status is non zero if a test fails" << endl;
+      cout << config << endl;
+      exit(0);
+    }
+
+    po::notify(vm);
+  } catch (po::error& e) {
+    cerr << "ERROR: " << e.what() << endl;
+    cerr << config << endl;
+    exit(-1);
+  } catch (...) {
+    cerr << "Something went wrong!!!" << endl;
+    cerr << config << endl;
+    exit(-1);
+  }
+
+  return options;
+}
+
+/** @brief Largest distribution interval bound which is tested
+ */
+const slong MAX_BOUND = 1 << 20;
+
+/** @brief Test the distribution of \c polyCnt noise polynomials
+ *
+ *  Sampled values must belong to \c{[-B;B]}. The histogram is compared
+ *    with the discrete Gaussian \c{rho(x) = exp(-x^2/(2.sigma^2))} on
+ *    \c{[-B;B]} with a chi-squared test, values with less than 5
+ *    expected occurrences are merged in two tail bins. The chi-squared
+ *    statistic is normalized with the Wilson-Hilferty transform. Mean
+ *    and variance z-scores are reported too.
+ *
+ *  @return true if all z-scores are below \c threshold
+ */
+bool checkDistribution(const string& name, const fmpz_t sigma, const fmpz_t B,
+                       const unsigned int polyCnt, const double threshold) {
+  cout << name << ": sigma " << fmpz_get_si(sigma) << ", bound "
+       << fmpz_get_si(B) << endl;
+  if (not fmpz_fits_si(B) or fmpz_get_si(B) > MAX_BOUND) {
+    cout << "  bound too large, skipped" << endl;
+    return true;
+  }
+
+  const slong bound = fmpz_get_si(B);
+  const double s = fmpz_get_d(sigma);
+
+  /* expected probabilities */
+  vector<double> prob(2 * bound + 1);
+  double sum = 0;
+  for (slong x = -bound; x <= bound; ++x) {
+    prob[x + bound] = s == 0 ? (x == 0) : exp(-(double)x * x / (2 * s * s));
+    sum += prob[x + bound];
+  }
+  double var = 0;
+  for (slong x = -bound; x <= bound; ++x) {
+    prob[x + bound] /= sum;
+    var += prob[x + bound] * x * x;
+  }
+
+  /* sample */
+  vector<uint64_t> hist(2 * bound + 1, 0);
+  uint64_t outside = 0;
+  double s1 = 0, s2 = 0;
+  const uint64_t n = (uint64_t)polyCnt * FheParams::get().D;
+
+  fmpz_poly_t poly;
+  fmpz_poly_init(poly);
+  for (unsigned int i = 0; i < polyCnt; ++i) {
+    RandPolynom::sampleNormal(poly, FheParams::get().D, sigma, B);
+    for (unsigned int k = 0; k < FheParams::get().D; ++k) {
+      const slong x = k < (unsigned int)fmpz_poly_length(poly) ?
+                        fmpz_get_si(poly->coeffs + k) : 0;
+      if (x < -bound or x > bound) {
+        outside++;
+        continue;
+      }
+      hist[x + bound]++;
+      s1 += x;
+      s2 += (double)x * x;
+    }
+  }
+  fmpz_poly_clear(poly);
+
+  /* chi-squared test with merged tails */
+  double chi2 = 0;
+  unsigned int bins = 0;
+  double tailExp = 0, tailObs = 0;
+  for (slong x = -bound; x <= bound; ++x) {
+    const double e = prob[x + bound] * n;
+    if (e < 5) {
+      tailExp += e;
+      tailObs += hist[x + bound];
+      if (x < 0 and prob[x + 1 + bound] * n >= 5) {
+        if (tailExp > 0) chi2 += (tailObs - tailExp) * (tailObs - tailExp) / tailExp;
+        bins++;
+        tailExp = tailObs = 0;
+      }
+    } else {
+      chi2 += (hist[x + bound] - e) * (hist[x + bound] - e) / e;
+      bins++;
+    }
+  }
+  if (tailExp > 0) {
+    chi2 += (tailObs - tailExp) * (tailObs - tailExp) / tailExp;
+    bins++;
+  }
+
+  const double df = bins > 1 ? bins - 1 : 1;
+  const double zChi2 = (cbrt(chi2 / df) - (1 - 2 / (9 * df))) /
+                        sqrt(2 / (9 * df));
+  const double mean = s1 / n;
+  const double zMean = var > 0 ? mean / sqrt(var / n) : 0;
+  const double sampleVar = s2 / n - mean * mean;
+  /* variance of x^2 estimated from the expected distribution */
+  double m4 = 0;
+  for (slong x = -bound; x <= bound; ++x) {
+    m4 += prob[x + bound] * pow((double)x, 4);
+  }
+  const double zVar = m4 > var * var ?
+                        (sampleVar - var) / sqrt((m4 - var * var) / n) : 0;
+
+  const bool ok = outside == 0 and fabs(zMean) < threshold and
+                  fabs(zVar) < threshold and zChi2 < threshold;
+
+  cout << fixed << setprecision(4)
+       << "  samples " << n << ", outside bound " << outside << endl
+       << "  mean " << mean << " (z " << zMean << ")" << endl
+       << "  variance " << sampleVar << ", expected " << var
+       << " (z " << zVar << ")" << endl
+       << "  chi2 " << chi2 << ", " << (unsigned int)df << " dof (z "
+       << zChi2 << ")" << endl
+       << "  " << (ok ? "OK" : "FAIL") << endl;
+
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  Options options = parseArgs(argc, argv);
+
+  FheParams::readXml(options.FheParamsFile.c_str());
+
+  bool ok = checkDistribution("ciphertext noise", FheParams::get().SIGMA,
+                              FheParams::get().B, options.PolyCnt,
+                              options.Threshold);
+  ok = checkDistribution("key switching noise", FheParams::get().SIGMA_K,
+                         FheParams::get().B_K, options.PolyCnt,
+                         options.Threshold) and ok;
+
+  return ok ? 0 : 1;
+}
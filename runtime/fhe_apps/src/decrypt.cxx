@@ -39,6 +39,7 @@ struct Options {
   string SecretKeyFile;
   bool signedMessage;
   bool noise;
+  bool batch;
   unsigned int nbCoeffs;
   unsigned  int nrThreads;
   vector<string> InputFiles;
@@ -55,6 +56,7 @@ Options parseArgs(int argc, char** argv) {
       ("signed,s", po::bool_switch(&options.signedMessage)->default_value(false), "Interpret decrypted messages as signed integers")
 
       ("nb_coef", po::value<unsigned  int>(&options.nbCoeffs)->default_value(1), "Number of polynomial coefficients to output (first one only by default). Use '0' for all coefficients.")
+      ("batch", po::bool_switch(&options.batch)->default_value(false), "Decode plaintext slots (CRT batching) instead of polynomial coefficients, 'nb_coef' is the number of slots")
 
       ("noise", po::bool_switch(&options.noise)->default_value(false), "Output ciphertext noise (only works with verbose option on)")
       ("threads", po::value<unsigned  int>(&options.nrThreads)->default_value(1), "Number of parallel execution threads")
@@ -89,6 +91,8 @@ Options parseArgs(int argc, char** argv) {
         " [options] f0.ct f1.ct f2.ct" << endl;
       cout << "Example 2 - decrypt first 3 coefficients from f0.ct, f1.ct and f2.ct:\n\t" << argv[0] <<
         " [options] f0.ct f1.ct f2.ct --nb_coef 3" << endl;
+      cout << "Example 3 - decrypt first 3 slots from batched f0.ct and f1.ct:\n\t" << argv[0] <<
+        " [options] f0.ct f1.ct --batch --nb_coef 3" << endl;
       cout << config << endl;
       exit(0);
     }
@@ -113,7 +117,14 @@ int main(int argc, char **argv) {
   FheParams::readXml(options.FheParamsFile.c_str());
 
   /* Validate options vs FHE parameters */
-  unsigned int availNbCoefs = FheParams::D;
+  if (options.batch and not Batching::isAvailable()) {
+    cerr << "ERROR: Slot batching needs a power of two cyclotomic polynomial"
+      << " and a prime plaintext modulus congruent to 1 modulo "
+      << 2 * FheParams::get().D << endl;
+    exit(-1);
+  }
+
+  unsigned int availNbCoefs = FheParams::get().D;
   if (options.nbCoeffs == 0) {
     options.nbCoeffs = availNbCoefs;
   }
@@ -132,59 +143,85 @@ int main(int argc, char **argv) {
     cout << "Secret key file " << options.SecretKeyFile << endl;
     if (options.nbCoeffs > 1) {
       cout << "Decrypt packed ciphertext: ";
-      cout << "use coefficient packing for the first ";
-      cout << options.nbCoeffs << " coefficients" << endl;
+      if (options.batch) {
+        cout << "use slot batching for the first ";
+        cout << options.nbCoeffs << " slots" << endl;
+      } else {
+        cout << "use coefficient packing for the first ";
+        cout << options.nbCoeffs << " coefficients" << endl;
+      }
     }
   }
 
   KeysAll keys;
   keys.readSecretKey(options.SecretKeyFile.c_str());
 
-  #pragma omp parallel for ordered num_threads(options.nrThreads)
-  for (unsigned int i = 0; i < options.InputFiles.size(); i++) {
-    string fileName = options.InputFiles[i];
+  Batching* batching = options.batch ? new Batching() : nullptr;
 
-    CipherText ct;
-    ct.read(fileName.c_str());
+  /* OpenMP threads use the parameters read by the main thread */
+  shared_ptr<const FheContext> context = FheContext::current();
 
-    PolyRing pTxtPoly = EncDec::DecryptPoly(ct, *keys.SecretKey);
-    unsigned int noise;
-    if (options.noise) {
-      noise = EncDec::Noise(ct, *keys.SecretKey);
-    }
+  #pragma omp parallel num_threads(options.nrThreads)
+  {
+    FheContext::Scope scope(context);
 
-    vector<int> msgs;
-    for (unsigned int c = 0; c < options.nbCoeffs; ++c) {
-      if (c < pTxtPoly.length()) {
-        int msg = pTxtPoly.getCoeffUi(c);
-        if (options.signedMessage and (unsigned int)msg > FheParams::T/2) msg -= FheParams::T;
-        msgs.push_back(msg);
-      } else {
-        msgs.push_back(0);
+    #pragma omp for ordered
+    for (unsigned int i = 0; i < options.InputFiles.size(); i++) {
+      string fileName = options.InputFiles[i];
+
+      CipherText ct;
+      ct.read(fileName.c_str());
+
+      PolyRing pTxtPoly = EncDec::DecryptPoly(ct, *keys.SecretKey);
+      unsigned int noise;
+      if (options.noise) {
+        noise = EncDec::Noise(ct, *keys.SecretKey);
       }
-    }
 
-    #pragma omp ordered
-    {
-      if (options.verbose) {
-        cout << "Decrypting file " << fileName;
-        if (options.noise) {
-          cout << " - noise " << noise << "/" << FheParams::Q_bitsize;
+      vector<unsigned int> values;
+      if (batching) {
+        values = batching->decode(pTxtPoly);
+      } else {
+        for (unsigned int c = 0; c < pTxtPoly.length(); ++c) {
+          values.push_back(pTxtPoly.getCoeffUi(c));
         }
-        cout << " - message [";
       }
 
-      for (unsigned int i = 0; i < msgs.size(); ++i) {
-        cout << msgs[i];
-        if (i < msgs.size()-1)
-          cout << " ";
+      vector<int> msgs;
+      for (unsigned int c = 0; c < options.nbCoeffs; ++c) {
+        if (c < values.size()) {
+          int msg = values[c];
+          if (options.signedMessage and (unsigned int)msg > FheParams::get().T/2) msg -= FheParams::get().T;
+          msgs.push_back(msg);
+        } else {
+          msgs.push_back(0);
+        }
       }
-      if (options.verbose) {
-        cout << "]";  
+
+      #pragma omp ordered
+      {
+        if (options.verbose) {
+          cout << "Decrypting file " << fileName;
+          if (options.noise) {
+            cout << " - noise " << noise << "/" << FheParams::get().Q_bitsize;
+          }
+          cout << " - message [";
+        }
+
+        for (unsigned int i = 0; i < msgs.size(); ++i) {
+          cout << msgs[i];
+          if (i < msgs.size()-1)
+            cout << " ";
+        }
+        if (options.verbose) {
+          cout << "]";  
+        }
+        cout << endl;
       }
-      cout << endl;
     }
   }
 
+  delete batching;
+
   return 0;
 }
@@ -40,8 +40,10 @@ namespace ba = boost::algorithm;
 struct Options {
   string FheParamsFile;
   string PublicKeyFile;
+  string SecretKeyFile;
   string MessageFile;
   bool clear;
+  bool batch;
   unsigned int nbCoeffs;
   unsigned int nrThreads;
   vector< pair<string, vector<unsigned int> > > OutputFilesMessages;
@@ -117,8 +119,10 @@ Options parseArgs(int argc, char** argv) {
   config.add_options()
       ("fhe-params", po::value<string>(&options.FheParamsFile)->default_value("fhe_params.xml"), "FHE parameters file")
       ("public-key", po::value<string>(&options.PublicKeyFile)->default_value("fhe_key.pk"), "Public key file")
+      ("secret-key", po::value<string>(&options.SecretKeyFile)->default_value(""), "Encrypt with this secret key instead, ciphertexts store a seed instead of their uniform polynomial (about half size)")
       ("inp-file", po::value<string>(&options.MessageFile), "Read '<output file> [<message>]+' pairs from file")
       ("clear", po::bool_switch(&options.clear)->default_value(false), "'Encrypt' clear messages")
+      ("batch", po::bool_switch(&options.batch)->default_value(false), "Encode messages into plaintext slots (CRT batching) instead of polynomial coefficients")
       ("threads", po::value<unsigned int>(&options.nrThreads)->default_value(1), "Number of parallel execution threads")
       ("help,h", "produce help message")
       ("verbose,v", po::bool_switch(&options.verbose)->default_value(false), "enable verbosity")
@@ -158,6 +162,9 @@ Options parseArgs(int argc, char** argv) {
       cout << "\tExample 2 - encrypt several messages into a ciphertext using"
               " coefficient packing:\n\t" << argv[0] <<
               " [options] f0.ct 0 f1.ct 1 0 1 f2.ct 1 1\n"; 
+      cout << "\tExample 3 - encrypt several records into a ciphertext using"
+              " slot batching, gates act slot-wise:\n\t" << argv[0] <<
+              " [options] --batch f0.ct 0 1 1 f1.ct 1 1 0\n";
 
       cout << config << endl;
       exit(0);
@@ -234,7 +241,14 @@ int main(int argc, char **argv) {
   FheParams::readXml(options.FheParamsFile.c_str());
 
   /* Validate options vs FHE parameters */
-  unsigned int availNbCoefs = FheParams::D;
+  if (options.batch and not Batching::isAvailable()) {
+    cerr << "ERROR: Slot batching needs a power of two cyclotomic polynomial"
+      << " and a prime plaintext modulus congruent to 1 modulo "
+      << 2 * FheParams::get().D << endl;
+    exit(-1);
+  }
+
+  unsigned int availNbCoefs = FheParams::get().D;
   if (options.nbCoeffs == 0) {
     options.nbCoeffs = availNbCoefs;
   }
@@ -250,41 +264,63 @@ int main(int argc, char **argv) {
   if (options.verbose) {
     cout << "Command line arguments:" << endl;
     cout << "FHE parameters file " << options.FheParamsFile << endl;
-    cout << "Public key file " << options.PublicKeyFile << endl;
+    if (options.SecretKeyFile.empty()) {
+      cout << "Public key file " << options.PublicKeyFile << endl;
+    } else {
+      cout << "Secret key file " << options.SecretKeyFile << endl;
+    }
     if (options.nbCoeffs > 1) {
       cout << "Encrypt packed ciphertext: ";
-      cout << "use coefficient packing" << endl;
+      cout << (options.batch ? "use slot batching" : "use coefficient packing") << endl;
     }
   }
 
-  KeysShare keys;
-  keys.readPublicKey(options.PublicKeyFile);
-
-  #pragma omp parallel for num_threads(options.nrThreads)
-  for (unsigned int i = 0; i < options.OutputFilesMessages.size(); ++i) {
-    const string& out_fn = options.OutputFilesMessages[i].first;
-    const vector<unsigned int>& msgs = options.OutputFilesMessages[i].second;
-
-    #pragma omp critical
-    if (options.verbose) {
-      cout << "Encrypting message [";
-      for (unsigned int i = 0; i < msgs.size(); ++i) {
-        cout << msgs[i];
-        if (i < msgs.size()-1)
-          cout << " ";
+  KeysAll keys;
+  if (options.SecretKeyFile.empty()) {
+    keys.readPublicKey(options.PublicKeyFile);
+  } else if (not options.clear) {
+    keys.readSecretKey(options.SecretKeyFile);
+  }
+
+  Batching* batching = options.batch ? new Batching() : nullptr;
+
+  /* OpenMP threads use the parameters read by the main thread */
+  shared_ptr<const FheContext> context = FheContext::current();
+
+  #pragma omp parallel num_threads(options.nrThreads)
+  {
+    FheContext::Scope scope(context);
+
+    #pragma omp for
+    for (unsigned int i = 0; i < options.OutputFilesMessages.size(); ++i) {
+      const string& out_fn = options.OutputFilesMessages[i].first;
+      const vector<unsigned int>& msgs = options.OutputFilesMessages[i].second;
+
+      #pragma omp critical
+      if (options.verbose) {
+        cout << "Encrypting message [";
+        for (unsigned int i = 0; i < msgs.size(); ++i) {
+          cout << msgs[i];
+          if (i < msgs.size()-1)
+            cout << " ";
+        }
+        cout << "] into file " << out_fn << endl;
       }
-      cout << "] into file " << out_fn << endl;
-    }
 
-    PolyRing pTxtPoly(msgs);
+      PolyRing pTxtPoly = batching ? batching->encode(msgs) : PolyRing(msgs);
 
-    if (options.clear) {
-      EncDec::EncryptPoly(pTxtPoly).write(out_fn);
-    } else {
-      EncDec::EncryptPoly(pTxtPoly, *keys.PublicKey).write(out_fn);
+      if (options.clear) {
+        EncDec::EncryptPoly(pTxtPoly).write(out_fn);
+      } else if (keys.SecretKey != NULL) {
+        EncDec::EncryptPoly(pTxtPoly, *keys.SecretKey).write(out_fn);
+      } else {
+        EncDec::EncryptPoly(pTxtPoly, *keys.PublicKey).write(out_fn);
+      }
     }
   }
 
+  delete batching;
+
   return 0;
 }
 
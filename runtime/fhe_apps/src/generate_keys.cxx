@@ -36,6 +36,9 @@ struct Options {
   string FheParamsFile;
   string KeyFilePrefix;
   bool strOutput;
+  bool galois;
+  bool seeded;
+  bool rnsKeys;
 };
 
 Options parseArgs(int argc, char** argv) {
@@ -47,6 +50,9 @@ Options parseArgs(int argc, char** argv) {
       ("fhe-params", po::value<string>(&options.FheParamsFile)->default_value("fhe_params.xml"), "FHE parameters file")
       ("key-file-prefix", po::value<string>(&options.KeyFilePrefix)->default_value("fhe_key"), "Prefix for key files")
       ("strout", po::bool_switch(&options.strOutput)->default_value(false), "Write keys in string format also")
+      ("galois", po::bool_switch(&options.galois)->default_value(false), "Generate Galois keys for slot rotations also")
+      ("seeded", po::bool_switch(&options.seeded)->default_value(false), "Store seeds instead of uniform key polynomials (about half size key files)")
+      ("rns-keys", po::bool_switch(&options.rnsKeys)->default_value(false), "Write evaluation and Galois keys in RNS form, evaluation keys are used in place from memory-mapped files by evaluators, Galois keys are copied from their file")
       ("help,h", "produce help message")
   ;
 
@@ -84,11 +90,21 @@ int main(int argc, char** argv) {
 
   FheParams::readXml(options.FheParamsFile.c_str());
 
-  KeyGen keygen;
+  if (options.galois and not FheParams::get().IsPowerOfTwoCyclotomic) {
+    cerr << "ERROR: Galois keys need a power of two cyclotomic polynomial" << endl;
+    exit(-1);
+  }
+
+  if (options.rnsKeys and FheParams::get().RnsQ == nullptr) {
+    cerr << "ERROR: RNS keys need RNS parameters" << endl;
+    exit(-1);
+  }
+
+  KeyGen keygen(options.seeded);
 
-  keygen.generateKeys();
+  keygen.generateKeys(options.galois);
 
-  keygen.writeKeys(options.KeyFilePrefix);
+  keygen.writeKeys(options.KeyFilePrefix, true, options.rnsKeys);
   if (options.strOutput) {
     keygen.writeKeys(options.KeyFilePrefix + "_str", false);
   }
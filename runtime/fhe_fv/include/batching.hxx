@@ -0,0 +1,106 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file batching.hxx
+ *  @brief CRT plaintext slot batching
+ */
+
+#ifndef __BATCHING_HXX__
+#define __BATCHING_HXX__
+
+#include "ntt.hxx"
+#include "polyring.hxx"
+
+#include <vector>
+
+/** @brief Plaintext slot batching (SIMD packing) class.
+ *
+ *  When the plaintext modulus \c t is a prime congruent to 1 modulo
+ *    \c{2.D} and the polynomial ring is a power of two cyclotomic one,
+ *    \c{X^D+1} splits in \c D distinct linear factors modulo \c t and,
+ *    by the CRT, a plaintext polynomial is equivalent to \c D independent
+ *    integers modulo \c t (slots): its evaluations in the roots of
+ *    \c{X^D+1}. Ciphertext additions and multiplications act slot-wise,
+ *    hence a circuit is evaluated on \c D data items at once.
+ *
+ *  Encoding is an inverse negacyclic NTT modulo \c t and decoding a
+ *    forward one. Constant polynomials have the same value in all slots.
+ *
+ *  Slots form two rows of \c{D/2} slots: slot \c i of the first row is
+ *    the evaluation in \c{psi^(3^i)} and of the second one in
+ *    \c{psi^(-3^i)}, with \c psi a primitive \c{2.D}-th root of unity.
+ *    Galois automorphism \c{X -> X^(3^r)} then rotates both rows to the
+ *    left by \c r slots, and \c{X -> X^(2.D-1)} swaps the rows.
+ */
+class Batching {
+  private:
+    /** @brief Negacyclic NTT modulo \c t
+     */
+    Ntt ntt;
+
+    /** @brief NTT domain index of each slot
+     */
+    std::vector<unsigned int> slotIndex;
+
+  public:
+    /** @brief Return true if current FHE parameters allow batching
+     */
+    static bool isAvailable();
+
+    /** @brief Precompute encoding tables for current FHE parameters
+     *
+     *  @remarks Batching must be available, see @c isAvailable
+     */
+    Batching();
+
+    /** @brief Galois element rotating slot rows by \c steps
+     *
+     *  @param steps rotation amount, to the left if positive
+     *  @return \c{3^steps mod 2.D}
+     */
+    static unsigned int galoisElement(const int steps);
+
+    /** @brief Galois element swapping slot rows, \c{2.D-1}
+     */
+    static unsigned int galoisElementRows();
+
+    /** @brief Return the number of plaintext slots
+     */
+    unsigned int slots() const {
+      return ntt.length();
+    }
+
+    /** @brief Encode integers into plaintext slots
+     *
+     *  @param values slot values, reduced modulo \c t, at most @c slots
+     *    of them, missing ones are 0
+     *  @return plaintext polynomial
+     */
+    PolyRing encode(const std::vector<unsigned int>& values) const;
+
+    /** @brief Decode plaintext slots
+     *
+     *  @param poly plaintext polynomial, coefficients modulo \c t
+     *  @return the @c slots slot values, in \c{[0;t)}
+     */
+    std::vector<unsigned int> decode(const PolyRing& poly) const;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file checksum.hxx
+ *  @brief Non-cryptographic hash for file checksums and fingerprints
+ */
+
+#ifndef __CHECKSUM_HXX__
+#define __CHECKSUM_HXX__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief 64-bit FNV-1a hash
+ *
+ *  Detects accidental corruption only, it offers no protection against
+ *    deliberate modifications.
+ */
+class Checksum {
+  public:
+    /** @brief Initial hash value (FNV offset basis)
+     */
+    static const uint64_t INIT = UINT64_C(0xcbf29ce484222325);
+
+    /** @brief Update hash \c h with \c len bytes of \c data
+     */
+    static uint64_t update(const void* const data, const size_t len,
+                           uint64_t h = INIT) {
+      const unsigned char* const p = (const unsigned char*)data;
+      for (size_t i = 0; i < len; ++i) {
+        h = (h ^ p[i]) * UINT64_C(0x100000001b3);
+      }
+      return h;
+    }
+};
+
+#endif
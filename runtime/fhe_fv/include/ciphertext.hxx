@@ -25,19 +25,201 @@
 #ifndef __CIPHERTEXT_HXX__
 #define __CIPHERTEXT_HXX__
 
+#include "fhe_context.hxx"
 #include "keys_share.hxx"
+#include "mapped_file.hxx"
 #include "polyring.hxx"
+#include "prg.hxx"
+#include "rns_poly.hxx"
 
 #include <assert.h>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <flint/fmpz.h>
 
 class CipherText {
+public:
+    /** @brief Modulus of polynomials derived from a seed, see @c setSeed
+     */
+    enum class SeedModulus {
+      None = 0,
+      Q    = 1,
+      PQ   = 2
+    };
+
 private:
     bool polysAllocated;
     std::vector<PolyRing*> dataPoly;
 
+    /** @brief RNS base of ciphertext polynomials, \c nullptr when
+     *    ciphertext polynomials are \c PolyRing objects
+     */
+    const RnsBase* rnsBase;
+
+    /** @brief Ciphertext polynomials in RNS representation, views on
+     *    \c rnsData
+     */
+    mutable std::vector<RnsPoly> dataRns;
+
+    /** @brief Residues of all ciphertext polynomials in RNS
+     *    representation, polynomial after polynomial, from @c MemPool
+     *    or inside \c mapping
+     */
+    mp_limb_t* rnsData;
+
+    /** @brief Size of \c rnsData in words, 0 when it is not from
+     *    @c MemPool
+     */
+    size_t rnsDataSize;
+
+    /** @brief File mapping holding \c rnsData when ciphertext residues
+     *    are used in place from a file (see @c read), \c nullptr
+     *    otherwise
+     */
+    std::shared_ptr<const MappedFile> mapping;
+
+    /** @brief FHE context of the ciphertext, the one bound to the thread
+     *    which built it (or prepared it to receive a result)
+     *
+     *  Ciphertexts keep their context alive, binary operations assert
+     *    that their operands are in the context of the calling thread.
+     */
+    std::shared_ptr<const FheContext> context;
+
+    /** @brief Assert that \c ct is in the context bound to the calling
+     *    thread
+     */
+    static void checkContext(const CipherText& ct) {
+      assert(ct.context == FheContext::current());
+    }
+
+    /** @brief Allocate \c rnsData for \c count polynomials in RNS base
+     *    \c base and append zero polynomial views on it
+     *
+     *  @remarks Ciphertext must not have RNS polynomials
+     */
+    void allocRns(const RnsBase& base, const unsigned int count, const bool ntt);
+
+    /** @brief Release RNS polynomials and their buffer
+     */
+    void releaseRns();
+
+    /** @brief Release \c rnsData, to @c MemPool or by dropping
+     *    \c mapping
+     */
+    void releaseRnsData();
+
+    /** @brief Copy residues used in place from \c mapping to a buffer
+     *    from @c MemPool, before they are modified
+     *
+     *  Mapped pages are read-only, every operation modifying RNS
+     *    residues in place calls it first.
+     */
+    void ownRns();
+
+    /** @brief Prepare ciphertext to receive a result
+     *
+     *  Ciphertext is resized to \c newSize polynomials in RNS base
+     *    \c base, or \c PolyRing objects when \c base is \c nullptr,
+     *    at modulus level \c newLevel. Buffers are reused when possible,
+     *    polynomial values are unspecified.
+     */
+    void reset(const RnsBase* const base, const unsigned int newSize,
+               const unsigned int newLevel);
+
+    /** @brief Modulus chain level, see @c FheParams::ModChain
+     *
+     *  Polynomials are modulo \c{q_l}, RNS ones are in base
+     *    \c{FheParams::ModChain[modLevel].Q}. Only ciphertexts in RNS
+     *    representation can be operated on below level 0, \c PolyRing
+     *    ones are meant for reading, writing and decryption.
+     */
+    unsigned int modLevel;
+
+    /** @brief Lazy reduction bound of \c PolyRing polynomials
+     *
+     *  Coefficients belong to \c{(-bound.q;bound.q)}, 1 when reduced.
+     *    Additions do not reduce coefficients until this bound exceeds
+     *    \c MaxLazyBound, multiplications and writes reduce them first.
+     *    RNS polynomials track their own bound, see @c RnsPoly.
+     */
+    unsigned int bound;
+
+    /** @brief Seed of the polynomials at odd positions, see @c setSeed
+     */
+    Prg::Seed seed;
+
+    /** @brief Modulus of seeded polynomials, \c SeedModulus::None when
+     *    ciphertext has no seed
+     */
+    SeedModulus seedModulus;
+
+    /** @brief Return true if ciphertext has a seed and its polynomials at
+     *    odd positions are still the ones derived from it
+     */
+    bool seedValid() const;
+
+    /** @brief Read a compact binary ciphertext, after its magic
+     */
+    void readCompact(FILE* const stream);
+
+    /** @brief Check a compact container header and return the container
+     *    size in bytes
+     */
+    static size_t compactSize(const unsigned char* const header);
+
+    /** @brief Load ciphertext from a whole compact container
+     *
+     *  RNS residues are used in place when \c file holds \c buff,
+     *    copied otherwise.
+     *
+     *  @param buff container, see @c compactSize
+     *  @param file file mapping holding \c buff, or \c nullptr
+     */
+    void loadCompact(const unsigned char* const buff,
+                     const std::shared_ptr<const MappedFile>& file);
+
+    /** @brief Read a ciphertext in the legacy \c fmpz format
+     */
+    void readLegacy(FILE* const stream, const bool binary);
+
+    /** @brief Write a compact binary ciphertext
+     */
+    void writeCompact(FILE* const stream) const;
+
+    /** @brief Write a ciphertext in the legacy \c fmpz format
+     */
+    void writeLegacy(FILE* const stream, const bool binary) const;
+
+    /** @brief Maximal lazy reduction bound of \c PolyRing polynomials
+     */
+    static const unsigned int MaxLazyBound = 64;
+
+    /** @brief Bring two ciphertexts to the same representation
+     *
+     *  When one of the ciphertexts is in RNS representation and \c ct1 is
+     *    not, \c ct1 is converted in-place to RNS base \c base. When
+     *    \c ct2 is not, a converted copy of it is returned and should be
+     *    deleted by the caller.
+     *
+     *  @return \c ct2 or its converted copy
+     */
+    static const CipherText* matchRns(CipherText& ct1, const CipherText& ct2,
+                                      const RnsBase& base);
+
+    /** @brief Bring two ciphertexts to RNS representation and to the
+     *    same modulus level
+     *
+     *  Ciphertext \c ct1 is converted in-place, and switched down if
+     *    its level is lower. When \c ct2 needs a conversion or a switch,
+     *    a copy of it is returned and should be deleted by the caller.
+     *
+     *  @return \c ct2 or its converted copy
+     */
+    static const CipherText* matchLevel(CipherText& ct1, const CipherText& ct2);
+
 protected:
 
   /** @brief In-place multiply a ciphertext with a polynomial.
@@ -50,21 +232,157 @@ protected:
    */
   static void multiply_by_poly(CipherText& ct1, const PolyRing& p2);
 
+  /** @brief Multiply two ciphertexts in RNS representation.
+   *
+   *  Result is stored in \c res, which can alias \c ct1 (but not \c ct2).
+   *    Ciphertexts are extended to RNS base \c FheParams::RnsQB where the
+   *    tensor product is computed exactly. It is then scaled by \c{t/q}
+   *    into base \c FheParams::RnsB and converted back to base q, using
+   *    word-level arithmetic only. The result is in coefficient form.
+   *    Products of two size-2 ciphertexts use Karatsuba (3 products).
+   */
+  static void multiply_rns(CipherText& res, const CipherText &ct1,
+                           const CipherText& ct2);
+
+  /** @brief Relinearize a ciphertext in RNS representation.
+   */
+  static void relinearize_rns(CipherText& ctr, const CipherText& EvalKey);
+
+  /** @brief Relinearize a ciphertext with a version 1 evaluation key.
+   *
+   *  Polynomial \c c2 is decomposed in base \c{w = 2^RELIN_BASE_LOG2},
+   *    \c{c2 = sum d_i.w^i}, and \c{(sum d_i.b_i, sum d_i.a_i)} is added
+   *    to \c{(c0, c1)}.
+   */
+  static void relinearize_v1(CipherText& ctr, const CipherText& EvalKey);
+
+  /** @brief Relinearize a ciphertext in RNS representation with a
+   *    version 1 evaluation key.
+   *
+   *  Polynomial \c c2 is first decomposed prime-wise,
+   *    \c{c2 = sum [c2.(q/q_k)^-1]_{q_k}.(q/q_k) mod q}, then each
+   *    residue in base \c{2^RELIN_BASE_LOG2}. Digits are small, hence
+   *    they have the same residues in each prime.
+   */
+  static void relinearize_rns_v1(CipherText& ctr, const CipherText& EvalKey);
+
+  /** @brief Decompose a polynomial in base \c{w = 2^RELIN_BASE_LOG2}
+   *
+   *  @param digits \c FheParams::RELIN_DIGITS polynomials \c d_i with
+   *    \c{c = sum d_i.w^i}
+   *  @param c polynomial with coefficients in \c{[0;q)}
+   */
+  static void decompose(std::vector<PolyRing>& digits, const PolyRing& c);
+
+  /** @brief Decompose a polynomial in RNS representation
+   *
+   *  Polynomial \c c is decomposed prime-wise,
+   *    \c{c = sum [c.(q/q_k)^-1]_{q_k}.(q/q_k) mod q}, then each residue
+   *    in base \c{2^RELIN_BASE_LOG2}. Digits are small, hence they have
+   *    the same residues in each prime. They are in NTT form when base
+   *    \c FheParams::RnsQ has NTT tables.
+   */
+  static void decompose_rns(std::vector<RnsPoly>& digits, const RnsPoly& c);
+
+  /** @brief Add \c{(sum d_i.k_{2i}, sum d_i.k_{2i+1})} to the first two
+   *    polynomials of \c ctr, with \c d_i the digits and \c k_j the
+   *    polynomials of key switching key \c key. Result is not reduced.
+   */
+  static void switch_key(CipherText& ctr, const std::vector<PolyRing>& digits,
+                         const CipherText& key);
+
+  /** @brief Key switching in RNS representation, see @c switch_key
+   *
+   *  @param key key switching key in RNS base \c FheParams::RnsQ
+   */
+  static void switch_key_rns(CipherText& ctr, const std::vector<RnsPoly>& digits,
+                             const CipherText& key);
+
+  /** @brief Apply Galois automorphism \c k to ciphertext \c ct given
+   *    the decomposition of its \c c1 polynomial
+   *
+   *  Computes \c{res = (sigma(c0), 0)} plus the key switching of the
+   *    digits \c{sigma(d_i)}. Digits are not modified, hence they can be
+   *    shared by several automorphisms (hoisting).
+   *
+   *  @param res result ciphertext, must not alias \c ct
+   */
+  static void galois_switch(CipherText& res, const CipherText& ct,
+                            const unsigned int k,
+                            const std::vector<PolyRing>& digits,
+                            const CipherText& GaloisKey);
+
+  /** @brief Apply Galois automorphism in RNS representation, see
+   *    @c galois_switch
+   */
+  static void galois_switch_rns(CipherText& res, const CipherText& ct,
+                                const unsigned int k,
+                                const std::vector<RnsPoly>& digits,
+                                const CipherText& GaloisKey);
 
 public:
 
   /** @brief Relinearize ciphertext.
    *
    *  This function relinearizes in-place a degree two ciphertext \c ctr.
+   *    The relinearization version, and hence the evaluation key format,
+   *    is given by \c FheParams::RELIN_VERSION.
    *
    *  @param ctr input/output ciphertext.
    *  @param EvalKey Evaluation key.
    */
   static void relinearize(CipherText& ctr, const CipherText& EvalKey);
 
+  /** @brief Apply a Galois automorphism to a ciphertext.
+   *
+   *  This function transforms in-place a ciphertext of message \c{m(X)}
+   *    into a ciphertext of \c{m(X^k)} under the same secret key. The
+   *    automorphism is applied to each polynomial, giving a ciphertext
+   *    under key \c{s(X^k)}, which is switched back to \c s with
+   *    \c GaloisKey. Only power of two cyclotomic rings are supported.
+   *
+   *  @param ct size 2 ciphertext to transform
+   *  @param k Galois element, odd and smaller than \c{2 . FheParams::D}
+   *  @param GaloisKey key switching key from \c{s(X^k)} to \c s, see
+   *    @c KeyGen
+   */
+  static void apply_galois(CipherText& ct, const unsigned int k,
+                           const CipherText& GaloisKey);
+
+  /** @brief Rotate plaintext slots of a ciphertext.
+   *
+   *  Both rows of slots (see @c Batching) are rotated to the left by
+   *    \c steps, to the right if negative. When \c GaloisKeys has no key
+   *    for this rotation, power of two rotations are composed, one key
+   *    switch for each bit set in \c steps.
+   *
+   *  @param ct size 2 ciphertext to rotate
+   *  @param steps rotation amount
+   *  @param GaloisKeys Galois keys indexed by Galois element
+   */
+  static void rotate(CipherText& ct, const int steps,
+                     const std::map<unsigned int, CipherText*>& GaloisKeys);
+
+  /** @brief Rotate a ciphertext by several amounts at once.
+   *
+   *  Polynomial \c c1 of \c ct is decomposed only once, the
+   *    decomposition is shared by all rotations having a key in
+   *    \c GaloisKeys (hoisting). Other rotations are composed, see
+   *    @c rotate.
+   *
+   *  @param res rotated ciphertexts, one for each amount of \c steps
+   *  @param ct size 2 ciphertext to rotate
+   *  @param steps rotation amounts
+   *  @param GaloisKeys Galois keys indexed by Galois element
+   */
+  static void rotate_hoisted(std::vector<CipherText>& res, const CipherText& ct,
+                             const std::vector<int>& steps,
+                             const std::map<unsigned int, CipherText*>& GaloisKeys);
+
   /** @brief In-place apply PolyRing::modulo operation to each ciphertext polynomial 
    *
    *  Normalize each polynomial of ciphertext \c ctr with modulo \c q .
+   *    RNS polynomials have their residues reduced.
    *
    * @param ctr ciphertext to normalize.
    * @param q the modulo.
@@ -92,17 +410,130 @@ public:
   /** @brief Access ciphertext polynomials
    */    
   PolyRing& operator[](const unsigned int idx) const {
+    assert(not isRns());
     assert(idx < size());
     return *dataPoly[idx];
   };
 
+  /** @brief Access ciphertext polynomials in RNS representation
+   */
+  RnsPoly& rns(const unsigned int idx) const {
+    assert(isRns());
+    assert(idx < size());
+    return dataRns[idx];
+  };
+
+  /** @brief Return true if ciphertext is in RNS representation
+   */
+  bool isRns() const {
+    return rnsBase != nullptr;
+  }
+
+  /** @brief Return true if ciphertext polynomials are in NTT form
+   */
+  bool isNtt() const {
+    return isRns() and size() > 0 and dataRns[0].isNtt();
+  }
+
   /** @brief Return number of polynomials in the ciphertext
    */    
   unsigned int size() const {
-    return dataPoly.size();
+    return isRns() ? dataRns.size() : dataPoly.size();
+  }
+
+  /** @brief In-place convert ciphertext polynomials to RNS representation
+   *
+   *  @param ct ciphertext to convert
+   *  @param base RNS base, usually \c FheParams::RnsQ for ciphertexts and
+   *    \c FheParams::RnsPQ for the evaluation key
+   */
+  static void toRns(CipherText& ct, const RnsBase& base);
+
+  /** @brief In-place convert ciphertext polynomials to the RNS base of
+   *    its modulus level
+   */
+  static void toRns(CipherText& ct);
+
+  /** @brief Switch ciphertext to another modulus level.
+   *
+   *  Going down the chain, polynomials are scaled by \c{q_level/q_l} and
+   *    rounded one prime at a time, which keeps the noise to modulus
+   *    ratio and makes the ciphertext smaller and faster to operate on.
+   *    Going up, polynomials are multiplied by \c{q_level/q_l}, which is
+   *    exact, e.g. to decrypt with the level 0 modulus.
+   *
+   *  Switching down needs the RNS representation, \c ct is converted
+   *    first. The NTT form is kept.
+   *
+   *  @param ct ciphertext to switch
+   *  @param level target level, smaller than
+   *    \c{FheParams::ModChain.size()}
+   */
+  static void mod_switch(CipherText& ct, const unsigned int level);
+
+  /** @brief Attach the seed from which uniform polynomials were derived
+   *
+   *  Ciphertext polynomials at odd positions, i.e. \c a_i of pairs
+   *    \c{(b_i, a_i)} (public key, fresh secret key encryptions and
+   *    evaluation keys), must have been obtained with @c expandSeed from
+   *    \c seed, with stream \c i. Written ciphertexts then store the
+   *    seed instead of these polynomials, which roughly halves their
+   *    size, and reading expands them back.
+   *
+   *  The seed is not copied with the ciphertext. Before writing, seeded
+   *    polynomials are checked against the seed and written in full if
+   *    they changed.
+   *
+   *  @param seed_p seed of the uniform polynomials
+   *  @param modulus modulus of the uniform polynomials, \c q (at the
+   *    ciphertext level) or \c{p.q}
+   */
+  void setSeed(const Prg::Seed& seed_p, const SeedModulus modulus);
+
+  /** @brief Derive a uniform polynomial from a seed
+   *
+   *  Coefficients belong to \c{[0;m)} with \c m the modulus given by
+   *    \c modulus and \c level, see @c RandPolynom::sampleUniform.
+   *
+   *  @param poly output polynomial
+   *  @param seed_p seed
+   *  @param stream index of the polynomial derived from \c seed_p
+   *  @param modulus modulus, \c q or \c{p.q}
+   *  @param level modulus level of \c q
+   */
+  static void expandSeed(PolyRing& poly, const Prg::Seed& seed_p,
+                         const unsigned int stream, const SeedModulus modulus,
+                         const unsigned int level = 0);
+
+  /** @brief Return ciphertext modulus level
+   */
+  unsigned int level() const {
+    return modLevel;
   }
 
+  /** @brief In-place convert ciphertext polynomials from RNS
+   *    representation to \c PolyRing objects
+   */
+  static void toPolyRing(CipherText& ct);
+
+  /** @brief In-place transform ciphertext polynomials to NTT form
+   *
+   *  Does nothing if ciphertext is not in RNS representation or if its
+   *    RNS base has no NTT tables (i.e. not a power of two cyclotomic).
+   *    Additions and multiplications keep ciphertexts in NTT form,
+   *    the inverse transform is only done where roundings are needed.
+   */
+  static void toNtt(CipherText& ct);
+
+  /** @brief In-place transform ciphertext polynomials back to
+   *    coefficient form
+   */
+  static void fromNtt(CipherText& ct);
+
   /** @brief Resize the number of polynomials in the ciphertext
+   *
+   *  Polynomials in RNS representation are reallocated only when their
+   *    buffer is too small.
    */    
   void resize(const int newSize);
     
@@ -111,8 +542,22 @@ public:
   CipherText(unsigned int p_nrPolys = 2);
   
   /** @brief Copy-constructs a CipherText object.
+   *
+   *  Polynomials in RNS representation are copied in a single buffer.
    */
   CipherText(const CipherText &ct);
+
+  /** @brief Move-constructs a CipherText object, polynomials are not copied
+   *
+   *  Ciphertext \c ct is left empty.
+   */
+  CipherText(CipherText&& ct) noexcept;
+
+  /** @brief Move-assign a CipherText object, polynomials are not copied
+   *
+   *  Ciphertext \c ct is left empty.
+   */
+  CipherText& operator=(CipherText&& ct) noexcept;
   
   /** @brief Constructs a CipherText object from a polynomial copy.
    */
@@ -135,7 +580,8 @@ public:
   /** @brief In-place add two ciphertexts.
    *
    *  Add ciphertext \c ct2 with ciphertext \c ct1 and
-   *    store the obtained result in \c ct1.
+   *    store the obtained result in \c ct1. Coefficients are reduced
+   *    lazily, see @c bound.
    *
      *  @param ct1 ciphertext to add to.
      *  @param ct2 ciphertext to add.
@@ -145,13 +591,28 @@ public:
   /** @brief In-place subtract two ciphertexts.
    *
    *  Substract ciphertext \c ct2 from ciphertext \c ct1 and
-   *    store the obtained result in \c ct1.
+   *    store the obtained result in \c ct1. Coefficients are reduced
+   *    lazily, see @c bound.
    *
      *  @param ct1 ciphertext to subtract from.
      *  @param ct2 ciphertext to subtract.
    */
   static void sub(CipherText &ct1, const CipherText& ct2);
 
+  /** @brief Add two ciphertexts.
+   *
+   *  This function computes \c{res = ct1 + ct2} without copying \c ct1
+   *    first. Ciphertext \c res can alias \c ct1 or \c ct2, otherwise
+   *    its buffers are reused when possible.
+   */
+  static void add(CipherText &res, const CipherText& ct1, const CipherText& ct2);
+
+  /** @brief Subtract two ciphertexts.
+   *
+   *  This function computes \c{res = ct1 - ct2}, see @c add.
+   */
+  static void sub(CipherText &res, const CipherText& ct1, const CipherText& ct2);
+
   /** @brief In-place multiply two ciphertexts.
    *
    *  This function multiplies ciphertext \c ct2 with ciphertext
@@ -163,30 +624,85 @@ public:
    */
   static void multiply(CipherText &ct1, const CipherText& ct2, const CipherText& EvalKey);
 
+  /** @brief Multiply two ciphertexts.
+   *
+   *  This function computes \c{res = ct1 * ct2} and relinearizes the
+   *    result. Ciphertext \c res can alias \c ct1 or \c ct2, otherwise
+   *    its buffers are reused when possible. In RNS representation
+   *    \c ct1 is not copied.
+   *
+   *  @param res result ciphertext.
+   *  @param ct1 ciphertext to multiply.
+   *  @param ct2 ciphertext to multiply.
+   *  @param EvalKey Evaluation key used for relinearization.
+   */
+  static void multiply(CipherText &res, const CipherText& ct1,
+                       const CipherText& ct2, const CipherText& EvalKey);
+
   /** @brief In-place multiply two ciphertexts without relinearizing the result.
    *
    *  This function multiplies ciphertext \c ct2 with ciphertext
    *    \c ct1 and store the obtained result in \c ct1. Ciphertext
    *    ct1 is not relinearized.
    *
+   *  Two size-2 ciphertexts, the common case, are multiplied with the
+   *    Karatsuba trick: \c{c0.d1 + c1.d0} is computed as
+   *    \c{(c0+c1).(d0+d1) - c0.d0 - c1.d1}, 3 polynomial products
+   *    instead of 4.
+   *
    *  @param ct1 ciphertext to multiply to.
    *  @param ct2 ciphertext to multiply.
    */
   static void multiply(CipherText &ct1, const CipherText& ct2);
 
+  /** @brief Append a checksum to compact binary ciphertexts (default)
+   */
+  static bool WriteChecksum;
+
   /** @brief Read ciphertext from an input stream
+   *
+   *  See @c write for the format. Binary ciphertexts in the legacy
+   *    format are read too, from seekable streams.
    *
    *  @param in_stream FILE pointer from which to read
    */
   void read(FILE* const in_stream, const bool binary = true);
 
   /** @brief Read ciphertext from a file
+   *
+   *  Binary files are memory-mapped. Compact containers are parsed from
+   *    the mapping and RNS residues (see @c writeRns) are used in place:
+   *    the ciphertext references the read-only mapped pages, which are
+   *    shared by all processes reading the file, and copies them to its
+   *    own buffer before it is first modified.
    *
    *  @param inFileName name of the file from which to read
    */
   void read(const std::string& inFileName, const bool binary = true);
   
   /** @brief Write ciphertext to an output stream
+   *
+   *  Ciphertexts in RNS representation are written as \c PolyRing
+   *    objects. Binary ciphertexts use a compact container, built in a
+   *    single buffer and written at once. It has a 32-byte header of
+   *    little-endian fields:
+   *    - magic \c "CGCT", format version (1), flags (1: checksum,
+   *      2: coefficient sign bits), @c SeedModulus, a zero byte
+   *    - 64-bit @c FheParams::Fingerprint
+   *    - 32-bit modulus level, number of polynomials, number of
+   *      coefficients per polynomial and coefficient bit-size \c b
+   *
+   *    It is followed by the 32-byte seed, if any, and by the written
+   *    polynomials, packed with @c PolyRing::pack at \c b bits (at
+   *    most \c{ceil(log2 q_l)}) per coefficient. Seeded polynomials
+   *    are not written. A 64-bit @c Checksum of everything before it
+   *    ends the container when @c WriteChecksum is set.
+   *
+   *  String ciphertexts use the legacy format. The number of polynomials
+   *    comes first. Ciphertexts below modulus level 0 or with a seed
+   *    write it negated, followed by their level (polynomials are then
+   *    modulo \c{q_l}), the @c SeedModulus and, if any, the seed as a
+   *    256-bit integer. Polynomials follow as \c fmpz numbers.
    *
    *  @param out_stream FILE pointer to which to write
    */
@@ -197,6 +713,25 @@ public:
    *  @param outFileName file name to which to write
    */
   void write(const std::string& outFileName, const bool binary = true) const;
+
+  /** @brief Write a RNS ciphertext as its residues
+   *
+   *  Ciphertext must be in RNS base \c{FheParams::ModChain[l].Q} or
+   *    \c{FheParams::ModChain[l].PQ} of its modulus level \c l. The
+   *    compact container of @c write is used, with flags 4 (RNS residues)
+   *    and 8 (NTT form) and the base (1: Q, 2: PQ) in its zero byte. Reduced
+   *    residues follow the header as native 64-bit words, as they are
+   *    in memory, so that @c read can use them in place.
+   *
+   *  @param out_stream FILE pointer to which to write
+   */
+  void writeRns(FILE* const out_stream) const;
+
+  /** @brief Write a RNS ciphertext as its residues to a file
+   *
+   *  @param outFileName file name to which to write
+   */
+  void writeRns(const std::string& outFileName) const;
 };
 
 #endif
@@ -43,6 +43,9 @@ public:
   /**
    * @brief Decrypts a ciphertext together with its noise (as polynomial)
    *
+   * Ciphertexts below modulus level 0 are lifted back to modulus q first,
+   *  the noise is thus relative to q.
+   *
    * @param cTxt ciphertext object to decrypt
    * @param secretKey secret key
    * @param pNoise output noise polynomial
@@ -61,6 +64,21 @@ public:
    */
   static CipherText EncryptPoly(const PolyRing& pTxt, const CipherText& publicKey);
 
+  /**
+   * @brief Encrypts a polynomial ring element with the secret key
+   * @details The ciphertext is \c{(-(a.s + e) + Delta.m, a)} with \c a
+   *    derived from a fresh seed, which is attached to the ciphertext
+   *    (see @c CipherText::setSeed): written ciphertexts store the seed
+   *    instead of \c a and are about half the size of public key
+   *    encryptions.
+   *
+   * @param pTxt polynomial ring element to encrypt
+   * @param secretKey secret key
+   *
+   * @return a ciphertext object with encrypted polynomial
+   */
+  static CipherText EncryptPoly(const PolyRing& pTxt, const PolyRing& secretKey);
+
   /**
    * @brief Builds a "plain" ciphertext object
    * @details Builds a "plain" ciphertext object used in combined computations
@@ -0,0 +1,108 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file fhe_context.hxx
+ *  @brief FHE parameter sets shared by the objects and threads using them
+ */
+
+#ifndef __FHE_CONTEXT_HXX__
+#define __FHE_CONTEXT_HXX__
+
+#include "fhe_params.hxx"
+
+#include <memory>
+#include <string>
+
+/** @brief Reference-counted FHE parameter set
+ *
+ *  A context owns the parameters, RNS bases and modulus chain of a
+ *    parameter set. It is immutable and released with its last reference.
+ *
+ *  @c FheParams::get returns the parameters of the context bound to the
+ *    calling thread, hence every thread must be bound to a context before
+ *    using FHE objects. A process can hold several contexts at once, e.g.
+ *    an evaluation server running circuits compiled for different
+ *    parameter sets concurrently, each of its threads being bound to the
+ *    context of the circuit it evaluates. Objects built in a context
+ *    (ciphertexts, polynomials, keys) must only be used by threads bound
+ *    to it, ciphertexts check it in binary operations.
+ */
+class FheContext {
+  private:
+    /** @brief Context bound to the calling thread
+     */
+    static thread_local std::shared_ptr<const FheContext> bound;
+
+    /** @brief Parameters owned by the context
+     */
+    FheParams params;
+
+    /** @brief Build a context with default parameters
+     */
+    FheContext() {}
+
+  public:
+    FheContext(const FheContext&) = delete;
+    FheContext& operator=(const FheContext&) = delete;
+
+    /** @brief Create a context from a XML parameters file
+     *
+     *  The calling thread binding is unchanged.
+     */
+    static std::shared_ptr<const FheContext> create(const std::string& fileName);
+
+    /** @brief Return the context bound to the calling thread, \c nullptr
+     *    if none
+     */
+    static const std::shared_ptr<const FheContext>& current() {
+      return bound;
+    }
+
+    /** @brief Bind \c context to the calling thread, \c nullptr unbinds
+     *    the current one
+     *
+     *  The thread holds a reference to its context until it is bound to
+     *    another one or exits.
+     */
+    static void bind(const std::shared_ptr<const FheContext>& context);
+
+    /** @brief Bind a context to the calling thread for the lifetime of
+     *    the object, the previous binding is restored on destruction
+     */
+    class Scope {
+      private:
+        std::shared_ptr<const FheContext> previous;
+
+      public:
+        Scope(const std::shared_ptr<const FheContext>& context):
+            previous(bound) {
+          bind(context);
+        }
+
+        ~Scope() {
+          bind(previous);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+#endif
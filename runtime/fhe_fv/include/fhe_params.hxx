@@ -25,105 +25,294 @@
 #ifndef __FHE_PARAMS_HXX__
 #define __FHE_PARAMS_HXX__
 
+#include "rns_base.hxx"
+#include "rns_conv.hxx"
+
 #include <flint/fmpz.h>
 #include <flint/fmpz_poly.h>
+#include <stdint.h>
+#include <vector>
+
+class FheContext;
 
+/** @brief FHE scheme parameters.
+ *
+ *  A parameter set is owned by a @c FheContext. Parameters of the
+ *    context bound to the calling thread are read with @c get, each
+ *    thread sees its own parameter set.
+ */
 class FheParams {
+  friend class FheContext;
+
   public:
+    /** @brief Return the parameters of the context bound to the calling
+     *    thread, default ones (no ring, no moduli) if none
+     */
+    static const FheParams& get() {
+      return *current;
+    }
+
     /** @brief Plaintext polynomial coefficient modulo
      */
-    static unsigned int T;
+    unsigned int T;
 
     /** @brief Ciphertext polynomial coefficient modulo, q
      */
-    static fmpz_t Q;
+    fmpz_t Q;
 
     /** @brief Ciphertext polynomial coefficient modulo bit-size, q
      */
-    static unsigned int Q_bitsize;
+    unsigned int Q_bitsize;
 
     /** @brief floor(Q/T)
      */
-    static fmpz_t Delta;
+    fmpz_t Delta;
 
     /** @brief Relinearization key (version 2) coefficient modulo factor, p
      */
-    static fmpz_t P;
+    fmpz_t P;
 
     /** @brief Relinearization key (version 2) coefficient modulo, p.q
      */
-    static fmpz_t PQ;
+    fmpz_t PQ;
 
     /** @brief Is power of two cyclotomic
      *
      *  Boolean flag for identifying power of two cyclotomic as  modulo of
      *    the quotient ring, i.e.  \Phi_{2^{n}} = x^{2^{n-1}} + 1
      */
-    static bool IsPowerOfTwoCyclotomic;
+    bool IsPowerOfTwoCyclotomic;
 
     /** @brief Ciphertext polynomial ring modulo cyclotomic polynomial
      */
-    static fmpz_poly_t PolyRingModulo;
+    fmpz_poly_t PolyRingModulo;
 
     /** @brief Precomputed powers inverse of modulo cyclotomic polynomial
      */
-    static fmpz_poly_powers_precomp_t PolyRingModuloInv;
+    fmpz_poly_powers_precomp_t PolyRingModuloInv;
 
     /** @brief Degree of ciphertext polynomial ring modulo cyclotomic polynomial
      */
-    static unsigned int D;
+    unsigned int D;
 
     /** @brief Gaussian noise distribution standard deviation sigma
      */
-    static fmpz_t SIGMA;
+    fmpz_t SIGMA;
 
     /** @brief Gaussian noise distribution bound B
      */
-    static fmpz_t B;
+    fmpz_t B;
 
     /** @brief Gaussian noise distribution standard deviation
      *    Relinearization version 2
      */
-    static fmpz_t SIGMA_K;
+    fmpz_t SIGMA_K;
 
     /** @brief Gaussian noise distribution bound B
      *    Relinearization version 2
      */
-    static fmpz_t B_K;
+    fmpz_t B_K;
 
     /** @brief Secret key hamming weight
      */
-    static unsigned int SK_H;
+    unsigned int SK_H;
+
+    /** @brief Relinearization version, 1 (digit decomposition) or
+     *    2 (modulus \c{p.q}, default)
+     */
+    unsigned int RELIN_VERSION;
+
+    /** @brief Relinearization version 1 decomposition base bit-size, w
+     *
+     *  Smaller bases give smaller relinearization noise but more
+     *    evaluation key components, i.e. bigger keys and more
+     *    polynomial products per relinearization. Galois keys always use
+     *    this decomposition, whatever the relinearization version.
+     */
+    unsigned int RELIN_BASE_LOG2;
+
+    /** @brief Relinearization version 1 number of digits per RNS prime
+     *
+     *  In RNS representation ciphertext polynomials are decomposed
+     *    prime-wise, \c{[c.(q/q_i)^-1]_{q_i}}, then each residue in base
+     *    \c{2^w}. Equal to \c RELIN_DIGITS otherwise.
+     */
+    unsigned int RELIN_PRIME_DIGITS;
+
+    /** @brief Relinearization version 1 number of digits, the evaluation
+     *    key has two polynomials per digit
+     */
+    unsigned int RELIN_DIGITS;
 
     /** @brief Polynomial coefficients R/W base
      */
-    static unsigned int POLY_RW_BASE;
+    unsigned int POLY_RW_BASE;
 
-    /** @brief Read FHE parameters from XML.
+    /** @brief Bit-size of RNS primes, RNS representation is disabled when 0
+     *
+     *  When RNS representation is enabled, moduli \c Q and \c P are
+     *    replaced by products of primes of at most this bit-size, congruent
+     *    to 1 modulo \c{2.D}, and such that the bit-sizes of \c Q and \c P
+     *    do not increase.
      */
-    static void readXml(const char* const fileName);
+    unsigned int RnsPrimeBitsize;
 
-    /** @brief Compute parameters, other than the read one
+    /** @brief RNS base of ciphertext modulo, q
+     */
+    RnsBase* RnsQ;
+
+    /** @brief RNS base of relinearization key modulo factor, p
+     */
+    RnsBase* RnsP;
+
+    /** @brief RNS base extension used for exact ciphertext tensoring, b
+     *
+     *  The product of primes \c b is bigger than \c{2.D.q}.
+     */
+    RnsBase* RnsB;
+
+    /** @brief RNS base of modulo q.b (primes of q come first)
+     */
+    RnsBase* RnsQB;
+
+    /** @brief RNS base of relinearization key modulo p.q
+     *    (primes of q come first)
+     */
+    RnsBase* RnsPQ;
+
+    /** @brief Centered base conversion from \c RnsQ to \c RnsB
+     */
+    RnsConv* RnsConvQB;
+
+    /** @brief Centered base conversion from \c RnsB to \c RnsQ
+     */
+    RnsConv* RnsConvBQ;
+
+    /** @brief Centered base conversion from \c RnsQ to \c RnsP
+     */
+    RnsConv* RnsConvQP;
+
+    /** @brief Ciphertext product scaling, \c{round(t/q.x)} from
+     *    \c RnsQB to \c RnsB
      */
-    static void computeParams();
+    RnsScale* RnsScaleT;
+
+    /** @brief Relinearization scaling, \c{round(x/p)} from \c RnsPQ
+     *    to \c RnsQ
+     */
+    RnsScale* RnsScaleP;
+
+    /** @brief Modulus switching level
+     *
+     *  Ciphertexts at level \c l are modulo \c{q_l}, the product of the
+     *    first \c{size(q) - l} primes of \c RnsQ. A level holds the
+     *    bases, conversions and scalings of ciphertext operations modulo
+     *    \c{q_l}, level 0 ones are \c RnsQ, \c RnsQB, etc.
+     */
+    struct ModLevel {
+      RnsBase* Q;
+      RnsBase* QB;
+      RnsBase* PQ;
+      RnsConv* ConvQB;
+      RnsConv* ConvBQ;
+      RnsConv* ConvQP;
+      RnsScale* ScaleT;
+      RnsScale* ScaleP;
+
+      /** @brief Modulus switching, \c{round(x.q_{l+1}/q_l)} from \c Q to
+       *    the base of the next level, \c nullptr at the last level
+       */
+      RnsScale* ScaleNext;
+    };
+
+    /** @brief Modulus chain, from modulus q (level 0) down to its first
+     *    RNS prime. Without RNS representation it has a single level
+     *    with null members.
+     */
+    std::vector<ModLevel> ModChain;
+
+    /** @brief Estimated noise growth of a ciphertext multiplication,
+     *    in bits
+     */
+    unsigned int MOD_SWITCH_MULT_BITS;
+
+    /** @brief Estimated bit-size of the noise of a ciphertext right after
+     *    a modulus switch, or of relinearization version 1 noise when
+     *    larger, plus a safety margin
+     */
+    unsigned int MOD_SWITCH_BASE_BITS;
+
+    /** @brief Hash of the parameters which define ciphertext
+     *    polynomials and their relinearization (ring, moduli, RNS prime
+     *    size, relinearization version and base), written in binary
+     *    ciphertext files to detect parameter mismatches
+     */
+    uint64_t Fingerprint;
+
+    /** @brief Return the highest (i.e. smallest modulus) level at which
+     *    a ciphertext can still go through \c depth multiplications
+     *
+     *  Modulus switching keeps the noise to modulus ratio, except for
+     *    a rounding error of about \c{MOD_SWITCH_BASE_BITS} bits, so a
+     *    level is suitable when \c{q_l} has at least
+     *    \c{log2(t) + MOD_SWITCH_BASE_BITS + depth.MOD_SWITCH_MULT_BITS}
+     *    bits.
+     */
+    static unsigned int modLevel(const unsigned int depth);
+
+    /** @brief Read FHE parameters from XML into a new context and bind
+     *    it to the calling thread, see @c FheContext::create
+     */
+    static void readXml(const char* const fileName);
 
     /** @brief Verify if polynomial is a power of two cyclotomic
      */
     static bool isPowerOfTwoCyclotomicPolynomial(fmpz_poly_t poly);
 
-  protected:
+  private:
+    /** @brief Parameters of the context bound to the calling thread
+     */
+    static thread_local const FheParams* current;
+
+    /** @brief Default parameters, seen by threads without context
+     */
+    static const FheParams Defaults;
+
+    /** @brief Set default parameter values
+     */
+    FheParams();
+
+    /** @brief Release parameters
+     */
+    ~FheParams();
+
+    FheParams(const FheParams&) = delete;
+    FheParams& operator=(const FheParams&) = delete;
 
-    /** @brief Hide constructor
+    /** @brief Parse FHE parameters from XML and compute the other ones
      */
-    FheParams() {}
-  
+    void parseXml(const char* const fileName);
+
+    /** @brief Compute parameters, other than the read one
+     */
+    void computeParams();
+
+    /** @brief Compute RNS bases and replace \c Q and \c P moduli by
+     *    products of RNS primes
+     */
+    void computeRnsParams();
+
+    /** @brief Release modulus chain levels other than 0, level 0 objects
+     *    are the \c RnsQ, \c RnsQB, ... ones
+     */
+    static void clearModChain(std::vector<ModLevel>& chain);
+
     /** @brief Initialize FHE parameters class
      *
-     *  A "static" class constructor/destructor
+     *  A "static" class destructor
      */
     static class _init {
       public:
-        _init();
         ~_init();
     } _initializer;
 };
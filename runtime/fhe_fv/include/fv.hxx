@@ -21,16 +21,28 @@
 #ifndef __FV_HXX__
 #define __FV_HXX__
 
+#include "batching.hxx"
+#include "checksum.hxx"
 #include "ciphertext.hxx"
 #include "encdec.hxx"
+#include "fhe_context.hxx"
 #include "fhe_params.hxx"
 #include "fv.hxx"
 #include "keygen.hxx"
 #include "keys_all.hxx"
 #include "keys_share.hxx"
+#include "mapped_file.hxx"
+#include "mem_pool.hxx"
 #include "normal.hxx"
+#include "ntt.hxx"
 #include "polyring.hxx"
+#include "prg.hxx"
 #include "rand_polynom.hxx"
+#include "rns_base.hxx"
+#include "rns_conv.hxx"
+#include "rns_poly.hxx"
+#include "thread_pool.hxx"
 #include "uniform.hxx"
+#include "vec_mod.hxx"
 
 #endif
\ No newline at end of file
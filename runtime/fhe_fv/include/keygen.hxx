@@ -33,14 +33,50 @@ class KeyGen {
   private:
     KeysAll keysAll;
 
+    /** @brief Derive uniform key polynomials from seeds, see
+     *    @c CipherText::setSeed
+     */
+    bool seeded;
+
   protected:
     void generateSecretKey();
     void generatePublicKey();
     void generateEvalKey();
 
+    /** @brief Relinearization version 1 key, pairs
+     *    \c{(-(a_i.s + e_i) + g_i.s^2, a_i)} modulo \c q for each
+     *    decomposition digit
+     */
+    void generateEvalKeyV1();
+
+    /** @brief Key switching key from \c target to the secret key, pairs
+     *    \c{(-(a_i.s + e_i) + g_i.target, a_i)} modulo \c q for each
+     *    relinearization version 1 decomposition digit
+     */
+    CipherText* generateSwitchKey(const PolyRing& target);
+
+    /** @brief Galois keys, switching keys from \c{s(X^k)} to \c s, for
+     *    power of two rotations of slot rows and for the row swap
+     */
+    void generateGaloisKeys();
+
   public:
-    void generateKeys();
-    void writeKeys(const std::string& fileNamePrefix, const bool binary = true);
+    /** @brief Builds a key generator
+     *
+     *  @param seeded_p derive the uniform polynomials of public,
+     *    evaluation and Galois keys from 32-byte seeds, key files then
+     *    store seeds instead of these polynomials (about half the size)
+     */
+    KeyGen(const bool seeded_p = false): seeded(seeded_p) {}
+
+    /** @brief Generate secret, public and evaluation keys
+     *
+     *  @param galois generate Galois (rotation) keys too, power of two
+     *    cyclotomic rings only
+     */
+    void generateKeys(const bool galois = false);
+    void writeKeys(const std::string& fileNamePrefix, const bool binary = true,
+                   const bool rns = false);
 };
 
 #endif
@@ -72,8 +72,11 @@ class KeysAll : public KeysShare {
      *
      *  @param fileNamePrefix prefix of files names containing keys
      *  @param binary either to write keys as binary or as string
+     *  @param rns write evaluation and Galois keys in RNS form, see
+     *    @c KeysShare::writeKeys
      */
-    void writeKeys(const std::string& fileNamePrefix, const bool binary = true);
+    void writeKeys(const std::string& fileNamePrefix, const bool binary = true,
+                   const bool rns = false);
 };
 
 #endif
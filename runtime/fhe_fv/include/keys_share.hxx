@@ -26,7 +26,10 @@
 #define __KEYS_SHARE_HXX__
 
 #include "ciphertext.hxx"
+#include "fhe_context.hxx"
 
+#include <map>
+#include <memory>
 #include <string>
 
 class CipherText;
@@ -41,9 +44,23 @@ class KeysShare {
      */
     CipherText* EvalKey;
 
+    /** @brief Galois (rotation) keys indexed by Galois element, empty if
+     *    not generated
+     */
+    std::map<unsigned int, CipherText*> GaloisKeys;
+
+    /** @brief FHE context of the keys, the one bound to the thread which
+     *    built them
+     *
+     *  Keys keep their context alive and are read and written in it,
+     *    whatever the context of the calling thread.
+     */
+    std::shared_ptr<const FheContext> Context;
+
     /** @brief Basic constructor
      */
-    inline KeysShare(): PublicKey(NULL), EvalKey(NULL) {}
+    inline KeysShare(): PublicKey(NULL), EvalKey(NULL),
+                        Context(FheContext::current()) {}
 
     /** @brief Deallocates keys
      */
@@ -56,6 +73,8 @@ class KeysShare {
     void readPublicKey(FILE* const stream, const bool binary = true);
 
     /** @brief Read public key from a file
+     *
+     *  See @c CipherText::read, the file is memory-mapped.
      *
      *  @param fileName input file name from which read the key
      */
@@ -68,12 +87,27 @@ class KeysShare {
     void readEvalKey(FILE* const stream, const bool binary = true);
 
     /** @brief Read evaluation key from a file
+     *
+     *  See @c CipherText::read, keys written in RNS form are used in
+     *    place from the file mapping, shared by all evaluator processes.
      *
      *  @param fileName input file name from which read the key
      */
     void readEvalKey(const std::string& fileName, const bool binary = true);
 
+    /** @brief Read Galois keys from an input stream
+     *
+     *  Keys are copied from the stream, they are not used in place even
+     *    when written in RNS form.
+     *
+     *  @param stream input stream from which read the keys
+     */
+    void readGaloisKeys(FILE* const stream, const bool binary = true);
+
     /** @brief Read all keys from files with a given prefix
+     *
+     *  Public and evaluation keys are memory-mapped, Galois keys are
+     *    read with @c readGaloisKeys, only if their file exists.
      *
      *  @param fileNamePrefix prefix of files names containing keys
      */
@@ -88,14 +122,31 @@ class KeysShare {
     /** @brief Write evaluation key from an input stream
      *
      *  @param out_io output stream to which write the key
+     *  @param rns write the key residues in RNS and NTT form, as used
+     *    by relinearizations (see @c CipherText::writeRns), binary only
+     */
+    void writeEvalKey(FILE* const stream, const bool binary = true,
+                      const bool rns = false);
+
+    /** @brief Write Galois keys to an output stream
+     *
+     *  Keys are written as their number followed by each Galois element
+     *    and key.
+     *
+     *  @param stream output stream to which write the keys
+     *  @param rns write keys residues in RNS and NTT form, binary only
      */
-    void writeEvalKey(FILE* const stream, const bool binary = true);
+    void writeGaloisKeys(FILE* const stream, const bool binary = true,
+                         const bool rns = false);
 
     /** @brief Write all keys to files with a given prefix
      *
      *  @param fileNamePrefix prefix of files names containing keys
+     *  @param rns write evaluation and Galois keys in RNS form, see
+     *    @c writeEvalKey
      */
-    void writeKeys(const std::string& fileNamePrefix, const bool binary = true);
+    void writeKeys(const std::string& fileNamePrefix, const bool binary = true,
+                   const bool rns = false);
 };
 
 #endif
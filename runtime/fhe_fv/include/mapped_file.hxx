@@ -0,0 +1,76 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+
+/** @file mapped_file.hxx
+ *  @brief Read-only memory mapping of a whole file
+ */
+
+#ifndef __MAPPED_FILE_HXX__
+#define __MAPPED_FILE_HXX__
+
+#include <stddef.h>
+#include <string>
+
+/** @brief Read-only memory mapping of a file
+ *
+ *  Pages are shared with the page cache, hence between all processes
+ *    mapping the same file. They are never written, a write faults: users
+ *    copy the content before modifying it. The mapping lives as long as
+ *    the object.
+ */
+class MappedFile {
+  private:
+    const unsigned char* buff;
+    size_t length;
+
+  public:
+    /** @brief Map file \c fileName, see @c valid
+     */
+    MappedFile(const std::string& fileName);
+
+    /** @brief Unmap file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @brief Return true if the file is mapped, false if it could not
+     *    be opened or mapped (e.g. empty file)
+     */
+    bool valid() const {
+      return buff != nullptr;
+    }
+
+    /** @brief Return mapped file content
+     */
+    const unsigned char* data() const {
+      return buff;
+    }
+
+    /** @brief Return file size in bytes
+     */
+    size_t size() const {
+      return length;
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file mem_pool.hxx
+ *  @brief Per-thread pool of word buffers
+ */
+
+#ifndef __MEM_POOL_HXX__
+#define __MEM_POOL_HXX__
+
+#include <flint/flint.h>
+#include <stddef.h>
+
+/** @brief Pool of word buffers used for polynomial residues.
+ *
+ *  Released buffers are cached in a per-thread slab of free lists, one
+ *    list per buffer size, and reused by later allocations of the same
+ *    size from the same thread. Threads do not share any lock. A buffer
+ *    can be released by a thread other than the one which allocated it.
+ *
+ *  Buffers are aligned on 64 bytes (a cache line, an AVX-512 vector).
+ */
+class MemPool {
+  public:
+    /** @brief Maximal number of cached buffers per size and per thread,
+     *    further released buffers are returned to the system
+     */
+    static const unsigned int MaxCached = 64;
+
+    /** @brief Allocate a buffer of \c words words (uninitialized)
+     */
+    static mp_limb_t* allocate(const size_t words);
+
+    /** @brief Release a buffer of \c words words
+     *
+     *  @param ptr buffer returned by @c allocate, can be \c nullptr
+     *  @param words size of the buffer, as given to @c allocate
+     */
+    static void release(mp_limb_t* const ptr, const size_t words);
+
+  private:
+    /** @brief Hide constructor
+     */
+    MemPool() {}
+};
+
+#endif
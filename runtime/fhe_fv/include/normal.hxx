@@ -27,44 +27,91 @@
 
 #include <flint/fmpz.h>
 #include <mpfr.h>
+#include <stdint.h>
+#include <deque>
+#include <mutex>
+#include <vector>
 
+/** @brief Normal distribution random number generator
+ *
+ *  Discrete Gaussian distributions registered with @c precompute (the
+ *    ciphertext and key switching noise ones, at parameters load) are
+ *    sampled in constant time with a cumulative distribution table (CDT).
+ *    Other samples are rounded normal values drawn with the Box-Muller
+ *    transform, in double precision when the distribution interval is
+ *    small enough and with MPFR otherwise. All samplers draw from the
+ *    per-thread generator of @c UniformRng.
+ */
 class NormalRng {
   protected:
-    /** @brief Variable holds the random state of the PRNG from \c gmp library.
-    */
-    static gmp_randstate_t randstate;
+    /** @brief Cumulative distribution table of a discrete Gaussian
+     *
+     *  \c{cdf[k]} is \c{2^64 . P(|x| <= k)}, the magnitude of a sample is
+     *    the number of entries not greater than a uniform 64-bit word.
+     *    Entries stop where the remaining tail is below \c{2^-64} or
+     *    at the distribution interval bound.
+     */
+    struct Cdt {
+      slong sigma;
+      slong bound;
+      std::vector<uint64_t> cdf;
+    };
 
-    /** @brief Initialize PRNG state.
+    /** @brief Precomputed tables, shared by all FHE contexts
      *
-     *  This method initializes \c gmp PRNG state and
-     *    seeds the state with a random number.
-     *  It should be called before function \c sampleNormal is used.
+     *  Tables are never removed and a deque keeps references to them
+     *    valid when others are added.
      */
-    static void init();
- 
-    /** @brief Automatic initializer
+    static std::deque<Cdt> tables;
+
+    /** @brief Lock of \c tables, contexts can be created concurrently
      */
-    static class _init {
-      public:
-        inline _init();
-        inline ~_init();
-    } _initializer;
-    
+    static std::mutex tablesLock;
+
+    /** @brief Return the table for \c sigma and \c B or \c nullptr
+     */
+    static const Cdt* findTable(const fmpz_t sigma, const fmpz_t B);
+
+    /** @brief Sample \c cnt numbers with table \c cdt
+     *
+     *  Each sample scans the whole table and its sign is applied with
+     *    a mask, the running time does not depend on sampled values.
+     */
+    static void sample(fmpz* const nums, const unsigned int cnt,
+                       const Cdt& cdt);
+
+    /** @brief Largest bit-size of the distribution interval for which
+     *    samples are computed in double precision
+     */
+    static const unsigned int DOUBLE_MAX_BITS = 40;
+
     /** @brief Sample \c mpfr_num according to normal distribution.
      *
      *  Sample \c mpfr_num according to normal distribution with mean \c 0 and
      *    standard deviation \c mpfr_sigma.
      *  The precision (number of digits) if given by the precision of \c mpfr_num.
-     *
-     *  \todo Reimplement this method to use the uniform RNG defined
-     *    in header uniform_rng.h
+     *  A per-thread \c gmp PRNG state, seeded from @c UniformRng, is used.
      *
      *  @param mpfr_num sampled number
      *  @param mpfr_sigma standard deviation
      */
     static void sample(mpfr_t mpfr_num, mpfr_t mpfr_sigma);
-     
+
   public:
+    /** @brief Maximal number of entries of a distribution table
+     */
+    static const unsigned int CDT_MAX_SIZE = 4096;
+
+    /** @brief Precompute the distribution table of a discrete Gaussian
+     *    with standard deviation \c sigma on interval \c{[-B;B]}
+     *
+     *  Later samples with these parameters use the table. Nothing is
+     *    done when the table would have more than @c CDT_MAX_SIZE
+     *    entries or when it exists already. It is called when a
+     *    @c FheContext is created.
+     */
+    static void precompute(const fmpz_t sigma, const fmpz_t B);
+
     /** @brief Sample \c num according to a normal distribution.
      *
      *  This method samples a number \c num according to a normal distribution.
@@ -75,6 +122,21 @@ class NormalRng {
      *  @param B the distribution interval (~10.sigma)
      */
     static void sample(fmpz_t num, const fmpz_t sigma, const fmpz_t B);
+
+    /** @brief Sample \c cnt numbers according to a normal distribution.
+     *
+     *  Numbers are sampled in bulk, with the precomputed table of
+     *    \c sigma and \c B if any. Otherwise samples outside of
+     *    \c{[-B;B]} are rejected. Numbers in \c nums should be
+     *    initialized.
+     *
+     *  @param nums sampled numbers
+     *  @param cnt number of samples
+     *  @param sigma the standard deviation
+     *  @param B the distribution interval (~10.sigma)
+     */
+    static void sample(fmpz* const nums, const unsigned int cnt,
+                       const fmpz_t sigma, const fmpz_t B);
 };
 
 #endif
@@ -0,0 +1,159 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file ntt.hxx
+ *  @brief Negacyclic number theoretic transform over word-sized primes
+ */
+
+#ifndef __NTT_HXX__
+#define __NTT_HXX__
+
+#include <flint/flint.h>
+#include <flint/nmod_vec.h>
+#include <vector>
+
+/** @brief Negacyclic number theoretic transform (NTT) class.
+ *
+ *  Transforms polynomials of \c{Z_p[X]/(X^n+1)}, with \c n a power of two
+ *    and \c p a prime congruent to 1 modulo \c{2.n}, to their evaluations
+ *    in the odd powers of a primitive \c{2.n}-th root of unity \c psi.
+ *    A product in the ring is then a coefficient-wise product in the
+ *    evaluation (NTT) domain.
+ *
+ *  Twiddle factors are stored in bit-reversed order together with their
+ *    Shoup precomputed quotients. Butterflies use Harvey's lazy reduction,
+ *    so primes must be smaller than \c{2^62}.
+ */
+class Ntt {
+  private:
+    /** @brief Transform length \c n
+     */
+    unsigned int n;
+
+    /** @brief \c{log2(n)}
+     */
+    unsigned int logn;
+
+    /** @brief Prime modulo
+     */
+    nmod_t mod;
+
+    /** @brief Powers of \c psi in bit-reversed order
+     */
+    std::vector<mp_limb_t> psiPow;
+
+    /** @brief Shoup quotients \c{floor(w.2^64/p)} of \c psiPow
+     */
+    std::vector<mp_limb_t> psiPowShoup;
+
+    /** @brief Powers of \c{psi^-1} in bit-reversed order
+     */
+    std::vector<mp_limb_t> psiInvPow;
+
+    /** @brief Shoup quotients of \c psiInvPow
+     */
+    std::vector<mp_limb_t> psiInvPowShoup;
+
+    /** @brief \c{n^-1 mod p} and its Shoup quotient
+     */
+    mp_limb_t nInv, nInvShoup;
+
+  public:
+    /** @brief Precompute twiddle factor tables
+     *
+     *  @param n_p transform length, a power of two
+     *  @param p prime modulo, congruent to 1 modulo \c{2.n} and smaller
+     *    than \c{2^62}
+     */
+    Ntt(const unsigned int n_p, const mp_limb_t p);
+
+    /** @brief Return transform length
+     */
+    unsigned int length() const {
+      return n;
+    }
+
+    /** @brief Return prime modulo
+     */
+    mp_limb_t prime() const {
+      return mod.n;
+    }
+
+    /** @brief In-place forward transform
+     *
+     *  @param a polynomial coefficients in \c{[0;p)}, replaced by its
+     *    evaluations in \c{[0;p)} (in bit-reversed order)
+     */
+    void forward(mp_limb_t* const a) const;
+
+    /** @brief In-place inverse transform
+     *
+     *  @param a evaluations in \c{[0;p)}, replaced by polynomial
+     *    coefficients in \c{[0;p)}
+     */
+    void inverse(mp_limb_t* const a) const;
+
+    /** @brief Coefficient-wise product in NTT domain
+     *
+     *  Operands do not need to be reduced, the result is in \c{[0;p)}.
+     *
+     *  @param res output, can alias inputs
+     *  @param a first operand
+     *  @param b second operand
+     */
+    void multiply(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b) const;
+
+    /** @brief Negacyclic convolution \c{res = a.b mod X^n+1}
+     *
+     *  Operands are in coefficient domain, they are transformed in
+     *    temporary buffers.
+     *
+     *  @param res output, can alias inputs
+     *  @param a first operand
+     *  @param b second operand
+     */
+    void convolve(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b) const;
+
+    /** @brief NTT domain permutation of a Galois automorphism
+     *
+     *  Automorphism \c{X -> X^k} maps the evaluation in \c{psi^e} to the
+     *    one in \c{psi^(e.k)}, hence in NTT domain it only permutes
+     *    evaluations: \c{NTT(a(X^k))[i] = NTT(a)[perm[i]]}. The
+     *    permutation does not depend on the prime.
+     *
+     *  @param n transform length, a power of two
+     *  @param k Galois element, odd and smaller than \c{2.n}
+     *  @return permutation \c perm
+     */
+    static std::vector<unsigned int> galoisPermutation(const unsigned int n,
+                                                       const unsigned int k);
+
+    /** @brief Index of the evaluation in \c{psi^e} in NTT domain
+     *
+     *  @param n transform length, a power of two
+     *  @param e odd exponent smaller than \c{2.n}
+     */
+    static unsigned int evaluationIndex(const unsigned int n,
+                                        const unsigned int e);
+};
+
+#endif
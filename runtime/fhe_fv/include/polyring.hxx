@@ -80,6 +80,12 @@ public:
    */
   PolyRing(const PolyRing &poly);
 
+  /** @brief Move-construct a polynomial, coefficients are not copied
+   *
+   *  Polynomial \c poly is left empty.
+   */
+  PolyRing(PolyRing &&poly);
+
   /** @brief Destructs polynomial object
    */
   ~PolyRing();
@@ -126,6 +132,17 @@ public:
    */
   static void add(PolyRing &left_poly, const PolyRing &right_poly);
 
+  /** @brief Add two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c res = \c left + \c right
+   *
+   *  @param res result of addition, can alias \c left or \c right.
+   *  @param left left side of addition.
+   *  @param right right side of addition.
+   */
+  static void add(PolyRing &res, const PolyRing &left, const PolyRing &right);
+
   /** @brief In-place subtract two polynomials.
    *
    *  Substract polynomial \c right from the polynomial \c left and
@@ -138,6 +155,17 @@ public:
    */
   static void sub(PolyRing &left, const PolyRing &right);
 
+  /** @brief Subtract two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c res = \c left - \c right
+   *
+   *  @param res result of subtraction, can alias \c left or \c right.
+   *  @param left left side of subtraction.
+   *  @param right right side of subtraction.
+   */
+  static void sub(PolyRing &res, const PolyRing &left, const PolyRing &right);
+
   /** @brief In-place multiply two polynomials.
    *
    *  Multiply polynomial \c right_poly with polynomial \c left_poly and
@@ -145,7 +173,7 @@ public:
    *  This function performs the following operation:
    *    \c prod_poly = ( \c left_poly * \c right_poly )
    *
-   *  @param prod_poly result of multiplication.
+   *  @param prod_poly result of multiplication, can alias operands.
    *  @param left_poly left side of multiplication.
    *  @param right_poly right side of multiplication.
    */
@@ -201,6 +229,20 @@ public:
    */
   static void square(PolyRing &poly);
 
+  /** @brief Apply a Galois automorphism to a polynomial.
+   *
+   *  This function performs the following operation:
+   *    \c{res(X) = poly(X^k)}
+   *
+   *  Only power of two cyclotomic rings are supported, where
+   *    \c{X^j -> X^(j.k)} is a signed permutation of coefficients.
+   *
+   *  @param res result polynomial, must not alias \c poly
+   *  @param poly polynomial to transform
+   *  @param k Galois element, odd and smaller than \c{2 . FheParams::D}
+   */
+  static void automorphism(PolyRing &res, const PolyRing &poly, const unsigned int k);
+
   /** @brief Assignment operator
    *
    *  Assigns a copy of polynomial object \c poly to current object.
@@ -209,6 +251,13 @@ public:
    */
   PolyRing& operator=(const PolyRing &poly);
 
+  /** @brief Move assignment operator, coefficients are not copied
+   *
+   *  @param poly polynomial object to move to current object, it is
+   *    left in a valid but unspecified state
+   */
+  PolyRing& operator=(PolyRing &&poly);
+
   /**
    * @brief Sets polynomial coefficient with a \c fmpz_t
    */
@@ -251,6 +300,38 @@ public:
    */
   void write(FILE* const out_stream, const bool binary = true) const;
 
+  /** @brief Return the size in bytes of a packed polynomial
+   *
+   *  \c FheParams::D coefficients of \c bits bits, padded to a
+   *    multiple of 8 bytes.
+   */
+  static size_t packedSize(const unsigned int bits);
+
+  /** @brief Return the bit-size of the largest coefficient magnitude
+   *
+   *  @param negative set to true if a coefficient is negative
+   */
+  unsigned int maxBits(bool& negative) const;
+
+  /** @brief Pack polynomial coefficients with a fixed width
+   *
+   *  The \c FheParams::D coefficients are written little-endian as a
+   *    bit stream, \c bits bits each. When \c sign is true a sign bit
+   *    follows the \c bits bits of the coefficient magnitude.
+   *
+   *  @param buff output buffer of @c packedSize bytes, for \c bits
+   *    plus the sign bit
+   *  @param bits magnitude bit-size, at least @c maxBits
+   *  @param sign write a sign bit
+   */
+  void pack(unsigned char* const buff, const unsigned int bits,
+            const bool sign) const;
+
+  /** @brief Unpack polynomial coefficients, see @c pack
+   */
+  void unpack(const unsigned char* const buff, const unsigned int bits,
+              const bool sign);
+
   /** @brief Write printer-friendly version of polynomial to an output stream
    *
    *  @param out_stream stream to which to write
@@ -0,0 +1,94 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file prg.hxx
+ *  @brief Deterministic pseudo-random generator expanded from a seed.
+ */
+
+#ifndef __PRG_HXX__
+#define __PRG_HXX__
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief ChaCha20 keystream generator.
+ *
+ *  The 32-byte seed is the ChaCha20 key and \c stream the 64-bit nonce,
+ *    the keystream is a deterministic function of both. It is used to
+ *    derive uniform polynomials from a seed, so that only the seed is
+ *    stored (see @c CipherText::setSeed).
+ */
+class Prg {
+  public:
+    /** @brief Seed size in bytes
+     */
+    static const unsigned int SEED_SIZE = 32;
+
+    typedef std::array<unsigned char, SEED_SIZE> Seed;
+
+  private:
+    /** @brief ChaCha20 input block: constants, key, counter and nonce
+     */
+    uint32_t state[16];
+
+    /** @brief Current keystream block and number of used bytes in it
+     */
+    unsigned char block[64];
+    unsigned int used;
+
+    /** @brief Compute next keystream block to \c out and increment block
+     *    counter
+     */
+    void generate(unsigned char out[64]);
+
+    /** @brief Compute next keystream block in \c block
+     */
+    void refill();
+
+  public:
+    /** @brief Build a generator from a seed
+     *
+     *  @param seed generator seed (ChaCha20 key)
+     *  @param stream independent stream index (ChaCha20 nonce)
+     */
+    Prg(const Seed& seed, const uint64_t stream = 0);
+
+    /** @brief Sample a new seed from the system random generator
+     */
+    static void randomSeed(Seed& seed);
+
+    /** @brief Write next \c len keystream bytes to \c out
+     *
+     *  Whole blocks are generated directly in \c out, bulk requests are
+     *    not copied through the internal buffer.
+     */
+    void bytes(unsigned char* const out, const size_t len);
+
+    /** @brief Return next 8 keystream bytes as a little-endian word
+     */
+    uint64_t next();
+
+    /** @brief ChaCha20 block function, 20 rounds on \c in plus \c in
+     */
+    static void chacha20(uint32_t out[16], const uint32_t in[16]);
+};
+
+#endif
@@ -20,28 +20,20 @@
 
 /** @file rand_polynom.hxx
  *  @brief Random polynomial generator with different distributions.
+ *
+ *  Polynomials are sampled in bulk from the per-thread generator of
+ *    @c UniformRng.
  */
 
 #ifndef __RAND_POLYNOM_HXX__
 #define __RAND_POLYNOM_HXX__
 
+#include "prg.hxx"
+
 #include <flint/fmpz_poly.h>
 
 class RandPolynom {
-  protected:
-    /** @brief Set a binary polynomial with coefficients from a given number.
-     *
-     *  Build a polynomial with binary coefficients. The coefficient values
-     *    are taken from number \c num binary form.
-     *  The degree of the built polynomial is \c degree.
-     *
-     *  @param poly the polynomial to set
-     *  @param num the number from which to extract coefficients
-     */  
-    static void populateBinaryPolyRing(fmpz_poly_t poly, fmpz_t num);
-  
   public:
-
     /** @brief Sample a polynomial according to a binary uniform distribution
      *
      *  This method samples a polynomial of length \c len with coefficients
@@ -82,14 +74,30 @@ class RandPolynom {
     /** @brief Sample a polynomial according to an uniform distribution
      *
      *  This method samples a polynomial of length \c len with coefficients
-     *    sampled from a uniform distribution defined on \c{[0;q)}.
-     *  The distribution interval (\c q) must be a power of two.
+     *    sampled from a uniform distribution defined on \c{[0;q)}, by
+     *    rejection.
+     *
+     *  @param poly the polynomial to sample
+     *  @param len the length of the polynomial to sample
+     *  @param q uniform distribution interval
+     */
+    static void sampleUniform(fmpz_poly_t poly, unsigned int len, const fmpz_t q);
+
+    /** @brief Sample a polynomial according to an uniform distribution
+     *    with a deterministic generator
+     *
+     *  This method samples a polynomial of length \c len with coefficients
+     *    sampled from a uniform distribution defined on \c{[0;q)}, by
+     *    rejection. The polynomial only depends on the seed and stream
+     *    of \c prg, any \c q is supported.
      *
      *  @param poly the polynomial to sample
      *  @param len the length of the polynomial to sample
      *  @param q uniform distribution interval
+     *  @param prg generator from which coefficients are derived
      */
-    static void sampleUniform(fmpz_poly_t poly, unsigned int len, fmpz_t q);
+    static void sampleUniform(fmpz_poly_t poly, unsigned int len,
+                              const fmpz_t q, Prg& prg);
     
     /** @brief Sample a polynomial according to a normal distribution
      *
@@ -102,8 +110,8 @@ class RandPolynom {
      *  @param sigma the standard deviation
      *  @param B the distribution interval (~10.sigma)
      */
-    static void sampleNormal(fmpz_poly_t poly, unsigned int len, fmpz_t sigma, 
-                              fmpz_t B);
+    static void sampleNormal(fmpz_poly_t poly, unsigned int len,
+                             const fmpz_t sigma, const fmpz_t B);
 };
 
 #endif
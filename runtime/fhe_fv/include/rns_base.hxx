@@ -0,0 +1,212 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file rns_base.hxx
+ *  @brief Residue number system (RNS) bases of word-sized primes
+ */
+
+#ifndef __RNS_BASE_HXX__
+#define __RNS_BASE_HXX__
+
+#include <flint/flint.h>
+#include <flint/fmpz.h>
+#include <flint/nmod_vec.h>
+#include <memory>
+#include <vector>
+
+#include "ntt.hxx"
+
+/** @brief RNS base class.
+ *
+ *  An RNS base is a list of pairwise distinct word-sized primes
+ *    \c{p_0, ..., p_{k-1}}. An integer modulo \c{M = p_0 ... p_{k-1}}
+ *    is represented by its residues modulo each prime.
+ */
+class RnsBase {
+  private:
+    /** @brief Base primes
+     */
+    std::vector<mp_limb_t> primes;
+
+    /** @brief Precomputed FLINT modular arithmetic structures, one per prime
+     */
+    std::vector<nmod_t> mods;
+
+    /** @brief Base modulus, product of all primes
+     */
+    fmpz_t M;
+
+    /** @brief CRT constants \c{M/p_i}
+     */
+    fmpz* Mhat;
+
+    /** @brief CRT constants \c{(M/p_i)^-1 mod p_i}
+     */
+    std::vector<mp_limb_t> MhatInv;
+
+    /** @brief Negacyclic NTT tables, one per prime (empty if not initialized)
+     */
+    std::vector<std::shared_ptr<const Ntt>> ntts;
+
+    /** @brief Maximal \c k such that \c{k.p_i} fits in a word for all primes
+     */
+    unsigned int maxLazyBound;
+
+  public:
+    /** @brief Build an RNS base from a list of primes
+     *
+     *  @param primes_p list of pairwise distinct primes
+     */
+    RnsBase(const std::vector<mp_limb_t>& primes_p);
+
+    /** @brief Build an RNS base as the concatenation of two bases
+     *
+     *  Primes of \c base1 come first, followed by primes of \c base2.
+     */
+    RnsBase(const RnsBase& base1, const RnsBase& base2);
+
+    /** @brief Build an RNS base from the first \c count primes of \c base
+     *
+     *  NTT tables of \c base, if any, are shared.
+     */
+    RnsBase(const RnsBase& base, const unsigned int count);
+
+    /** @brief Destructs RNS base object
+     */
+    ~RnsBase();
+
+    /** @brief Return the number of primes in the base
+     */
+    unsigned int size() const {
+      return primes.size();
+    }
+
+    /** @brief Return the i-th prime of the base
+     */
+    mp_limb_t prime(const unsigned int idx) const {
+      return primes[idx];
+    }
+
+    /** @brief Return the maximal lazy reduction bound
+     *
+     *  Unreduced residues smaller than \c{k.p_i} fit in a machine word
+     *    as long as \c k is at most this bound.
+     */
+    unsigned int lazyBound() const {
+      return maxLazyBound;
+    }
+
+    /** @brief Return the FLINT modular structure of the i-th prime
+     */
+    const nmod_t& mod(const unsigned int idx) const {
+      return mods[idx];
+    }
+
+    /** @brief Return the list of base primes
+     */
+    const std::vector<mp_limb_t>& getPrimes() const {
+      return primes;
+    }
+
+    /** @brief Return true if NTT tables are initialized
+     */
+    bool hasNtt() const {
+      return not ntts.empty();
+    }
+
+    /** @brief Return NTT tables of the i-th prime
+     */
+    const Ntt& ntt(const unsigned int idx) const {
+      return *ntts[idx];
+    }
+
+    /** @brief Precompute negacyclic NTT tables of length \c n for all primes
+     *
+     *  All primes must be congruent to 1 modulo \c{2.n}.
+     */
+    void initNtt(const unsigned int n);
+
+    /** @brief Return the base modulus (product of all primes)
+     */
+    const fmpz* modulus() const {
+      return M;
+    }
+
+    /** @brief Return CRT constant \c{M/p_i}
+     */
+    const fmpz* crtFactor(const unsigned int idx) const {
+      return Mhat + idx;
+    }
+
+    /** @brief Return CRT constant \c{(M/p_i)^-1 mod p_i}
+     */
+    mp_limb_t crtFactorInv(const unsigned int idx) const {
+      return MhatInv[idx];
+    }
+
+    /** @brief Reduce an integer modulo each base prime
+     *
+     *  @param residues output residues, \c residues[i*stride] is set to
+     *    \c{x mod p_i}
+     *  @param x integer to reduce
+     *  @param stride distance between consecutive residues
+     */
+    void reduce(mp_limb_t* const residues, const fmpz_t x,
+                const unsigned int stride = 1) const;
+
+    /** @brief Reconstruct an integer from its residues (CRT)
+     *
+     *  @param x output integer, in \c{[0;M)} or in \c{(-M/2;M/2]} when
+     *    \c centered is true
+     *  @param residues input residues, \c residues[i*stride] is the residue
+     *    modulo \c p_i, it does not need to be reduced
+     *  @param stride distance between consecutive residues
+     *  @param centered use a centered representative
+     */
+    void reconstruct(fmpz_t x, const mp_limb_t* const residues,
+                const unsigned int stride = 1, const bool centered = false) const;
+
+    /** @brief Generate primes congruent to 1 modulo \c m
+     *
+     *  Primes are searched downwards from \c{2^bitsize} and congruent
+     *    to 1 modulo \c m, i.e. suitable for negacyclic number theoretic
+     *    transforms of length \c{m/2}. Primes in \c exclude are skipped.
+     *
+     *  @param count number of primes to generate
+     *  @param bitsize maximal bit-size of primes
+     *  @param m congruence modulo
+     *  @param exclude primes which should not be generated
+     *  @return the list of generated primes
+     */
+    static std::vector<mp_limb_t> generatePrimes(const unsigned int count,
+                const unsigned int bitsize, const mp_limb_t m,
+                const std::vector<mp_limb_t>& exclude = std::vector<mp_limb_t>());
+
+  private:
+    /** @brief Hide copy constructor
+     */
+    RnsBase(const RnsBase&);
+
+    /** @brief Compute CRT constants from base primes
+     */
+    void init();
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file rns_conv.hxx
+ *  @brief Word-level RNS base conversion and scaling
+ */
+
+#ifndef __RNS_CONV_HXX__
+#define __RNS_CONV_HXX__
+
+#include "rns_base.hxx"
+
+#include <flint/flint.h>
+#include <vector>
+
+/** @brief Fast RNS base conversion class.
+ *
+ *  Converts residues of an integer \c x in base \c A (modulus \c a) to
+ *    residues of its centered representative in base \c C, without big
+ *    integer arithmetic (Halevi-Polyakov-Shoup). With
+ *    \c{y_i = [x_i.(a/a_i)^-1]_{a_i}}, \c{x = sum y_i.a/a_i - v.a} where
+ *    \c{v = round(sum y_i/a_i)} is computed in 128-bit fixed point.
+ *
+ *  The result can differ from the exact centered representative by
+ *    \c{+-a} when \c x is within \c{2^-60.a} of \c{+-a/2}, which only
+ *    slightly increases the norm of the lifted polynomial.
+ */
+class RnsConv {
+  private:
+    /** @brief Source base \c A
+     */
+    const RnsBase& from;
+
+    /** @brief Destination base \c C
+     */
+    const RnsBase& to;
+
+    /** @brief \c{(a/a_i)^-1 mod a_i} and their Shoup quotients
+     */
+    std::vector<mp_limb_t> ahatInv, ahatInvShoup;
+
+    /** @brief \c{a/a_i mod c_j}, stored row-wise by \c j
+     */
+    std::vector<mp_limb_t> ahatModC;
+
+    /** @brief \c{-a mod c_j}
+     */
+    std::vector<mp_limb_t> negAModC;
+
+    /** @brief \c{floor(2^128/a_i)}, high and low words
+     */
+    std::vector<mp_limb_t> invHi, invLo;
+
+  public:
+    /** @brief Precompute conversion constants from base \c from to
+     *    base \c to
+     *
+     *  @remarks Bases are referenced, not copied
+     */
+    RnsConv(const RnsBase& from, const RnsBase& to);
+
+    /** @brief Source base
+     */
+    const RnsBase& source() const {
+      return from;
+    }
+
+    /** @brief Destination base
+     */
+    const RnsBase& target() const {
+      return to;
+    }
+
+    /** @brief Convert \c n integers
+     *
+     *  @param dst output residues, limb-wise (\c{dst + j.n} are residues
+     *    modulo the j-th prime of the destination base), in \c{[0;c_j)}
+     *  @param src input residues, limb-wise, they do not need to be reduced
+     *  @param n number of integers
+     */
+    void convert(mp_limb_t* const dst, const mp_limb_t* const src,
+                 const unsigned int n) const;
+};
+
+/** @brief RNS scale and round class.
+ *
+ *  Computes \c{round(t.x/d)} in base \c K for an integer \c x given in
+ *    a base which is the concatenation of base \c K and of a base \c D
+ *    of modulus \c d (in any order). With \c{y_i} the CRT coefficients of
+ *    the primes \c{d_i} and \c{t.k/d_i = w_i + f_i} (integer and
+ *    fractional parts), the result modulo \c{k_j} is
+ *    \c{t.d^-1.x_j + sum y_i.w_i + round(sum y_i.f_i)}.
+ *    Fractions are stored in 128-bit fixed point. The rounding is exact
+ *    unless \c{t.x/d} is within \c{2^-60} of a half-integer.
+ *
+ *  This is used for the \c{t/q} rescaling of ciphertext products and for
+ *    the \c{1/p} rescaling of relinearization.
+ */
+class RnsScale {
+  private:
+    /** @brief Source base, concatenation of bases \c K and \c D
+     */
+    const RnsBase& base;
+
+    /** @brief Destination base \c K
+     */
+    const RnsBase& keep;
+
+    /** @brief Index of the first limb of \c K and of \c D in \c base
+     */
+    unsigned int keepOffset, dropOffset;
+
+    /** @brief Number of primes of base \c D
+     */
+    unsigned int dropSize;
+
+    /** @brief \c{(m/d_i)^-1 mod d_i}, \c m modulus of \c base, and their
+     *    Shoup quotients
+     */
+    std::vector<mp_limb_t> dhatInv, dhatInvShoup;
+
+    /** @brief \c{floor(t.k/d_i) mod k_j}, stored row-wise by \c j
+     */
+    std::vector<mp_limb_t> intModK;
+
+    /** @brief \c{frac(t.k/d_i).2^128}, high and low words
+     */
+    std::vector<mp_limb_t> fracHi, fracLo;
+
+    /** @brief \c{t.d^-1 mod k_j} and their Shoup quotients
+     */
+    std::vector<mp_limb_t> tdInv, tdInvShoup;
+
+  public:
+    /** @brief Precompute scaling constants
+     *
+     *  @param base input base, concatenation of \c keep and of the base
+     *    of dropped primes (in any order)
+     *  @param keep output base
+     *  @param t numerator of the scaling factor
+     *
+     *  @remarks Bases are referenced, not copied
+     */
+    RnsScale(const RnsBase& base, const RnsBase& keep, const mp_limb_t t);
+
+    /** @brief Source base
+     */
+    const RnsBase& source() const {
+      return base;
+    }
+
+    /** @brief Destination base
+     */
+    const RnsBase& target() const {
+      return keep;
+    }
+
+    /** @brief Scale and round \c n integers
+     *
+     *  @param dst output residues in base \c K, limb-wise, in \c{[0;k_j)}
+     *  @param src input residues in the source base, limb-wise, they do
+     *    not need to be reduced
+     *  @param n number of integers
+     */
+    void scale(mp_limb_t* const dst, const mp_limb_t* const src,
+               const unsigned int n) const;
+};
+
+#endif
@@ -0,0 +1,343 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file rns_poly.hxx
+ *  @brief Polynomial quotient ring objects in RNS representation
+ */
+
+#ifndef __RNS_POLY_HXX__
+#define __RNS_POLY_HXX__
+
+#include "polyring.hxx"
+#include "rns_base.hxx"
+#include "rns_conv.hxx"
+
+#include <assert.h>
+#include <flint/flint.h>
+#include <flint/fmpz.h>
+
+/** @brief Polynomial quotient ring class with coefficients in RNS
+ *    representation.
+ *
+ *  Each polynomial coefficient is stored as its residues modulo the primes
+ *    of an RNS base. Residues are stored limb-wise: the \c FheParams::D
+ *    residues modulo the i-th prime are contiguous in memory.
+ *
+ *  Additions and subtractions are lazy: residues are not reduced and a
+ *    bound on their growth is tracked instead. Residues are reduced when
+ *    the bound would overflow a machine word, or before operations
+ *    which need them in \c{[0;p)} (NTT, schoolbook products).
+ *
+ *  For power of two cyclotomic rings a polynomial can be kept in NTT
+ *    (evaluation) form, where multiplication is coefficient-wise. Additions
+ *    and scalar multiplications work in both forms, base conversions and
+ *    roundings need the coefficient form and transform a copy if required.
+ *
+ *  Residues are either owned by the polynomial, in a buffer from
+ *    @c MemPool, or a view on a buffer owned by someone else (e.g. all
+ *    polynomials of a ciphertext share a single buffer).
+ *
+ *  @remarks All arithmetic operations, including base conversions and
+ *    roundings, are done on machine words.
+ */
+class RnsPoly {
+private:
+  /** @brief RNS base of polynomial coefficients
+   */
+  const RnsBase* base;
+
+  /** @brief Polynomial residues, \c{size() * FheParams::D} words
+   */
+  mp_limb_t* data;
+
+  /** @brief Polynomial is in NTT form
+   */
+  bool nttForm;
+
+  /** @brief Residues buffer is owned (and released on destruction)
+   */
+  bool owner;
+
+  /** @brief Lazy reduction bound, residues modulo \c p_i are smaller
+   *    than \c{bound.p_i} (1 when reduced)
+   */
+  unsigned int bound;
+
+  /** @brief Build a view on existing residues, which are not cleared
+   */
+  RnsPoly(const RnsBase& base, mp_limb_t* const data, const bool ntt,
+          const unsigned int bound);
+
+protected:
+  /** @brief Reduce a polynomial product modulo the cyclotomic polynomial
+   *    defining the polynomial ring
+   *
+   *  @param res reduced polynomial, \c FheParams::D residues
+   *  @param prod polynomial product, \c{2 . FheParams::D - 1} residues
+   *  @param idx base prime index
+   */
+  void reduce(mp_limb_t* const res, mp_limb_t* const prod,
+              const unsigned int idx) const;
+
+public:
+  /** @brief Build a zero polynomial in RNS base \c base
+   *
+   *  @param ntt polynomial is considered in NTT form
+   */
+  RnsPoly(const RnsBase& base, const bool ntt = false);
+
+  /** @brief Build a RNS polynomial from a polynomial ring element
+   *
+   *  Coefficients of \c poly are reduced modulo each prime of \c base
+   */
+  RnsPoly(const RnsBase& base, const PolyRing& poly);
+
+  /** @brief Build a zero polynomial view on an external buffer
+   *
+   *  @param data buffer of \c{base.size() * FheParams::D} words, it is
+   *    neither copied nor released and must outlive the polynomial
+   *  @param ntt polynomial is considered in NTT form
+   */
+  RnsPoly(const RnsBase& base, mp_limb_t* const data, const bool ntt);
+
+  /** @brief Copy-construct a polynomial
+   *
+   *  The copy owns its residues, even if \c poly is a view.
+   */
+  RnsPoly(const RnsPoly& poly);
+
+  /** @brief Move-construct a polynomial
+   *
+   *  Residues of \c poly are not copied, the new polynomial is a view if
+   *    \c poly was.
+   */
+  RnsPoly(RnsPoly&& poly) noexcept;
+
+  /** @brief Destructs polynomial object
+   */
+  ~RnsPoly();
+
+  /** @brief Assignment operator
+   *
+   *  Both polynomials must be defined on the same RNS base. Residues are
+   *    copied, views stay views.
+   */
+  RnsPoly& operator=(const RnsPoly& poly);
+
+  /** @brief Convert polynomial to a polynomial ring element
+   *
+   *  Coefficients are reconstructed with the CRT and belong to
+   *    interval \c{[0;M)}, or to \c{(-M/2;M/2]} when \c centered is true,
+   *    with \c M the RNS base modulus.
+   *
+   *  @param poly output polynomial ring element
+   *  @param centered use a centered representative for coefficients
+   */
+  void toPolyRing(PolyRing& poly, const bool centered = false) const;
+
+  /** @brief Return a view on the residues of \c poly modulo the first
+   *    primes of its base
+   *
+   *  Primes of \c base must be the first primes of the base of \c poly,
+   *    e.g. a modulus switching level base of a polynomial modulo q. The
+   *    view is in the form of \c poly and must not outlive it.
+   */
+  static RnsPoly prefix(const RnsPoly& poly, const RnsBase& base);
+
+  /** @brief Return a view on reduced residues stored in \c data
+   *
+   *  Unlike the view constructor, residues are kept. \c data is neither
+   *    copied nor released and must outlive the view.
+   */
+  static RnsPoly view(const RnsBase& base, mp_limb_t* const data,
+                      const bool ntt);
+
+  /** @brief Copy the residues of \c src modulo the primes of the base
+   *    of \c dst
+   *
+   *  Primes of the base of \c dst must all be primes of the base of
+   *    \c src, \c dst is set to the form of \c src.
+   */
+  static void project(RnsPoly& dst, const RnsPoly& src);
+
+  /** @brief Copy residues to \c buffer and make the polynomial a view
+   *    on it
+   *
+   *  Previously owned residues are released.
+   */
+  void moveTo(mp_limb_t* const buffer);
+
+  /** @brief Return polynomial RNS base
+   */
+  const RnsBase& getBase() const {
+    return *base;
+  }
+
+  /** @brief Return true if polynomial is in NTT form
+   */
+  bool isNtt() const {
+    return nttForm;
+  }
+
+  /** @brief Transform polynomial to NTT form, if not already
+   *
+   *  RNS base must have NTT tables.
+   */
+  void toNtt();
+
+  /** @brief Transform polynomial back to coefficient form, if not already
+   */
+  void fromNtt();
+
+  /** @brief Reduce residues to \c{[0;p_i)}, if not already
+   */
+  void normalize();
+
+  /** @brief Return the number of limbs (primes) of polynomial RNS base
+   */
+  unsigned int size() const {
+    return base->size();
+  }
+
+  /** @brief Access residues modulo the \c idx-th base prime
+   *
+   *  @remarks Residues might be unreduced, see @c normalize
+   */
+  mp_limb_t* limb(const unsigned int idx) const {
+    assert(idx < size());
+    return data + idx * FheParams::get().D;
+  }
+
+  /** @brief In-place negate polynomial coefficients.
+   *
+   *  Polynomial residues are reduced first.
+   */
+  static void negate(RnsPoly& poly);
+
+  /** @brief In-place add two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c left = \c left + \c right
+   *
+   *  If polynomials are not in the same form a copy of \c right is
+   *    transformed to the form of \c left.
+   */
+  static void add(RnsPoly& left, const RnsPoly& right);
+
+  /** @brief In-place subtract two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c left = \c left - \c right
+   */
+  static void sub(RnsPoly& left, const RnsPoly& right);
+
+  /** @brief Add two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c res = \c left + \c right
+   *
+   *  The result is in the form of \c left, \c res can alias operands.
+   */
+  static void add(RnsPoly& res, const RnsPoly& left, const RnsPoly& right);
+
+  /** @brief Subtract two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c res = \c left - \c right
+   *
+   *  The result is in the form of \c left, \c res can alias operands.
+   */
+  static void sub(RnsPoly& res, const RnsPoly& left, const RnsPoly& right);
+
+  /** @brief Multiply two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c prod = \c left * \c right
+   *
+   *  @remarks \c prod must not alias \c left or \c right
+   */
+  static void multiply(RnsPoly& prod, const RnsPoly& left, const RnsPoly& right);
+
+  /** @brief In-place multiply two polynomials.
+   *
+   *  This function performs the following operation:
+   *    \c left = \c left * \c right
+   *
+   *  For power of two cyclotomic rings the negacyclic product is computed
+   *    with the NTT tables of the base. The result is in the same form
+   *    as \c left was. No transform is needed when both operands are
+   *    in NTT form.
+   */
+  static void multiply(RnsPoly& left, const RnsPoly& right);
+
+  /** @brief In-place multiply each polynomial coefficient by a scalar.
+   */
+  static void multiply(RnsPoly& poly, const fmpz_t t);
+
+  /** @brief Apply a Galois automorphism to a polynomial.
+   *
+   *  This function performs the following operation:
+   *    \c{res(X) = poly(X^k)}
+   *
+   *  In coefficient form it is a signed permutation of coefficients, in
+   *    NTT form a permutation of evaluations (see
+   *    @c Ntt::galoisPermutation). The result is in the form of \c poly.
+   *    Only power of two cyclotomic rings are supported.
+   *
+   *  @param res result polynomial, in the base of \c poly, must not
+   *    alias it
+   *  @param poly polynomial to transform
+   *  @param k Galois element, odd and smaller than \c{2 . FheParams::D}
+   */
+  static void automorphism(RnsPoly& res, const RnsPoly& poly,
+                           const unsigned int k);
+
+  /** @brief Convert polynomial to another RNS base
+   *
+   *  Polynomial \c src coefficients are lifted to centered integers and
+   *    reduced in the destination base of \c conv. The RNS base of \c dst
+   *    is either this base or the concatenation of the base of \c src
+   *    and of this base, in which case residues of \c src are copied.
+   *    The result is in coefficient form.
+   *
+   *  @param dst destination polynomial
+   *  @param src source polynomial, in the source base of \c conv
+   *  @param conv base converter
+   */
+  static void convert(RnsPoly& dst, const RnsPoly& src, const RnsConv& conv);
+
+  /** @brief Multiply each polynomial coefficient with a rational and
+   *    round the result.
+   *
+   *  Coefficients of \c src are multiplied by the \c{t/d} factor of
+   *    \c scale and rounded. The result is stored in \c dst, defined on
+   *    the destination base of \c scale, in coefficient form.
+   *  This function performs the following operation:
+   *    \c{dst = round(src * t/d)}
+   *
+   *  @param dst destination polynomial
+   *  @param src source polynomial, in the source base of \c scale
+   *  @param scale scaling constants
+   */
+  static void multiply_round(RnsPoly& dst, const RnsPoly& src,
+                              const RnsScale& scale);
+};
+
+#endif
@@ -0,0 +1,107 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file thread_pool.hxx
+ *  @brief Process-wide pool of threads for polynomial-level parallelism
+ */
+
+#ifndef __THREAD_POOL_HXX__
+#define __THREAD_POOL_HXX__
+
+#include <functional>
+
+/** @brief Pool of helper threads shared by all FHE operations
+ *
+ *  Loops over independent polynomials or RNS limbs of a single
+ *    homomorphic operation are split with @c parallelFor. The number of
+ *    threads a loop can use is the parallelism width of the calling
+ *    thread, 1 by default, so that loops run sequentially unless the
+ *    caller (e.g. a circuit scheduler which knows that cores are idle)
+ *    raises it. The calling thread takes part in its loops and runs the
+ *    iterations no helper has started, so nested loops and helpers busy
+ *    with other loops never block it.
+ *
+ *  Iterations run on helper threads bound to the @c FheContext of the
+ *    calling thread, with the width of the caller split between the
+ *    iterations running concurrently.
+ *
+ *  The pool has no helper threads until @c resize is called.
+ */
+class ThreadPool {
+  public:
+    /** @brief Set the number of helper threads
+     *
+     *  Current helpers are stopped after the iterations they run, the
+     *    remaining iterations of their loops are run by the calling
+     *    threads. Helpers keep a reference to the context of the last
+     *    loop they ran. It must not be called concurrently with loops.
+     */
+    static void resize(const unsigned int threads);
+
+    /** @brief Return the number of helper threads
+     */
+    static unsigned int size();
+
+    /** @brief Return the parallelism width of the calling thread
+     */
+    static unsigned int width();
+
+    /** @brief Set the parallelism width of the calling thread
+     *
+     *  @param w maximal number of threads, including the calling one,
+     *    running the iterations of a loop, 0 and 1 disable parallelism
+     */
+    static void setWidth(const unsigned int w);
+
+    /** @brief Run \c{fn(i)} for each \c i in \c{[0;n)}
+     *
+     *  Iterations must be independent. The function returns when all
+     *    iterations are done.
+     */
+    static void parallelFor(const unsigned int n,
+                            const std::function<void (unsigned int)>& fn);
+
+    /** @brief Parallelism width of the calling thread for the lifetime
+     *    of the object, the previous width is restored on destruction
+     */
+    class Width {
+      private:
+        unsigned int previous;
+
+      public:
+        Width(const unsigned int w): previous(width()) {
+          setWidth(w);
+        }
+
+        ~Width() {
+          setWidth(previous);
+        }
+
+        Width(const Width&) = delete;
+        Width& operator=(const Width&) = delete;
+    };
+
+  private:
+    /** @brief Hide constructor
+     */
+    ThreadPool() {}
+};
+
+#endif
@@ -19,14 +19,23 @@
 */
 
 /** @file uniform.hxx
- *  @brief Uniform random number generator (uses /dev/urandom).
+ *  @brief Uniform random number generator (ChaCha20 seeded from
+ *    /dev/urandom).
  */
 
 #ifndef __UNIFORM_HXX__
 #define __UNIFORM_HXX__
 
+#include "prg.hxx"
+
 #include <flint/fmpz.h>
 
+/** @brief Uniform random number generator
+ *
+ *  Random numbers are drawn from a per-thread ChaCha20 generator, seeded
+ *    once per thread from \c /dev/urandom. Threads never share generator
+ *    state and no system call is made after seeding.
+ */
 class UniformRng {
   protected:
     /** @brief Initializes uniform RNG.
@@ -41,6 +50,13 @@ class UniformRng {
     } _initializer;
 
   public:
+    /** @brief Return the generator of the calling thread
+     *
+     *  It is built and seeded from \c /dev/urandom on first use in the
+     *    thread. Bulk samplers (see @c RandPolynom) draw from it directly.
+     */
+    static Prg& generator();
+
     /** @brief Sample number from uniform distribution.
      *
      *  This method samples a number \c num uniformly
@@ -72,6 +88,13 @@ class UniformRng {
      */
     static void sample(fmpz_t num, unsigned int bitCnt,
                         unsigned int hammingWeight);
+
+    /** @brief Sample uniform random bytes.
+     *
+     *  @param buff output buffer of \c byteCnt bytes
+     *  @param byteCnt number of bytes to sample
+     */
+    static void sample(unsigned char* const buff, unsigned int byteCnt);
 };
 
 #endif
@@ -0,0 +1,129 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/** @file vec_mod.hxx
+ *  @brief Vectorized modular arithmetic on word-sized residues
+ */
+
+#ifndef __VEC_MOD_HXX__
+#define __VEC_MOD_HXX__
+
+#include <flint/flint.h>
+#include <flint/nmod_vec.h>
+
+/** @brief Modular arithmetic kernels over vectors of residues.
+ *
+ *  Kernels work on vectors of residues modulo a prime \c{p < 2^62}.
+ *    Unless stated otherwise inputs and outputs are in \c{[0;p)}.
+ *    Outputs can alias inputs.
+ *
+ *  AVX2 and AVX-512 implementations are selected at run-time depending on
+ *    the CPU, with a portable scalar fallback.
+ */
+class VecMod {
+  public:
+    /** @brief Kernel implementations
+     */
+    enum Isa { SCALAR, AVX2, AVX512 };
+
+    /** @brief Return the implementation in use
+     */
+    static Isa isa();
+
+    /** @brief Return the name of the implementation in use
+     */
+    static const char* isaName();
+
+    /** @brief Select an implementation
+     *
+     *  The best implementation supported by the CPU is used by default.
+     *    Requesting an unsupported one selects the best supported one
+     *    below it.
+     */
+    static void select(const Isa isa);
+
+    /** @brief \c{res = a + b mod p}
+     */
+    static void add(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b, const slong len, const mp_limb_t p);
+
+    /** @brief \c{res = a - b mod p}
+     */
+    static void sub(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b, const slong len, const mp_limb_t p);
+
+    /** @brief \c{res = -a mod p}
+     */
+    static void neg(mp_limb_t* const res, const mp_limb_t* const a,
+                    const slong len, const mp_limb_t p);
+
+    /** @brief Lazy addition without reduction, \c{res = a + b}
+     *
+     *  Inputs can be unreduced, their sum must not overflow.
+     */
+    static void add_lazy(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b, const slong len);
+
+    /** @brief Lazy subtraction without reduction, \c{res = a + kp - b}
+     *
+     *  @param kp multiple of \c p bigger or equal than elements of \c b
+     */
+    static void sub_lazy(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b, const slong len, const mp_limb_t kp);
+
+
+    /** @brief Lazy reduction, \c{res = a mod p} for \c a in \c{[0;2p)}
+     */
+    static void reduce(mp_limb_t* const res, const mp_limb_t* const a,
+                    const slong len, const mp_limb_t p);
+
+    /** @brief Multiply by a constant, \c{res = c.a mod p}
+     *
+     *  Shoup's multiplication with precomputed \c{floor(c.2^64/p)}.
+     *    Elements of \c a can be any word, thus \c{c = 1} reduces
+     *    unreduced residues.
+     *
+     *  @param c constant in \c{[0;p)}
+     *  @param c_shoup precomputed quotient, see @c shoup
+     */
+    static void scalar_mul(mp_limb_t* const res, const mp_limb_t* const a,
+                    const slong len, const mp_limb_t c, const mp_limb_t c_shoup,
+                    const mp_limb_t p);
+
+    /** @brief Coefficient-wise product, \c{res = a.b mod p}
+     *
+     *  Elements of \c a and \c b can be any word. Vector kernels reduce
+     *    them first and use Barrett's reduction of the product, the
+     *    scalar kernel uses FLINT's @c n_mulmod2_preinv.
+     */
+    static void mul(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b, const slong len, const nmod_t mod);
+
+    /** @brief Shoup precomputed quotient \c{floor(c.2^64/p)}, \c{c < p}
+     */
+    static mp_limb_t shoup(const mp_limb_t c, const mp_limb_t p);
+
+  protected:
+    /** @brief Hide constructor
+     */
+    VecMod() {}
+};
+
+#endif
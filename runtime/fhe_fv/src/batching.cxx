@@ -0,0 +1,110 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+
+#include "batching.hxx"
+#include "fhe_params.hxx"
+
+#include <assert.h>
+#include <flint/ulong_extras.h>
+
+using namespace std;
+
+/** @brief See header for a description
+ */
+bool Batching::isAvailable() {
+  const FheParams& params = FheParams::get();
+
+  const mp_limb_t t = params.T;
+  return params.IsPowerOfTwoCyclotomic and t > 2 and n_is_prime(t) and
+          t % (2 * params.D) == 1;
+}
+
+/** @brief See header for a description
+ */
+Batching::Batching(): ntt(FheParams::get().D, FheParams::get().T) {
+  assert(Batching::isAvailable());
+  const unsigned int D = FheParams::get().D;
+  const unsigned int m = 2 * D;
+  const unsigned int rowSize = D / 2;
+
+  slotIndex.resize(D);
+  unsigned long e = 1;
+  for (unsigned int i = 0; i < rowSize; ++i) {
+    slotIndex[i] = Ntt::evaluationIndex(D, e);
+    slotIndex[rowSize + i] = Ntt::evaluationIndex(D, m - e);
+    e = e * 3 % m;
+  }
+}
+
+/** @brief See header for a description
+ */
+unsigned int Batching::galoisElement(const int steps) {
+  const unsigned int m = 2 * FheParams::get().D;
+  const int rowSize = FheParams::get().D / 2;
+
+  /* 3 has order D/2 modulo 2.D */
+  unsigned int r = ((steps % rowSize) + rowSize) % rowSize;
+  unsigned long k = 1;
+  for (; r > 0; --r) {
+    k = k * 3 % m;
+  }
+  return k;
+}
+
+/** @brief See header for a description
+ */
+unsigned int Batching::galoisElementRows() {
+  return 2 * FheParams::get().D - 1;
+}
+
+/** @brief See header for a description
+ */
+PolyRing Batching::encode(const vector<unsigned int>& values) const {
+  assert(values.size() <= slots());
+
+  vector<mp_limb_t> buf(slots(), 0);
+  for (unsigned int i = 0; i < values.size(); ++i) {
+    buf[slotIndex[i]] = values[i] % ntt.prime();
+  }
+  ntt.inverse(buf.data());
+
+  PolyRing poly;
+  for (unsigned int i = 0; i < slots(); ++i) {
+    poly.setCoeffUi(i, buf[i]);
+  }
+  return poly;
+}
+
+/** @brief See header for a description
+ */
+vector<unsigned int> Batching::decode(const PolyRing& poly) const {
+  vector<mp_limb_t> buf(slots(), 0);
+  for (unsigned int i = 0; i < slots() and i < poly.length(); ++i) {
+    buf[i] = poly.getCoeffUi(i) % ntt.prime();
+  }
+  ntt.forward(buf.data());
+
+  vector<unsigned int> values(slots());
+  for (unsigned int i = 0; i < slots(); ++i) {
+    values[i] = buf[slotIndex[i]];
+  }
+  return values;
+}
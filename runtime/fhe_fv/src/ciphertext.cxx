@@ -20,36 +20,571 @@
 
 #include "fhe_params.hxx"
 #include "ciphertext.hxx"
+#include "batching.hxx"
+#include "checksum.hxx"
+#include "mem_pool.hxx"
+#include "rand_polynom.hxx"
+#include "thread_pool.hxx"
+#include "vec_mod.hxx"
 
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <utility>
 
 using namespace std;
 
 /** @brief See header for a description
  */
 void CipherText::relinearize(CipherText& ctr, const CipherText& EvalKey) {
+  const FheParams& params = FheParams::get();
+
+  checkContext(ctr);
+  checkContext(EvalKey);
   assert(ctr.size() == 3);
 
+  if (ctr.isRns() or EvalKey.isRns()) {
+    CipherText::relinearize_rns(ctr, EvalKey);
+    return;
+  }
+
+  if (ctr.bound > 1) {
+    CipherText::modulo(ctr, params.Q);
+  }
+
+  if (params.RELIN_VERSION == 1) {
+    CipherText::relinearize_v1(ctr, EvalKey);
+    return;
+  }
+
   /* Relinearization version 2 */
   CipherText rlk_cpy(EvalKey);
   CipherText::multiply_by_poly(rlk_cpy, ctr[2]);
-  CipherText::multiply_round(rlk_cpy, 1, FheParams::P);
-  CipherText::modulo(rlk_cpy, FheParams::Q);
+  CipherText::multiply_round(rlk_cpy, 1, params.P);
+  CipherText::modulo(rlk_cpy, params.Q);
 
   ctr.resize(2);
 
   CipherText::add(ctr, rlk_cpy);
-  CipherText::modulo(ctr, FheParams::Q);
+  CipherText::modulo(ctr, params.Q);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::relinearize_rns(CipherText& ctr, const CipherText& EvalKey) {
+  const FheParams& params = FheParams::get();
+
+  if (params.RELIN_VERSION == 1) {
+    CipherText::relinearize_rns_v1(ctr, EvalKey);
+    return;
+  }
+
+  const CipherText* rlk = CipherText::matchRns(ctr, EvalKey, *params.RnsPQ);
+  const FheParams::ModLevel& level = params.ModChain[ctr.modLevel];
+
+  /* Relinearization version 2, evaluation key is usually in NTT form */
+  RnsPoly c2(*level.PQ);
+  RnsPoly::convert(c2, ctr.rns(2), *level.ConvQP);
+  if (level.PQ->hasNtt()) c2.toNtt();
+  ctr.ownRns();
+
+  /* Both key products are independent */
+  ThreadPool::parallelFor(2, [&](unsigned int i) {
+    RnsPoly prod(*level.PQ);
+    RnsPoly tmp(*level.Q);
+    if (ctr.modLevel > 0) {
+      /* key residues modulo the primes of p.q_l */
+      RnsPoly::project(prod, rlk->rns(i));
+      RnsPoly::multiply(prod, c2);
+    } else {
+      prod = c2;
+      RnsPoly::multiply(prod, rlk->rns(i));
+    }
+    prod.fromNtt();
+    RnsPoly::multiply_round(tmp, prod, *level.ScaleP);
+    RnsPoly::add(ctr.rns(i), tmp);
+  });
+
+  ctr.resize(2);
+
+  if (rlk != &EvalKey) delete rlk;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::relinearize_v1(CipherText& ctr, const CipherText& EvalKey) {
+  assert(EvalKey.size() == 2 * FheParams::get().RELIN_DIGITS);
+
+  /* Coefficients of c2 are reduced, in [0;q) */
+  vector<PolyRing> digits;
+  CipherText::decompose(digits, ctr[2]);
+
+  ctr.resize(2);
+  CipherText::switch_key(ctr, digits, EvalKey);
+  CipherText::modulo(ctr, FheParams::get().Q);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::relinearize_rns_v1(CipherText& ctr, const CipherText& EvalKey) {
+  const CipherText* rlk = CipherText::matchRns(ctr, EvalKey, *FheParams::get().RnsQ);
+  assert(rlk->size() == 2 * FheParams::get().RELIN_DIGITS);
+
+  vector<RnsPoly> digits;
+  CipherText::decompose_rns(digits, ctr.rns(2));
+
+  ctr.resize(2);
+  ctr.ownRns();
+  CipherText::switch_key_rns(ctr, digits, *rlk);
+
+  if (rlk != &EvalKey) delete rlk;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::decompose(vector<PolyRing>& digits, const PolyRing& c) {
+  const FheParams& params = FheParams::get();
+
+  const unsigned int w = params.RELIN_BASE_LOG2;
+  fmpz_t d;
+  fmpz_init(d);
+
+  digits.assign(params.RELIN_DIGITS, PolyRing());
+  for (unsigned int i = 0; i < params.RELIN_DIGITS; ++i) {
+    for (unsigned int k = 0; k < c.length(); ++k) {
+      fmpz_fdiv_q_2exp(d, c.getCoeff(k), i * w);
+      fmpz_fdiv_r_2exp(d, d, w);
+      digits[i].setCoeff(k, d);
+    }
+  }
+
+  fmpz_clear(d);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::decompose_rns(vector<RnsPoly>& digits, const RnsPoly& c) {
+  const FheParams& params = FheParams::get();
+
+  /* Below level 0, residues are multiplied by (q/q_k)^-1 instead of
+   *  (q_l/q_k)^-1 as key gadgets have q/q_k factors */
+  const RnsBase& baseQ = c.getBase();
+  const unsigned int D = params.D;
+  const unsigned int w = params.RELIN_BASE_LOG2;
+  const mp_limb_t mask = (UWORD(1) << w) - 1;
+
+  RnsPoly y(c);
+  y.fromNtt();
+  y.normalize();
+
+  digits.clear();
+  digits.reserve(params.RELIN_DIGITS);
+  for (unsigned int i = 0; i < baseQ.size() * params.RELIN_PRIME_DIGITS; ++i) {
+    digits.emplace_back(baseQ);
+  }
+
+  /* Digits of each residue are independent */
+  ThreadPool::parallelFor(baseQ.size(), [&](unsigned int k) {
+    const mp_limb_t p = baseQ.prime(k);
+    const mp_limb_t inv = params.RnsQ->crtFactorInv(k);
+    mp_limb_t* const yk = y.limb(k);
+    VecMod::scalar_mul(yk, yk, D, inv, VecMod::shoup(inv, p), p);
+
+    for (unsigned int j = 0; j < params.RELIN_PRIME_DIGITS; ++j) {
+      RnsPoly& digit = digits[k * params.RELIN_PRIME_DIGITS + j];
+      for (unsigned int l = 0; l < baseQ.size(); ++l) {
+        const mp_limb_t pl = baseQ.prime(l);
+        mp_limb_t* const d = digit.limb(l);
+        for (unsigned int n = 0; n < D; ++n) {
+          const mp_limb_t v = (yk[n] >> (j * w)) & mask;
+          d[n] = v < pl ? v : v % pl;
+        }
+      }
+      if (baseQ.hasNtt()) digit.toNtt();
+    }
+  });
+}
+
+/** @brief See header for a description
+ */
+void CipherText::switch_key(CipherText& ctr, const vector<PolyRing>& digits,
+                            const CipherText& key) {
+  assert(key.size() == 2 * digits.size());
+
+  PolyRing prod;
+  for (unsigned int i = 0; i < digits.size(); ++i) {
+    PolyRing::multiply(prod, digits[i], key[2 * i]);
+    PolyRing::add(ctr[0], prod);
+    PolyRing::multiply(prod, digits[i], key[2 * i + 1]);
+    PolyRing::add(ctr[1], prod);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::switch_key_rns(CipherText& ctr, const vector<RnsPoly>& digits,
+                                const CipherText& key) {
+  assert(key.size() >= 2 * digits.size());
+  const RnsBase& baseQ = ctr.rns(0).getBase();
+
+  /* Digit products are accumulated in NTT form, one accumulator per
+   *  ciphertext polynomial. Below level 0 only the first digits, and key
+   *  residues modulo the first primes, are used */
+  ThreadPool::parallelFor(2, [&](unsigned int k) {
+    RnsPoly acc(baseQ, baseQ.hasNtt());
+    RnsPoly tmp(baseQ);
+    for (unsigned int i = 0; i < digits.size(); ++i) {
+      RnsPoly::multiply(tmp, digits[i], RnsPoly::prefix(key.rns(2 * i + k), baseQ));
+      RnsPoly::add(acc, tmp);
+    }
+    RnsPoly::add(ctr.rns(k), acc);
+  });
+}
+
+/** @brief See header for a description
+ */
+void CipherText::galois_switch(CipherText& res, const CipherText& ct,
+                               const unsigned int k,
+                               const vector<PolyRing>& digits,
+                               const CipherText& GaloisKey) {
+  /* Digits are small, sigma(sum d_i.g_i) = sum sigma(d_i).g_i */
+  vector<PolyRing> sd(digits.size());
+  for (unsigned int i = 0; i < digits.size(); ++i) {
+    PolyRing::automorphism(sd[i], digits[i], k);
+  }
+
+  res.reset(nullptr, 2, ct.modLevel);
+  PolyRing::automorphism(res[0], ct[0], k);
+  res[1] = PolyRing();
+
+  CipherText::switch_key(res, sd, GaloisKey);
+  CipherText::modulo(res, FheParams::get().Q);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::galois_switch_rns(CipherText& res, const CipherText& ct,
+                                   const unsigned int k,
+                                   const vector<RnsPoly>& digits,
+                                   const CipherText& GaloisKey) {
+  const RnsBase& baseQ = ct.rns(0).getBase();
+
+  const CipherText* gk = &GaloisKey;
+  if (not GaloisKey.isRns()) {
+    CipherText* gk_rns = new CipherText(GaloisKey);
+    CipherText::toRns(*gk_rns, *FheParams::get().RnsQ);
+    gk = gk_rns;
+  }
+
+  vector<RnsPoly> sd;
+  sd.reserve(digits.size());
+  for (unsigned int i = 0; i < digits.size(); ++i) {
+    sd.emplace_back(baseQ);
+    RnsPoly::automorphism(sd[i], digits[i], k);
+  }
+
+  res.reset(&baseQ, 2, ct.modLevel);
+  RnsPoly::automorphism(res.rns(0), ct.rns(0), k);
+  res.rns(1) = RnsPoly(baseQ, res.rns(0).isNtt());
+
+  CipherText::switch_key_rns(res, sd, *gk);
+
+  if (gk != &GaloisKey) delete gk;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::apply_galois(CipherText& ct, const unsigned int k,
+                              const CipherText& GaloisKey) {
+  checkContext(ct);
+  checkContext(GaloisKey);
+  assert(ct.size() == 2);
+
+  if (not ct.isRns() and (GaloisKey.isRns() or ct.modLevel > 0)) {
+    CipherText::toRns(ct);
+  }
+
+  CipherText res(0);
+  if (ct.isRns()) {
+    vector<RnsPoly> digits;
+    CipherText::decompose_rns(digits, ct.rns(1));
+    CipherText::galois_switch_rns(res, ct, k, digits, GaloisKey);
+  } else {
+    PolyRing c1(ct[1]);
+    PolyRing::modulo(c1, FheParams::get().Q);
+    vector<PolyRing> digits;
+    CipherText::decompose(digits, c1);
+    CipherText::galois_switch(res, ct, k, digits, GaloisKey);
+  }
+
+  ct = move(res);
+}
+
+/** @brief Find the Galois key of element \c k, exit if there is none
+ */
+static const CipherText& galoisKey(const map<unsigned int, CipherText*>& GaloisKeys,
+                                   const unsigned int k) {
+  map<unsigned int, CipherText*>::const_iterator it = GaloisKeys.find(k);
+  if (it == GaloisKeys.end()) {
+    cerr << "ERROR: no Galois key for element " << k << endl;
+    exit(-1);
+  }
+  return *it->second;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::rotate(CipherText& ct, const int steps,
+                        const map<unsigned int, CipherText*>& GaloisKeys) {
+  /* rows have D/2 slots, rotate to the left by r in [0;D/2) */
+  const int rowSize = FheParams::get().D / 2;
+  unsigned int r = ((steps % rowSize) + rowSize) % rowSize;
+  if (r == 0) return;
+
+  /* Single key switch if a key for this rotation is available */
+  const unsigned int k = Batching::galoisElement(r);
+  if (GaloisKeys.count(k)) {
+    CipherText::apply_galois(ct, k, *GaloisKeys.at(k));
+    return;
+  }
+
+  /* Otherwise compose power of two rotations */
+  for (unsigned int i = 0; r != 0; ++i, r >>= 1) {
+    if (r & 1) {
+      const unsigned int k_i = Batching::galoisElement(1 << i);
+      CipherText::apply_galois(ct, k_i, galoisKey(GaloisKeys, k_i));
+    }
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::rotate_hoisted(vector<CipherText>& res, const CipherText& ct,
+                                const vector<int>& steps,
+                                const map<unsigned int, CipherText*>& GaloisKeys) {
+  checkContext(ct);
+  for (const pair<const unsigned int, CipherText*>& key: GaloisKeys) {
+    checkContext(*key.second);
+  }
+  assert(ct.size() == 2);
+  const bool rns = ct.isRns() or ct.modLevel > 0 or (not GaloisKeys.empty()
+                    and GaloisKeys.begin()->second->isRns());
+  if (rns and not ct.isRns()) {
+    CipherText ct_rns(ct);
+    CipherText::toRns(ct_rns);
+    CipherText::rotate_hoisted(res, ct_rns, steps, GaloisKeys);
+    return;
+  }
+
+  /* Single decomposition of c1, shared by all rotations */
+  vector<RnsPoly> digitsRns;
+  vector<PolyRing> digits;
+  if (rns) {
+    CipherText::decompose_rns(digitsRns, ct.rns(1));
+  } else {
+    PolyRing c1(ct[1]);
+    PolyRing::modulo(c1, FheParams::get().Q);
+    CipherText::decompose(digits, c1);
+  }
+
+  res.clear();
+  res.reserve(steps.size());
+  for (unsigned int i = 0; i < steps.size(); ++i) {
+    const unsigned int k = Batching::galoisElement(steps[i]);
+    res.emplace_back(0);
+
+    if (k == 1 or not GaloisKeys.count(k)) {
+      /* no rotation, or a composed one */
+      res[i] = CipherText(ct);
+      CipherText::rotate(res[i], steps[i], GaloisKeys);
+    } else if (rns) {
+      CipherText::galois_switch_rns(res[i], ct, k, digitsRns, *GaloisKeys.at(k));
+    } else {
+      CipherText::galois_switch(res[i], ct, k, digits, *GaloisKeys.at(k));
+    }
+  }
+}
+
+/** @brief See header for a description
+ */
+const CipherText* CipherText::matchRns(CipherText& ct1, const CipherText& ct2,
+                                        const RnsBase& base) {
+  if (not ct1.isRns() and not ct2.isRns()) return &ct2;
+
+  if (not ct1.isRns()) {
+    CipherText::toRns(ct1);
+  }
+
+  if (not ct2.isRns()) {
+    CipherText* ct2_rns = new CipherText(ct2);
+    CipherText::toRns(*ct2_rns, base);
+    return ct2_rns;
+  }
+
+  return &ct2;
+}
+
+/** @brief See header for a description
+ */
+const CipherText* CipherText::matchLevel(CipherText& ct1, const CipherText& ct2) {
+  CipherText::toRns(ct1);
+  if (ct1.modLevel < ct2.modLevel) {
+    CipherText::mod_switch(ct1, ct2.modLevel);
+  }
+
+  if (ct2.isRns() and ct2.modLevel == ct1.modLevel) return &ct2;
+
+  CipherText* ct2_cpy = new CipherText(ct2);
+  CipherText::toRns(*ct2_cpy);
+  CipherText::mod_switch(*ct2_cpy, ct1.modLevel);
+  return ct2_cpy;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::toRns(CipherText& ct, const RnsBase& base) {
+  assert(ct.polysAllocated);
+  if (ct.isRns()) return;
+
+  ct.allocRns(base, ct.dataPoly.size(), false);
+  for (unsigned int i = 0; i < ct.dataPoly.size(); ++i) {
+    ct.dataRns[i] = RnsPoly(base, *ct.dataPoly[i]);
+    delete ct.dataPoly[i];
+  }
+  ct.dataPoly.clear();
+  ct.rnsBase = &base;
+  ct.bound = 1;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::toRns(CipherText& ct) {
+  CipherText::toRns(ct, *FheParams::get().ModChain[ct.modLevel].Q);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::mod_switch(CipherText& ct, const unsigned int level) {
+  const FheParams& params = FheParams::get();
+
+  assert(level < params.ModChain.size());
+  if (level == ct.modLevel) return;
+
+  if (level < ct.modLevel) {
+    /* Exact multiplication by q_level/q_l */
+    fmpz_t factor;
+    fmpz_init(factor);
+    fmpz_divexact(factor, params.ModChain[level].Q->modulus(),
+                  params.ModChain[ct.modLevel].Q->modulus());
+
+    if (ct.isRns()) {
+      /* residues modulo the added primes are 0 */
+      const bool ntt = ct.isNtt();
+      ct.ownRns();
+      CipherText res(0);
+      res.reset(params.ModChain[level].Q, ct.size(), level);
+      for (unsigned int i = 0; i < ct.size(); ++i) {
+        ct.rns(i).fromNtt();
+        ct.rns(i).normalize();
+        RnsPoly low = RnsPoly::prefix(res.rns(i), *ct.rnsBase);
+        RnsPoly::project(low, ct.rns(i));
+        RnsPoly::multiply(res.rns(i), factor);
+      }
+      ct = move(res);
+      if (ntt) CipherText::toNtt(ct);
+    } else {
+      for (unsigned int i = 0; i < ct.size(); ++i) {
+        PolyRing::multiply(ct[i], factor);
+        PolyRing::modulo(ct[i], params.ModChain[level].Q->modulus());
+      }
+      ct.modLevel = level;
+      ct.bound = 1;
+    }
+
+    fmpz_clear(factor);
+    return;
+  }
+
+  CipherText::toRns(ct);
+  const bool ntt = ct.isNtt();
+  ct.ownRns();
+
+  /* round(c.q_{l+1}/q_l) one prime at a time */
+  while (ct.modLevel < level) {
+    const FheParams::ModLevel& from = params.ModChain[ct.modLevel];
+    CipherText res(0);
+    res.reset(params.ModChain[ct.modLevel + 1].Q, ct.size(), ct.modLevel + 1);
+    for (unsigned int i = 0; i < ct.size(); ++i) {
+      ct.rns(i).fromNtt();
+      ct.rns(i).normalize();
+      RnsPoly::multiply_round(res.rns(i), ct.rns(i), *from.ScaleNext);
+    }
+    ct = move(res);
+  }
+
+  if (ntt) CipherText::toNtt(ct);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::toPolyRing(CipherText& ct) {
+  if (not ct.isRns()) return;
+
+  ct.dataPoly.resize(ct.dataRns.size(), NULL);
+  for (unsigned int i = 0; i < ct.dataRns.size(); ++i) {
+    ct.dataPoly[i] = new PolyRing();
+    ct.dataRns[i].toPolyRing(*ct.dataPoly[i]);
+  }
+  ct.releaseRns();
+  ct.rnsBase = nullptr;
+  ct.bound = 1;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::toNtt(CipherText& ct) {
+  if (not ct.isRns() or not ct.rnsBase->hasNtt()) return;
+
+  /* keys read in NTT form stay in place */
+  if (any_of(ct.dataRns.begin(), ct.dataRns.end(),
+             [](const RnsPoly& poly) { return not poly.isNtt(); })) {
+    ct.ownRns();
+  }
+  for (unsigned int i = 0; i < ct.size(); ++i) {
+    ct.dataRns[i].toNtt();
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::fromNtt(CipherText& ct) {
+  if (any_of(ct.dataRns.begin(), ct.dataRns.end(),
+             [](const RnsPoly& poly) { return poly.isNtt(); })) {
+    ct.ownRns();
+  }
+  for (unsigned int i = 0; i < ct.dataRns.size(); ++i) {
+    ct.dataRns[i].fromNtt();
+  }
 }
 
 /** @brief See header for a description
  */
 void CipherText::modulo(CipherText& ctr, const fmpz_t q) {
+  if (ctr.isRns()) {
+    ctr.ownRns();
+    for (unsigned int i = 0; i < ctr.size(); i++) {
+      ctr.rns(i).normalize();
+    }
+    return;
+  }
+
   for (unsigned int i = 0; i < ctr.size(); i++) {
     PolyRing::modulo(ctr[i], q);
   }
+  ctr.bound = 1;
 }
 
 /** @brief See header for a description
@@ -63,6 +598,8 @@ void CipherText::multiply_round(CipherText& ctr, const unsigned int t, const fmp
 /** @brief See header for a description
  */
 void CipherText::multiply_comp(CipherText& left_ctr, const CipherText& right_ctr) {
+  checkContext(left_ctr);
+  checkContext(right_ctr);
   assert(left_ctr.size() == right_ctr.size());
   
   for (unsigned int i = 0; i < left_ctr.size(); i++) {
@@ -73,7 +610,9 @@ void CipherText::multiply_comp(CipherText& left_ctr, const CipherText& right_ctr
 /** @brief See header for a description
  */
 CipherText::CipherText(unsigned int p_nrPolys):
-    polysAllocated(true) {
+    polysAllocated(true), rnsBase(nullptr), rnsData(nullptr), rnsDataSize(0),
+    context(FheContext::current()), modLevel(0), bound(1),
+    seedModulus(SeedModulus::None) {
 
   dataPoly.resize(p_nrPolys, NULL);
   for (unsigned int i = 0; i < dataPoly.size(); ++i) {
@@ -84,18 +623,155 @@ CipherText::CipherText(unsigned int p_nrPolys):
 /** @brief See header for a description
  */
 CipherText::CipherText(const CipherText& ct):
-    polysAllocated(true) {
+    polysAllocated(true), rnsBase(ct.rnsBase), rnsData(nullptr), rnsDataSize(0),
+    context(ct.context), modLevel(ct.modLevel), bound(ct.bound),
+    seedModulus(SeedModulus::None) {
 
-  dataPoly.resize(ct.size(), NULL);
-  for (unsigned int i = 0; i < dataPoly.size(); ++i) {
-    dataPoly[i] = new PolyRing(ct[i]);
+  if (ct.isRns()) {
+    allocRns(*rnsBase, ct.size(), false);
+    for (unsigned int i = 0; i < dataRns.size(); ++i) {
+      dataRns[i] = ct.rns(i);
+    }
+  } else {
+    dataPoly.resize(ct.size(), NULL);
+    for (unsigned int i = 0; i < dataPoly.size(); ++i) {
+      dataPoly[i] = new PolyRing(ct[i]);
+    }
+  }
+}
+
+/** @brief See header for a description
+ */
+CipherText::CipherText(CipherText&& ct) noexcept:
+    polysAllocated(ct.polysAllocated), dataPoly(move(ct.dataPoly)),
+    rnsBase(ct.rnsBase), dataRns(move(ct.dataRns)), rnsData(ct.rnsData),
+    rnsDataSize(ct.rnsDataSize), mapping(move(ct.mapping)),
+    context(move(ct.context)), modLevel(ct.modLevel), bound(ct.bound),
+    seed(ct.seed), seedModulus(ct.seedModulus) {
+  ct.polysAllocated = true;
+  ct.dataPoly.clear();
+  ct.rnsBase = nullptr;
+  ct.dataRns.clear();
+  ct.rnsData = nullptr;
+  ct.rnsDataSize = 0;
+  ct.modLevel = 0;
+  ct.bound = 1;
+  ct.seedModulus = SeedModulus::None;
+}
+
+/** @brief See header for a description
+ */
+CipherText& CipherText::operator=(CipherText&& ct) noexcept {
+  if (this == &ct) return *this;
+
+  if (polysAllocated) {
+    for (unsigned int i = 0; i < dataPoly.size(); i++) {
+      if (dataPoly[i] != NULL) delete dataPoly[i];
+    }
+  }
+  releaseRns();
+
+  polysAllocated = ct.polysAllocated;
+  dataPoly = move(ct.dataPoly);
+  rnsBase = ct.rnsBase;
+  dataRns = move(ct.dataRns);
+  rnsData = ct.rnsData;
+  rnsDataSize = ct.rnsDataSize;
+  mapping = move(ct.mapping);
+  context = move(ct.context);
+  modLevel = ct.modLevel;
+  bound = ct.bound;
+  seed = ct.seed;
+  seedModulus = ct.seedModulus;
+
+  ct.polysAllocated = true;
+  ct.dataPoly.clear();
+  ct.rnsBase = nullptr;
+  ct.dataRns.clear();
+  ct.rnsData = nullptr;
+  ct.rnsDataSize = 0;
+  ct.modLevel = 0;
+  ct.bound = 1;
+  ct.seedModulus = SeedModulus::None;
+  return *this;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::allocRns(const RnsBase& base, const unsigned int count,
+                          const bool ntt) {
+  assert(dataRns.empty() and rnsData == nullptr);
+  const size_t words = base.size() * FheParams::get().D;
+
+  rnsDataSize = count * words;
+  rnsData = MemPool::allocate(rnsDataSize);
+  dataRns.reserve(count);
+  for (unsigned int i = 0; i < count; ++i) {
+    dataRns.emplace_back(base, rnsData + i * words, ntt);
   }
 }
 
+/** @brief See header for a description
+ */
+void CipherText::releaseRns() {
+  dataRns.clear();
+  releaseRnsData();
+}
+
+/** @brief See header for a description
+ */
+void CipherText::releaseRnsData() {
+  if (mapping) {
+    mapping.reset();
+  } else {
+    MemPool::release(rnsData, rnsDataSize);
+  }
+  rnsData = nullptr;
+  rnsDataSize = 0;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::ownRns() {
+  if (not mapping) return;
+
+  const size_t words = rnsBase->size() * FheParams::get().D;
+  mp_limb_t* buffer = MemPool::allocate(size() * words);
+  for (unsigned int i = 0; i < size(); ++i) {
+    dataRns[i].moveTo(buffer + i * words);
+  }
+  releaseRnsData();
+  rnsData = buffer;
+  rnsDataSize = size() * words;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::reset(const RnsBase* const base, const unsigned int newSize,
+                       const unsigned int newLevel) {
+  if ((rnsBase != base or mapping) and isRns()) {
+    releaseRns();
+    rnsBase = nullptr;
+  }
+  if (rnsBase != base) {
+    /* from PolyRing objects to RNS polynomials */
+    resize(0);
+    allocRns(*base, newSize, false);
+    rnsBase = base;
+  } else {
+    resize(newSize);
+  }
+  context = FheContext::current();
+  modLevel = newLevel;
+  bound = 1;
+}
+
 /** @brief See header for a description
  */
 CipherText::CipherText(const PolyRing& cp0):
-    polysAllocated(true) {
+    polysAllocated(true), rnsBase(nullptr), rnsData(nullptr), rnsDataSize(0),
+    context(FheContext::current()), modLevel(0), bound(1),
+    seedModulus(SeedModulus::None) {
 
   dataPoly.resize(1, NULL);
   dataPoly[0] = new PolyRing(cp0);
@@ -104,7 +780,9 @@ CipherText::CipherText(const PolyRing& cp0):
 /** @brief See header for a description
  */
 CipherText::CipherText(const PolyRing& cp0, const PolyRing& cp1):
-    polysAllocated(true) {
+    polysAllocated(true), rnsBase(nullptr), rnsData(nullptr), rnsDataSize(0),
+    context(FheContext::current()), modLevel(0), bound(1),
+    seedModulus(SeedModulus::None) {
 
   dataPoly.resize(2, NULL);
   dataPoly[0] = new PolyRing(cp0);
@@ -114,7 +792,9 @@ CipherText::CipherText(const PolyRing& cp0, const PolyRing& cp1):
 /** @brief See header for a description
  */
 CipherText::CipherText(PolyRing* const cp0, PolyRing* const cp1):
-    polysAllocated(false) {
+    polysAllocated(false), rnsBase(nullptr), rnsData(nullptr), rnsDataSize(0),
+    context(FheContext::current()), modLevel(0), bound(1),
+    seedModulus(SeedModulus::None) {
 
   dataPoly.resize(2, NULL);
   dataPoly[0] = cp0;
@@ -125,43 +805,92 @@ CipherText::CipherText(PolyRing* const cp0, PolyRing* const cp1):
  */
 CipherText::~CipherText() {
   if (polysAllocated) {
-    for (unsigned int i = 0; i < size(); i++) {
+    for (unsigned int i = 0; i < dataPoly.size(); i++) {
       if (dataPoly[i] != NULL) delete dataPoly[i];
     }
   }
+  releaseRns();
 }
 
 /** @brief See header for a description
  */
 void CipherText::add(CipherText& ct1, const CipherText& ct2) {
+  checkContext(ct1);
+  checkContext(ct2);
   if (ct1.size() < ct2.size()) {
     ct1.resize(ct2.size());
   }
 
+  if (ct1.isRns() or ct2.isRns() or ct1.modLevel != ct2.modLevel) {
+    const CipherText* ct2_rns = CipherText::matchLevel(ct1, ct2);
+    ct1.ownRns();
+    for (unsigned int i = 0; i < ct2_rns->size(); i++) {
+      RnsPoly::add(ct1.rns(i), ct2_rns->rns(i));
+    }
+    if (ct2_rns != &ct2) delete ct2_rns;
+    return;
+  }
+
   for (unsigned int i = 0; i < ct2.size(); i++) {
     PolyRing::add(ct1[i], ct2[i]);
   }
 
-  CipherText::modulo(ct1, FheParams::Q);
+  ct1.bound += ct2.bound;
+  if (ct1.bound > CipherText::MaxLazyBound) {
+    CipherText::modulo(ct1, FheParams::get().Q);
+  }
 }
 
 /** @brief See header for a description
  */
 void CipherText::sub(CipherText& ct1, const CipherText& ct2) {
+  checkContext(ct1);
+  checkContext(ct2);
   if (ct1.size() < ct2.size()) {
     ct1.resize(ct2.size());
   }
 
-  for (unsigned int i = 0; i < ct1.size(); i++) {
+  if (ct1.isRns() or ct2.isRns() or ct1.modLevel != ct2.modLevel) {
+    const CipherText* ct2_rns = CipherText::matchLevel(ct1, ct2);
+    ct1.ownRns();
+    for (unsigned int i = 0; i < ct2_rns->size(); i++) {
+      RnsPoly::sub(ct1.rns(i), ct2_rns->rns(i));
+    }
+    if (ct2_rns != &ct2) delete ct2_rns;
+    return;
+  }
+
+  for (unsigned int i = 0; i < ct2.size(); i++) {
     PolyRing::sub(ct1[i], ct2[i]);
   }
 
-  CipherText::modulo(ct1, FheParams::Q);
+  ct1.bound += ct2.bound;
+  if (ct1.bound > CipherText::MaxLazyBound) {
+    CipherText::modulo(ct1, FheParams::get().Q);
+  }
 }
 
 /** @brief See header for a description
  */
 void CipherText::multiply(CipherText& ct1, const CipherText& ct2, const CipherText& EvalKey) {
+  checkContext(ct1);
+  checkContext(ct2);
+  checkContext(EvalKey);
+  if (ct1.isRns() or ct2.isRns() or ct1.modLevel != ct2.modLevel) {
+    const CipherText* ct2_rns = CipherText::matchLevel(ct1, ct2);
+    const bool ntt = ct1.isNtt();
+
+    /* relinearize before going back to NTT form */
+    CipherText::multiply_rns(ct1, ct1, *ct2_rns);
+    if (ct1.size() == 3) {
+      CipherText::relinearize_rns(ct1, EvalKey);
+    }
+    if (ntt) CipherText::toNtt(ct1);
+
+    if (ct2_rns != &ct2) delete ct2_rns;
+    return;
+  }
+
   /* Multiply ciphertexts */
   CipherText::multiply(ct1, ct2);
 
@@ -171,12 +900,152 @@ void CipherText::multiply(CipherText& ct1, const CipherText& ct2, const CipherTe
   }
 }
 
+/** @brief See header for a description
+ */
+void CipherText::add(CipherText& res, const CipherText& ct1, const CipherText& ct2) {
+  checkContext(ct1);
+  checkContext(ct2);
+  if (&res == &ct1) {
+    CipherText::add(res, ct2);
+    return;
+  }
+  if (&res == &ct2) {
+    CipherText::add(res, ct1);
+    return;
+  }
+
+  if (ct1.rnsBase != ct2.rnsBase or ct1.modLevel != ct2.modLevel or
+      ct1.size() != ct2.size()) {
+    res = CipherText(ct1);
+    CipherText::add(res, ct2);
+    return;
+  }
+
+  res.reset(ct1.rnsBase, ct1.size(), ct1.modLevel);
+  if (ct1.isRns()) {
+    for (unsigned int i = 0; i < ct1.size(); i++) {
+      RnsPoly::add(res.rns(i), ct1.rns(i), ct2.rns(i));
+    }
+    return;
+  }
+
+  for (unsigned int i = 0; i < ct1.size(); i++) {
+    PolyRing::add(res[i], ct1[i], ct2[i]);
+  }
+  res.bound = ct1.bound + ct2.bound;
+  if (res.bound > CipherText::MaxLazyBound) {
+    CipherText::modulo(res, FheParams::get().Q);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::sub(CipherText& res, const CipherText& ct1, const CipherText& ct2) {
+  checkContext(ct1);
+  checkContext(ct2);
+  if (&res == &ct1) {
+    CipherText::sub(res, ct2);
+    return;
+  }
+
+  if (&res == &ct2 or ct1.rnsBase != ct2.rnsBase or
+      ct1.modLevel != ct2.modLevel or ct1.size() != ct2.size()) {
+    CipherText tmp(ct1);
+    CipherText::sub(tmp, ct2);
+    res = move(tmp);
+    return;
+  }
+
+  res.reset(ct1.rnsBase, ct1.size(), ct1.modLevel);
+  if (ct1.isRns()) {
+    for (unsigned int i = 0; i < ct1.size(); i++) {
+      RnsPoly::sub(res.rns(i), ct1.rns(i), ct2.rns(i));
+    }
+    return;
+  }
+
+  for (unsigned int i = 0; i < ct1.size(); i++) {
+    PolyRing::sub(res[i], ct1[i], ct2[i]);
+  }
+  res.bound = ct1.bound + ct2.bound;
+  if (res.bound > CipherText::MaxLazyBound) {
+    CipherText::modulo(res, FheParams::get().Q);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::multiply(CipherText& res, const CipherText& ct1,
+                          const CipherText& ct2, const CipherText& EvalKey) {
+  checkContext(ct1);
+  checkContext(ct2);
+  checkContext(EvalKey);
+  if (&res == &ct1) {
+    CipherText::multiply(res, ct2, EvalKey);
+    return;
+  }
+  if (&res == &ct2) {
+    CipherText::multiply(res, ct1, EvalKey);
+    return;
+  }
+
+  if (not ct1.isRns() or not ct2.isRns() or ct1.modLevel != ct2.modLevel) {
+    res = CipherText(ct1);
+    CipherText::multiply(res, ct2, EvalKey);
+    return;
+  }
+
+  /* relinearize before going back to NTT form */
+  CipherText::multiply_rns(res, ct1, ct2);
+  if (res.size() == 3) {
+    CipherText::relinearize_rns(res, EvalKey);
+  }
+  if (ct1.isNtt()) CipherText::toNtt(res);
+}
+
 /** @brief See header for a description
  */
 void CipherText::multiply(CipherText& ct1, const CipherText& ct2) {
+  const FheParams& params = FheParams::get();
+
+  checkContext(ct1);
+  checkContext(ct2);
+  if (ct1.isRns() or ct2.isRns() or ct1.modLevel != ct2.modLevel) {
+    const CipherText* ct2_rns = CipherText::matchLevel(ct1, ct2);
+    const bool ntt = ct1.isNtt();
+    CipherText::multiply_rns(ct1, ct1, *ct2_rns);
+    if (ntt) CipherText::toNtt(ct1);
+    if (ct2_rns != &ct2) delete ct2_rns;
+    return;
+  }
+
+  /* Reduce operands, unreduced coefficients increase noise */
+  if (ct2.bound > 1) {
+    CipherText ct2_red(ct2);
+    CipherText::modulo(ct2_red, params.Q);
+    CipherText::multiply(ct1, ct2_red);
+    return;
+  }
+  if (ct1.bound > 1) {
+    CipherText::modulo(ct1, params.Q);
+  }
+
   if (ct2.size() == 1) {
     CipherText::multiply_by_poly(ct1, ct2[0]);
   } 
+  else if (ct1.size() == 2 and ct2.size() == 2) {
+    /* Karatsuba: (c0.d0, (c0+c1).(d0+d1) - c0.d0 - c1.d1, c1.d1) */
+    ct1.resize(3);
+    PolyRing::multiply(ct1[2], ct1[1], ct2[1]);
+    PolyRing::add(ct1[1], ct1[0]);
+    PolyRing::multiply(ct1[0], ct2[0]);
+
+    PolyRing d01;
+    PolyRing::add(d01, ct2[0], ct2[1]);
+    PolyRing::multiply(ct1[1], d01);
+    PolyRing::sub(ct1[1], ct1[0]);
+    PolyRing::sub(ct1[1], ct1[2]);
+  }
   else if (ct2.size() >= 2) {
     CipherText ct1_cpy(ct1);
 
@@ -204,11 +1073,86 @@ void CipherText::multiply(CipherText& ct1, const CipherText& ct2) {
   }
 
   if (ct2.size() >= 1) {
-    CipherText::multiply_round(ct1, FheParams::T, FheParams::Q);
-    CipherText::modulo(ct1, FheParams::Q);     
+    CipherText::multiply_round(ct1, params.T, params.Q);
+    CipherText::modulo(ct1, params.Q);     
   }
 }
 
+/** @brief See header for a description
+ */
+void CipherText::multiply_rns(CipherText& res, const CipherText& ct1,
+                              const CipherText& ct2) {
+  assert(&res != &ct2 and ct1.modLevel == ct2.modLevel);
+  const FheParams::ModLevel& level = FheParams::get().ModChain[ct1.modLevel];
+  const RnsBase& baseQB = *level.QB;
+  const bool ntt = baseQB.hasNtt();
+  const unsigned int size1 = ct1.size();
+  const unsigned int size2 = ct2.size();
+
+  /* Lift ciphertexts to the extended base, polynomials are independent
+   *  and so are the products and roundings below */
+  vector<RnsPoly> ext1, ext2, prod;
+  ext1.reserve(size1);
+  for (unsigned int i = 0; i < size1; ++i) {
+    ext1.emplace_back(baseQB);
+  }
+  ext2.reserve(size2);
+  for (unsigned int i = 0; i < size2; ++i) {
+    ext2.emplace_back(baseQB);
+  }
+  ThreadPool::parallelFor(size1 + size2, [&](unsigned int i) {
+    RnsPoly& ext = i < size1 ? ext1[i] : ext2[i - size1];
+    RnsPoly::convert(ext, i < size1 ? ct1.rns(i) : ct2.rns(i - size1),
+                     *level.ConvQB);
+    if (ntt) ext.toNtt();
+  });
+
+  /* Exact tensor product, coefficient-wise in NTT form */
+  prod.reserve(size1 + size2 - 1);
+  if (size1 == 2 and size2 == 2) {
+    /* Karatsuba, extended operands are used as scratch space */
+    RnsPoly mid(baseQB);
+    RnsPoly sum(baseQB);
+    RnsPoly::add(mid, ext1[0], ext1[1]);
+    RnsPoly::add(sum, ext2[0], ext2[1]);
+    ThreadPool::parallelFor(3, [&](unsigned int i) {
+      if (i < 2) {
+        RnsPoly::multiply(ext1[i], ext2[i]);
+      } else {
+        RnsPoly::multiply(mid, sum);
+      }
+    });
+    RnsPoly::sub(mid, ext1[0]);
+    RnsPoly::sub(mid, ext1[1]);
+
+    prod.push_back(move(ext1[0]));
+    prod.push_back(move(mid));
+    prod.push_back(move(ext1[1]));
+  } else {
+    for (unsigned int k = 0; k < size1 + size2 - 1; ++k) {
+      prod.emplace_back(baseQB, ntt);
+    }
+
+    ThreadPool::parallelFor(size1 + size2 - 1, [&](unsigned int k) {
+      RnsPoly tmp(baseQB);
+      for (unsigned int i = k < size2 ? 0 : k - size2 + 1;
+           i < size1 and i <= k; ++i) {
+        RnsPoly::multiply(tmp, ext1[i], ext2[k - i]);
+        RnsPoly::add(prod[k], tmp);
+      }
+    });
+  }
+
+  /* Scale by t/q and round in base b, then convert back to base q */
+  res.reset(level.Q, size1 + size2 - 1, ct1.modLevel);
+  ThreadPool::parallelFor(res.size(), [&](unsigned int k) {
+    RnsPoly scaled(*FheParams::get().RnsB);
+    prod[k].fromNtt();
+    RnsPoly::multiply_round(scaled, prod[k], *level.ScaleT);
+    RnsPoly::convert(res.rns(k), scaled, *level.ConvBQ);
+  });
+}
+
 /** @brief See header for a description
  */
 void CipherText::multiply_by_poly(CipherText& ct1, const PolyRing& p2) {
@@ -217,18 +1161,334 @@ void CipherText::multiply_by_poly(CipherText& ct1, const PolyRing& p2) {
   }
 }
 
+/** @brief See header for a description
+ */
+void CipherText::setSeed(const Prg::Seed& seed_p, const SeedModulus modulus) {
+  seed = seed_p;
+  seedModulus = modulus;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::expandSeed(PolyRing& poly, const Prg::Seed& seed_p,
+                            const unsigned int stream,
+                            const SeedModulus modulus,
+                            const unsigned int level) {
+  assert(modulus != SeedModulus::None);
+  const fmpz* const m = modulus == SeedModulus::PQ ? FheParams::get().PQ :
+    (level > 0 ? FheParams::get().ModChain[level].Q->modulus() : FheParams::get().Q);
+
+  Prg prg(seed_p, stream);
+  fmpz_poly_t tmp;
+  fmpz_poly_init(tmp);
+  RandPolynom::sampleUniform(tmp, FheParams::get().D, m, prg);
+  poly = PolyRing(tmp);
+  fmpz_poly_clear(tmp);
+}
+
+/** @brief See header for a description
+ */
+bool CipherText::seedValid() const {
+  if (seedModulus == SeedModulus::None or isRns() or size() % 2 != 0) {
+    return false;
+  }
+
+  PolyRing poly;
+  for (unsigned int i = 1; i < size(); i += 2) {
+    CipherText::expandSeed(poly, seed, i / 2, seedModulus, modLevel);
+
+    const PolyRing& a = *dataPoly[i];
+    if (a.length() != poly.length()) return false;
+    for (unsigned int k = 0; k < a.length(); ++k) {
+      if (not fmpz_equal(a.getCoeff(k), poly.getCoeff(k))) return false;
+    }
+  }
+  return true;
+}
+
+/** @brief Compact binary format magic, version, flags, RNS base
+ *    identifiers and header size
+ */
+static const unsigned char COMPACT_MAGIC[4] = {'C', 'G', 'C', 'T'};
+static const unsigned char COMPACT_VERSION = 1;
+static const unsigned char COMPACT_CHECKSUM = 1;
+static const unsigned char COMPACT_SIGNED = 2;
+static const unsigned char COMPACT_RNS = 4;
+static const unsigned char COMPACT_NTT = 8;
+static const unsigned char COMPACT_BASE_Q = 1;
+static const unsigned char COMPACT_BASE_PQ = 2;
+static const size_t COMPACT_HEADER_SIZE = 32;
+
+/** @brief Little-endian stores and loads
+ */
+static void store32(unsigned char* const p, const uint32_t v) {
+  for (unsigned int i = 0; i < 4; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void store64(unsigned char* const p, const uint64_t v) {
+  for (unsigned int i = 0; i < 8; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint32_t load32(const unsigned char* const p) {
+  uint32_t v = 0;
+  for (unsigned int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+static uint64_t load64(const unsigned char* const p) {
+  uint64_t v = 0;
+  for (unsigned int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+/** @brief See header for a description
+ */
+bool CipherText::WriteChecksum = true;
+
 /** @brief See header for a description
  */
 void CipherText::read(FILE* const stream, const bool binary) {
+  context = FheContext::current();
+  if (binary) {
+    unsigned char magic[sizeof(COMPACT_MAGIC)];
+    const size_t r = fread(magic, 1, sizeof(magic), stream);
+    if (r == sizeof(magic) and
+        memcmp(magic, COMPACT_MAGIC, sizeof(magic)) == 0) {
+      readCompact(stream);
+      return;
+    }
+    /* legacy binary format */
+    if (fseek(stream, -(long)r, SEEK_CUR) != 0) {
+      cerr << "ERROR: Ciphertext::read cannot read a legacy ciphertext "
+           << "from a non seekable stream" << endl;
+      exit(-1);
+    }
+  }
+  readLegacy(stream, binary);
+}
+
+/** @brief See header for a description
+ */
+void CipherText::readCompact(FILE* const stream) {
+  vector<unsigned char> buff(COMPACT_HEADER_SIZE);
+  memcpy(buff.data(), COMPACT_MAGIC, sizeof(COMPACT_MAGIC));
+  const size_t hr = fread(buff.data() + sizeof(COMPACT_MAGIC), 1,
+                          COMPACT_HEADER_SIZE - sizeof(COMPACT_MAGIC), stream);
+  if (hr != COMPACT_HEADER_SIZE - sizeof(COMPACT_MAGIC)) {
+    cerr << "ERROR: Ciphertext::read truncated ciphertext header" << endl;
+    exit(-1);
+  }
+
+  const size_t total = compactSize(buff.data());
+  buff.resize(total);
+  const size_t r = fread(buff.data() + COMPACT_HEADER_SIZE, 1,
+                         total - COMPACT_HEADER_SIZE, stream);
+  if (r != total - COMPACT_HEADER_SIZE) {
+    cerr << "ERROR: Ciphertext::read truncated ciphertext" << endl;
+    exit(-1);
+  }
+
+  loadCompact(buff.data(), nullptr);
+}
+
+/** @brief Return the RNS base with identifier \c id of modulus level
+ *    \c level in compact containers, \c nullptr if unknown
+ */
+static const RnsBase* compactBase(const unsigned int level,
+                                  const unsigned char id) {
+  const FheParams::ModLevel& modLevel = FheParams::get().ModChain[level];
+  return id == COMPACT_BASE_Q ? modLevel.Q :
+         id == COMPACT_BASE_PQ ? modLevel.PQ : nullptr;
+}
+
+/** @brief See header for a description
+ */
+size_t CipherText::compactSize(const unsigned char* const header) {
+  const FheParams& params = FheParams::get();
+
+  const unsigned char version = header[4];
+  const unsigned char flags = header[5];
+  const SeedModulus modulus = (SeedModulus)header[6];
+  const uint64_t fingerprint = load64(header + 8);
+  const unsigned int level = load32(header + 16);
+  const unsigned int size = load32(header + 20);
+  const unsigned int degree = load32(header + 24);
+  const unsigned int bits = load32(header + 28);
+
+  if (version != COMPACT_VERSION) {
+    cerr << "ERROR: Ciphertext::read unsupported ciphertext format version "
+         << (unsigned int)version << endl;
+    exit(-1);
+  }
+  if (fingerprint != params.Fingerprint or degree != params.D) {
+    cerr << "ERROR: Ciphertext::read ciphertext was written with other "
+         << "FHE parameters" << endl;
+    exit(-1);
+  }
+  if (level >= params.ModChain.size()) {
+    cerr << "ERROR: Ciphertext::read modulus level " << level
+         << " not in the modulus chain" << endl;
+    exit(-1);
+  }
+  if (modulus != SeedModulus::None and modulus != SeedModulus::Q and
+      modulus != SeedModulus::PQ) {
+    cerr << "ERROR: Ciphertext::read unknown seed modulus" << endl;
+    exit(-1);
+  }
+
+  /* seed, packed polynomials or residues, and checksum */
+  size_t dataSize;
+  if (flags & COMPACT_RNS) {
+    const RnsBase* const base = compactBase(level, header[7]);
+    if (base == nullptr or modulus != SeedModulus::None or
+        bits != FLINT_BITS) {
+      cerr << "ERROR: Ciphertext::read RNS ciphertext does not match "
+           << "the RNS parameters" << endl;
+      exit(-1);
+    }
+    dataSize = (size_t)size * base->size() * params.D *
+               sizeof(mp_limb_t);
+  } else {
+    const bool seeded = modulus != SeedModulus::None;
+    const bool sign = flags & COMPACT_SIGNED;
+    const unsigned int packed = seeded ? (size + 1) / 2 : size;
+    dataSize = (seeded ? Prg::SEED_SIZE : 0) +
+               packed * PolyRing::packedSize(bits + sign);
+  }
+  const size_t checksumSize = flags & COMPACT_CHECKSUM ? 8 : 0;
+
+  return COMPACT_HEADER_SIZE + dataSize + checksumSize;
+}
+
+/** @brief See header for a description
+ */
+void CipherText::loadCompact(const unsigned char* const buff,
+                             const shared_ptr<const MappedFile>& file) {
+  const unsigned char flags = buff[5];
+  const SeedModulus modulus = (SeedModulus)buff[6];
+  const unsigned int level = load32(buff + 16);
+  const unsigned int size = load32(buff + 20);
+  const unsigned int bits = load32(buff + 28);
+
+  const size_t checksumSize = flags & COMPACT_CHECKSUM ? 8 : 0;
+  const size_t dataSize = compactSize(buff) - COMPACT_HEADER_SIZE -
+                          checksumSize;
+
+  if (checksumSize > 0 and
+      Checksum::update(buff, COMPACT_HEADER_SIZE + dataSize) !=
+        load64(buff + COMPACT_HEADER_SIZE + dataSize)) {
+    cerr << "ERROR: Ciphertext::read checksum mismatch, ciphertext is "
+         << "corrupted" << endl;
+    exit(-1);
+  }
+
+  const unsigned char* p = buff + COMPACT_HEADER_SIZE;
+
+  if (flags & COMPACT_RNS) {
+    const RnsBase& base = *compactBase(level, buff[7]);
+    const bool ntt = flags & COMPACT_NTT;
+
+    if (isRns()) {
+      releaseRns();
+      rnsBase = nullptr;
+    }
+    this->resize(0);
+
+    if (file) {
+      /* residues are used in place from the read-only mapping,
+       *  ownRns copies them before any modification */
+      const size_t words = base.size() * FheParams::get().D;
+      rnsData = (mp_limb_t*)p;
+      rnsDataSize = 0;
+      mapping = file;
+      dataRns.reserve(size);
+      for (unsigned int i = 0; i < size; ++i) {
+        dataRns.push_back(RnsPoly::view(base, rnsData + i * words, ntt));
+      }
+    } else {
+      allocRns(base, size, ntt);
+      memcpy(rnsData, p, dataSize);
+    }
+    rnsBase = &base;
+    modLevel = level;
+    bound = 1;
+    seedModulus = SeedModulus::None;
+    return;
+  }
+
+  const bool seeded = modulus != SeedModulus::None;
+  const bool sign = flags & COMPACT_SIGNED;
+  const size_t polySize = PolyRing::packedSize(bits + sign);
+
+  if (seeded) {
+    memcpy(seed.data(), p, Prg::SEED_SIZE);
+    p += Prg::SEED_SIZE;
+  }
+
+  CipherText::toPolyRing(*this);
+  this->resize(size);
+  modLevel = level;
+  bound = 1;
+  seedModulus = modulus;
+  for (unsigned int i = 0; i < this->size(); i++) {
+    if (seeded and i % 2 == 1) {
+      CipherText::expandSeed(*dataPoly[i], seed, i / 2, modulus, level);
+    } else {
+      dataPoly[i]->unpack(p, bits, sign);
+      p += polySize;
+    }
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::readLegacy(FILE* const stream, const bool binary) {
   fmpz_t size_fmpz;
   fmpz_init(size_fmpz);
 
   PolyRing::read_fmpz(size_fmpz, stream, binary);
+
+  /* a negative size is followed by the modulus switching level and
+   *  the seed of polynomials at odd positions */
+  unsigned int level = 0;
+  SeedModulus modulus = SeedModulus::None;
+  if (fmpz_sgn(size_fmpz) < 0) {
+    fmpz_neg(size_fmpz, size_fmpz);
+    fmpz_t tmp;
+    fmpz_init(tmp);
+    PolyRing::read_fmpz(tmp, stream, binary);
+    level = fmpz_get_ui(tmp);
+    if (level >= FheParams::get().ModChain.size()) {
+      cerr << "ERROR: Ciphertext::read modulus level " << level
+           << " not in the modulus chain" << endl;
+      exit(-1);
+    }
+
+    PolyRing::read_fmpz(tmp, stream, binary);
+    modulus = (SeedModulus)fmpz_get_ui(tmp);
+    if (modulus != SeedModulus::None) {
+      mp_limb_t limbs[Prg::SEED_SIZE / sizeof(mp_limb_t)];
+      PolyRing::read_fmpz(tmp, stream, binary);
+      fmpz_get_ui_array(limbs, Prg::SEED_SIZE / sizeof(mp_limb_t), tmp);
+      for (unsigned int i = 0; i < Prg::SEED_SIZE; ++i) {
+        seed[i] = limbs[i / sizeof(mp_limb_t)] >> (8 * (i % sizeof(mp_limb_t)));
+      }
+    }
+    fmpz_clear(tmp);
+  }
   unsigned int size = fmpz_get_ui(size_fmpz);
 
+  CipherText::toPolyRing(*this);
   this->resize(size);
+  modLevel = level;
+  bound = 1;
+  seedModulus = modulus;
   for (unsigned int i = 0; i < this->size(); i++) {
-    dataPoly[i]->read(stream, binary);
+    if (modulus != SeedModulus::None and i % 2 == 1) {
+      CipherText::expandSeed(*dataPoly[i], seed, i / 2, modulus, level);
+    } else {
+      dataPoly[i]->read(stream, binary);
+    }
   }
 
   fmpz_clear(size_fmpz);
@@ -237,6 +1497,20 @@ void CipherText::read(FILE* const stream, const bool binary) {
 /** @brief See header for a description
  */
 void CipherText::read(const string& inFileName, const bool binary) {
+  context = FheContext::current();
+  if (binary) {
+    shared_ptr<const MappedFile> file = make_shared<const MappedFile>(inFileName);
+    if (file->valid() and file->size() >= COMPACT_HEADER_SIZE and
+        memcmp(file->data(), COMPACT_MAGIC, sizeof(COMPACT_MAGIC)) == 0) {
+      if (file->size() < compactSize(file->data())) {
+        cerr << "ERROR: Ciphertext::read truncated ciphertext" << endl;
+        exit(-1);
+      }
+      loadCompact(file->data(), file);
+      return;
+    }
+  }
+
   FILE* stream;
 
   stream = fopen(inFileName.c_str(), binary ? "rb" : "r");
@@ -252,14 +1526,105 @@ void CipherText::read(const string& inFileName, const bool binary) {
 /** @brief See header for a description
  */
 void CipherText::write(FILE* const stream, const bool binary) const {
+  if (isRns() or bound > 1) {
+    CipherText ct(*this);
+    CipherText::toPolyRing(ct);
+    CipherText::modulo(ct, modLevel > 0 ?
+      FheParams::get().ModChain[modLevel].Q->modulus() : FheParams::get().Q);
+    ct.write(stream, binary);
+    return;
+  }
+
+  if (binary) {
+    writeCompact(stream);
+  } else {
+    writeLegacy(stream, binary);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::writeCompact(FILE* const stream) const {
+  const bool seeded = seedValid();
+  const unsigned int packed = seeded ? (size() + 1) / 2 : size();
+
+  unsigned int bits = 0;
+  bool sign = false;
+  for (unsigned int i = 0; i < size(); i += seeded ? 2 : 1) {
+    bool negative;
+    bits = max(bits, dataPoly[i]->maxBits(negative));
+    sign = sign or negative;
+  }
+
+  const size_t polySize = PolyRing::packedSize(bits + sign);
+  const size_t dataSize = (seeded ? Prg::SEED_SIZE : 0) + packed * polySize;
+  const size_t checksumSize = WriteChecksum ? 8 : 0;
+  vector<unsigned char> buff(COMPACT_HEADER_SIZE + dataSize + checksumSize);
+
+  unsigned char* p = buff.data();
+  memcpy(p, COMPACT_MAGIC, sizeof(COMPACT_MAGIC));
+  p[4] = COMPACT_VERSION;
+  p[5] = (WriteChecksum ? COMPACT_CHECKSUM : 0) | (sign ? COMPACT_SIGNED : 0);
+  p[6] = (unsigned char)(seeded ? seedModulus : SeedModulus::None);
+  p[7] = 0;
+  store64(p + 8, FheParams::get().Fingerprint);
+  store32(p + 16, modLevel);
+  store32(p + 20, size());
+  store32(p + 24, FheParams::get().D);
+  store32(p + 28, bits);
+  p += COMPACT_HEADER_SIZE;
+
+  if (seeded) {
+    memcpy(p, seed.data(), Prg::SEED_SIZE);
+    p += Prg::SEED_SIZE;
+  }
+
+  for (unsigned int i = 0; i < size(); i += seeded ? 2 : 1) {
+    dataPoly[i]->pack(p, bits, sign);
+    p += polySize;
+  }
+
+  if (WriteChecksum) {
+    store64(p, Checksum::update(buff.data(), p - buff.data()));
+  }
+
+  if (fwrite(buff.data(), 1, buff.size(), stream) != buff.size()) {
+    cerr << "ERROR: Ciphertext::write cannot write ciphertext" << endl;
+    exit(-1);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::writeLegacy(FILE* const stream, const bool binary) const {
+  const bool seeded = seedValid();
+
   fmpz_t size;
   fmpz_init_set_ui(size, this->size());
-  
+
+  if (modLevel > 0 or seeded) {
+    fmpz_neg(size, size);
+    PolyRing::write_fmpz(stream, size, binary);
+    fmpz_set_ui(size, modLevel);
+    PolyRing::write_fmpz(stream, size, binary);
+    fmpz_set_ui(size, (unsigned int)(seeded ? seedModulus : SeedModulus::None));
+    if (seeded) {
+      PolyRing::write_fmpz(stream, size, binary);
+
+      mp_limb_t limbs[Prg::SEED_SIZE / sizeof(mp_limb_t)] = {0};
+      for (unsigned int i = 0; i < Prg::SEED_SIZE; ++i) {
+        limbs[i / sizeof(mp_limb_t)] |=
+          (mp_limb_t)seed[i] << (8 * (i % sizeof(mp_limb_t)));
+      }
+      fmpz_set_ui_array(size, limbs, Prg::SEED_SIZE / sizeof(mp_limb_t));
+    }
+  }
   PolyRing::write_fmpz(stream, size, binary);
-  
+
   for (unsigned int i = 0; i < this->size(); i++) {
+    if (seeded and i % 2 == 1) continue;
     dataPoly[i]->write(stream, binary);
-  }  
+  }
 
   fmpz_clear(size);
 }
@@ -274,12 +1639,97 @@ void CipherText::write(const string& outFileName, const bool binary) const {
   fclose(stream);
 }
 
+/** @brief See header for a description
+ */
+void CipherText::writeRns(FILE* const stream) const {
+  const FheParams& params = FheParams::get();
+
+  assert(isRns());
+  const unsigned char id =
+    rnsBase == params.ModChain[modLevel].Q ? COMPACT_BASE_Q :
+    rnsBase == params.ModChain[modLevel].PQ ? COMPACT_BASE_PQ : 0;
+  if (id == 0) {
+    cerr << "ERROR: Ciphertext::writeRns ciphertext is not in a modulus "
+         << "chain base" << endl;
+    exit(-1);
+  }
+
+  const size_t polySize = rnsBase->size() * params.D * sizeof(mp_limb_t);
+  const size_t dataSize = size() * polySize;
+  const size_t checksumSize = WriteChecksum ? 8 : 0;
+  vector<unsigned char> buff(COMPACT_HEADER_SIZE + dataSize + checksumSize);
+
+  unsigned char* p = buff.data();
+  memcpy(p, COMPACT_MAGIC, sizeof(COMPACT_MAGIC));
+  p[4] = COMPACT_VERSION;
+  p[5] = (WriteChecksum ? COMPACT_CHECKSUM : 0) | COMPACT_RNS |
+         (isNtt() ? COMPACT_NTT : 0);
+  p[6] = (unsigned char)SeedModulus::None;
+  p[7] = id;
+  store64(p + 8, params.Fingerprint);
+  store32(p + 16, modLevel);
+  store32(p + 20, size());
+  store32(p + 24, params.D);
+  store32(p + 28, FLINT_BITS);
+  p += COMPACT_HEADER_SIZE;
+
+  for (unsigned int i = 0; i < size(); i++) {
+    RnsPoly poly(rns(i));
+    poly.normalize();
+    memcpy(p, poly.limb(0), polySize);
+    p += polySize;
+  }
+
+  if (WriteChecksum) {
+    store64(p, Checksum::update(buff.data(), p - buff.data()));
+  }
+
+  if (fwrite(buff.data(), 1, buff.size(), stream) != buff.size()) {
+    cerr << "ERROR: Ciphertext::writeRns cannot write ciphertext" << endl;
+    exit(-1);
+  }
+}
+
+/** @brief See header for a description
+ */
+void CipherText::writeRns(const string& outFileName) const {
+  FILE* stream;
+
+  stream = fopen(outFileName.c_str(), "wb");
+  writeRns(stream);
+  fclose(stream);
+}
+
 
 void CipherText::resize(const int newSize) {
   assert(polysAllocated);
 
   int prevSize = size();
 
+  if (isRns()) {
+    const size_t words = rnsBase->size() * FheParams::get().D;
+    const bool ntt = isNtt();
+
+    if (newSize < prevSize) {
+      dataRns.erase(dataRns.begin() + newSize, dataRns.end());
+    } else if ((size_t)newSize * words > rnsDataSize) {
+      /* move polynomials to a bigger buffer */
+      mp_limb_t* buffer = MemPool::allocate(newSize * words);
+      for (int i = 0; i < prevSize; ++i) {
+        dataRns[i].moveTo(buffer + i * words);
+      }
+      releaseRnsData();
+      rnsData = buffer;
+      rnsDataSize = newSize * words;
+    }
+
+    dataRns.reserve(newSize);
+    for (int i = prevSize; i < newSize; ++i) {
+      dataRns.emplace_back(*rnsBase, rnsData + i * words, ntt);
+    }
+    return;
+  }
+
   if (newSize < prevSize) {
     for (int i = newSize; i < prevSize; ++i) {
       if (dataPoly[i] != NULL) delete dataPoly[i];
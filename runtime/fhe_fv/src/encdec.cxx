@@ -29,6 +29,8 @@
  */
 CipherText EncDec::EncryptPoly(const PolyRing& plainTxt_p, const CipherText& publicKey)
 {
+  const FheParams& params = FheParams::get();
+
   PolyRing plainTxt = ScalePlainTextPoly(plainTxt_p);
 
   CipherText ct(publicKey);
@@ -37,13 +39,13 @@ CipherText EncDec::EncryptPoly(const PolyRing& plainTxt_p, const CipherText& pub
   fmpz_poly_init(tmp);
 
   /* Sample uniform binary and normal distributed polynomials  */
-  RandPolynom::sampleUniformBinary(tmp, FheParams::D);
+  RandPolynom::sampleUniformBinary(tmp, params.D);
   PolyRing u(tmp);
 
-  RandPolynom::sampleNormal(tmp, FheParams::D, FheParams::SIGMA, FheParams::B);
+  RandPolynom::sampleNormal(tmp, params.D, params.SIGMA, params.B);
   PolyRing e1(tmp);
 
-  RandPolynom::sampleNormal(tmp, FheParams::D, FheParams::SIGMA, FheParams::B);
+  RandPolynom::sampleNormal(tmp, params.D, params.SIGMA, params.B);
   PolyRing e2(tmp);
 
   fmpz_poly_clear(tmp);
@@ -54,8 +56,37 @@ CipherText EncDec::EncryptPoly(const PolyRing& plainTxt_p, const CipherText& pub
   /* Add to first cipher-text polynom the plaintext message */
   PolyRing::add(ct[0], plainTxt);
 
-  CipherText::modulo(ct, FheParams::Q);
+  CipherText::modulo(ct, params.Q);
+
+  return ct;
+}
+
+/** @brief See header for description
+ */
+CipherText EncDec::EncryptPoly(const PolyRing& plainTxt, const PolyRing& secretKey)
+{
+  const FheParams& params = FheParams::get();
+
+  Prg::Seed seed;
+  Prg::randomSeed(seed);
 
+  CipherText ct(2);
+  CipherText::expandSeed(ct[1], seed, 0, CipherText::SeedModulus::Q);
+
+  fmpz_poly_t tmp;
+  fmpz_poly_init(tmp);
+  RandPolynom::sampleNormal(tmp, params.D, params.SIGMA, params.B);
+  PolyRing e(tmp);
+  fmpz_poly_clear(tmp);
+
+  /* Compute ct0 = -(a . sk + e) + Delta . m mod q */
+  PolyRing::multiply(ct[0], ct[1], secretKey);
+  PolyRing::add(ct[0], e);
+  PolyRing::negate(ct[0]);
+  PolyRing::add(ct[0], ScalePlainTextPoly(plainTxt));
+  PolyRing::modulo(ct[0], params.Q);
+
+  ct.setSeed(seed, CipherText::SeedModulus::Q);
   return ct;
 }
 
@@ -72,6 +103,15 @@ CipherText EncDec::EncryptPoly(const PolyRing& plainTxt)
  */
 PolyRing EncDec::DecryptPolyAndNoise(const CipherText& cTxt, const PolyRing& secretKey, PolyRing& pNoise)
 {
+  const FheParams& params = FheParams::get();
+
+  /* Lift ciphertexts from lower moduli back to modulus q */
+  if (cTxt.level() > 0) {
+    CipherText ct(cTxt);
+    CipherText::mod_switch(ct, 0);
+    return EncDec::DecryptPolyAndNoise(ct, secretKey, pNoise);
+  }
+
   PolyRing sk(secretKey);
 
   pNoise = PolyRing(cTxt[0]);
@@ -79,7 +119,7 @@ PolyRing EncDec::DecryptPolyAndNoise(const CipherText& cTxt, const PolyRing& sec
     PolyRing tmp(cTxt[i]);
     PolyRing::multiply(tmp, sk);
     PolyRing::add(pNoise, tmp);
-    PolyRing::modulo(pNoise, FheParams::Q);
+    PolyRing::modulo(pNoise, params.Q);
 
     if (i < cTxt.size()-1) {
       PolyRing::multiply(sk, secretKey);
@@ -87,11 +127,11 @@ PolyRing EncDec::DecryptPolyAndNoise(const CipherText& cTxt, const PolyRing& sec
   }
 
   PolyRing pMsg(pNoise);
-  PolyRing::multiply_round(pMsg, FheParams::T, FheParams::Q);
-  PolyRing::modulo(pMsg, FheParams::T);
+  PolyRing::multiply_round(pMsg, params.T, params.Q);
+  PolyRing::modulo(pMsg, params.T);
 
   PolyRing tmp(pMsg);
-  PolyRing::multiply(tmp, FheParams::Delta);
+  PolyRing::multiply(tmp, params.Delta);
   PolyRing::sub(pNoise, tmp);
 
   return pMsg;
@@ -111,8 +151,8 @@ PolyRing EncDec::ScalePlainTextPoly(const PolyRing& plainTxt)
 {
   PolyRing poly(plainTxt);
 
-  PolyRing::modulo(poly, FheParams::T);
-  PolyRing::multiply(poly, FheParams::Delta);
+  PolyRing::modulo(poly, FheParams::get().T);
+  PolyRing::multiply(poly, FheParams::get().Delta);
 
   return poly;
 }
@@ -142,7 +182,8 @@ CipherText EncDec::Encrypt(const unsigned int pTxt)
 unsigned int EncDec::Decrypt(const CipherText& cTxt, const PolyRing& secretKey)
 {
   PolyRing poly = EncDec::DecryptPoly(cTxt, secretKey);
-  return poly.getCoeffUi(0);
+  /* a decrypted 0 is the zero polynomial */
+  return poly.length() > 0 ? poly.getCoeffUi(0) : 0;
 }
 
 /** @brief See header for description
@@ -169,8 +210,8 @@ double EncDec::NoiseDbl(const PolyRing& pNoise)
   for (unsigned int i = 0; i < pNoise.length(); ++i) {
     fmpz* coeff = pNoise.getCoeff(i);
 
-    if (fmpz_cmp(coeff, FheParams::Delta) >= 0)
-      fmpz_sub(coeff, coeff, FheParams::Q);
+    if (fmpz_cmp(coeff, FheParams::get().Delta) >= 0)
+      fmpz_sub(coeff, coeff, FheParams::get().Q);
 
     fmpz_abs(coeff, coeff); //really need this?
 
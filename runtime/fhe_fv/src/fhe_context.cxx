@@ -0,0 +1,44 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "fhe_context.hxx"
+
+using namespace std;
+
+/** @brief See header for description.
+ */
+thread_local shared_ptr<const FheContext> FheContext::bound;
+
+/** @brief See header for description.
+ */
+shared_ptr<const FheContext> FheContext::create(const string& fileName) {
+  shared_ptr<FheContext> context(new FheContext());
+  context->params.parseXml(fileName.c_str());
+  return context;
+}
+
+/** @brief See header for description.
+ */
+void FheContext::bind(const shared_ptr<const FheContext>& context) {
+  FheParams::current = context ? &context->params : &FheParams::Defaults;
+
+  /* the previous context might be released here */
+  bound = context;
+}
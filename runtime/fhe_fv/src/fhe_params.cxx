@@ -19,9 +19,15 @@
 */
 
 #include "fhe_params.hxx"
+#include "checksum.hxx"
+#include "fhe_context.hxx"
+#include "normal.hxx"
 
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
+#include <stdlib.h>
+#include <string.h>
 #include <flint/arith.h>
 #include <pugixml.hpp>
 
@@ -30,75 +36,51 @@ using namespace std;
 
 /** @brief See header for description
  */
-unsigned int FheParams::T;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::Q;
-
-/** @brief See header for description
- */
-unsigned int FheParams::Q_bitsize;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::Delta;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::P;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::PQ;
-
-/** @brief See header for description
- */
-bool FheParams::IsPowerOfTwoCyclotomic;
-
-/** @brief See header for description
- */
-fmpz_poly_t FheParams::PolyRingModulo;
-
-/** @brief See header for description
- */
-fmpz_poly_powers_precomp_t FheParams::PolyRingModuloInv;
-
-/** @brief See header for description
- */
-unsigned int FheParams::D;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::SIGMA;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::B;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::SIGMA_K;
-
-/** @brief See header for description
- */
-fmpz_t FheParams::B_K;
-
-/** @brief See header for description
- */
-unsigned int FheParams::SK_H;
-
-/** @brief See header for description
- */
-unsigned int FheParams::POLY_RW_BASE;
+void FheParams::clearModChain(vector<ModLevel>& chain) {
+  for (unsigned int l = 0; l < chain.size(); ++l) {
+    ModLevel& level = chain[l];
+    delete level.ScaleNext;
+    if (l == 0) continue;
+    delete level.ConvQB;
+    delete level.ConvBQ;
+    delete level.ConvQP;
+    delete level.ScaleT;
+    delete level.ScaleP;
+    delete level.Q;
+    delete level.QB;
+    delete level.PQ;
+  }
+  chain.clear();
+}
 
 /** @brief See header for description
  */
-FheParams::_init::_init() {
+FheParams::FheParams() {
   FheParams::T = 0;
+  FheParams::Q_bitsize = 0;
+  FheParams::IsPowerOfTwoCyclotomic = false;
   FheParams::D = 0;
   FheParams::SK_H = 0;
+  FheParams::RELIN_VERSION = 2;
+  FheParams::RELIN_BASE_LOG2 = 32;
+  FheParams::RELIN_PRIME_DIGITS = 0;
+  FheParams::RELIN_DIGITS = 0;
   FheParams::POLY_RW_BASE = 62; //@todo read it from xml file
+  FheParams::RnsPrimeBitsize = 0;
+
+  FheParams::RnsQ = nullptr;
+  FheParams::RnsP = nullptr;
+  FheParams::RnsB = nullptr;
+  FheParams::RnsQB = nullptr;
+  FheParams::RnsPQ = nullptr;
+  FheParams::RnsConvQB = nullptr;
+  FheParams::RnsConvBQ = nullptr;
+  FheParams::RnsConvQP = nullptr;
+  FheParams::RnsScaleT = nullptr;
+  FheParams::RnsScaleP = nullptr;
+  FheParams::MOD_SWITCH_MULT_BITS = 0;
+  FheParams::MOD_SWITCH_BASE_BITS = 0;
+  FheParams::Fingerprint = 0;
   
   fmpz_init(FheParams::SIGMA);
   fmpz_init(FheParams::B);
@@ -110,11 +92,12 @@ FheParams::_init::_init() {
   fmpz_init(FheParams::Delta);
 
   fmpz_poly_init(FheParams::PolyRingModulo);
+  memset(FheParams::PolyRingModuloInv, 0, sizeof(fmpz_poly_powers_precomp_t));
 }
 
 /** @brief See header for description
  */
-FheParams::_init::~_init() {
+FheParams::~FheParams() {
   fmpz_clear(FheParams::SIGMA);
   fmpz_clear(FheParams::B);
   fmpz_clear(FheParams::SIGMA_K);
@@ -123,10 +106,29 @@ FheParams::_init::~_init() {
   fmpz_clear(FheParams::P);
   fmpz_clear(FheParams::PQ);
   fmpz_clear(FheParams::Delta);
-  
+
+  /* default parameters have no precomputed powers */
   fmpz_poly_clear(FheParams::PolyRingModulo);
-  fmpz_poly_powers_clear(FheParams::PolyRingModuloInv);
+  if (FheParams::D > 0 and not FheParams::IsPowerOfTwoCyclotomic) {
+    fmpz_poly_powers_clear(FheParams::PolyRingModuloInv);
+  }
+
+  clearModChain(FheParams::ModChain);
+  delete FheParams::RnsConvQB;
+  delete FheParams::RnsConvBQ;
+  delete FheParams::RnsConvQP;
+  delete FheParams::RnsScaleT;
+  delete FheParams::RnsScaleP;
+  delete FheParams::RnsQ;
+  delete FheParams::RnsP;
+  delete FheParams::RnsB;
+  delete FheParams::RnsQB;
+  delete FheParams::RnsPQ;
+}
 
+/** @brief See header for description
+ */
+FheParams::_init::~_init() {
   flint_cleanup();
 }
 
@@ -134,6 +136,14 @@ FheParams::_init::~_init() {
  */
 FheParams::_init FheParams::_initializer;
 
+/** @brief See header for description, released before the FLINT cleanup
+ */
+const FheParams FheParams::Defaults;
+
+/** @brief See header for description
+ */
+thread_local const FheParams* FheParams::current = &FheParams::Defaults;
+
 /** @brief Helper functions for XML parsing
  */
 void parseParamsPolyCoeffs(xml_node node, fmpz_poly_t poly) {
@@ -147,15 +157,15 @@ void parseParamsPolyCoeffs(xml_node node, fmpz_poly_t poly) {
 
 /** @brief Helper functions for XML parsing
  */
-void parseParamsPr(xml_node node) {
+void parseParamsPr(FheParams& params, xml_node node) {
   xml_node node1;
 
   node1 = node.child("cyclotomic_polynomial");
   if (not node1.empty() and not node1.child("coeffs").empty()) {
-    parseParamsPolyCoeffs(node1.child("coeffs"), FheParams::PolyRingModulo);
+    parseParamsPolyCoeffs(node1.child("coeffs"), params.PolyRingModulo);
   } else if (not node1.child("index").empty()) {
     unsigned int index = node1.child("index").text().as_uint();
-    arith_cyclotomic_polynomial(FheParams::PolyRingModulo, index);
+    arith_cyclotomic_polynomial(params.PolyRingModulo, index);
   } else {
     cerr << "Error parsing XML params file: " <<
       "no ring modulo polynomial specified" << endl;
@@ -165,29 +175,29 @@ void parseParamsPr(xml_node node) {
 
 /** @brief Helper functions for XML parsing
  */
-void parseParamsPt(xml_node node) {
-  FheParams::T = node.child("coeff_modulo").text().as_uint();
+void parseParamsPt(FheParams& params, xml_node node) {
+  params.T = node.child("coeff_modulo").text().as_uint();
 }
 
 /** @brief Helper functions for XML parsing
  */
-void parseParamsCt(xml_node node) {
+void parseParamsCt(FheParams& params, xml_node node) {
   int r;
 
   if (node.child("coeff_modulo_log2")) {
     unsigned int log2_q = node.child("coeff_modulo_log2").text().as_uint();
-    fmpz_set_ui(FheParams::Q, 2);
-    fmpz_pow_ui(FheParams::Q, FheParams::Q, log2_q);  
-    FheParams::Q_bitsize = log2_q;
+    fmpz_set_ui(params.Q, 2);
+    fmpz_pow_ui(params.Q, params.Q, log2_q);  
+    params.Q_bitsize = log2_q;
   } else {
-    r = fmpz_set_str(FheParams::Q, node.child_value("coeff_modulo"), 10);
+    r = fmpz_set_str(params.Q, node.child_value("coeff_modulo"), 10);
     assert(r == 0);
-    FheParams::Q_bitsize = fmpz_clog_ui(FheParams::Q, 2); 
+    params.Q_bitsize = fmpz_clog_ui(params.Q, 2); 
   }
 
   node = node.child("normal_distribution");
   
-  //r = fmpz_set_str(FheParams::SIGMA, node.child_value("sigma"), 10);
+  //r = fmpz_set_str(params.SIGMA, node.child_value("sigma"), 10);
   // sigma, bound are integers in Cingulata
   string sigma(node.child_value("sigma"));
   string bound(node.child_value("bound"));
@@ -200,51 +210,86 @@ void parseParamsCt(xml_node node) {
   
   
   
-  r = fmpz_set_str(FheParams::SIGMA, int_sigma, 10);
+  r = fmpz_set_str(params.SIGMA, int_sigma, 10);
   assert(r == 0);
 
-  //r = fmpz_set_str(FheParams::B, node.child_value("bound"), 10);
-  r = fmpz_set_str(FheParams::B, int_bound, 10);
+  //r = fmpz_set_str(params.B, node.child_value("bound"), 10);
+  r = fmpz_set_str(params.B, int_bound, 10);
   assert(r == 0);
 }
 
 /** @brief Helper functions for XML parsing
  */
-void parseParamsLi(xml_node node) {
+void parseParamsLi(FheParams& params, xml_node node) {
   int r;
 
+  params.RELIN_VERSION = node.child("version").text().as_uint(2);
+  params.RELIN_BASE_LOG2 =
+    node.child("decomposition_base_log2").text().as_uint(32);
+  if (params.RELIN_VERSION != 1 and params.RELIN_VERSION != 2) {
+    cerr << "Error parsing XML params file: " <<
+      "relinearization version should be 1 or 2" << endl;
+    exit(0);
+  }
+  if (params.RELIN_BASE_LOG2 == 0 or
+      params.RELIN_BASE_LOG2 >= FLINT_BITS) {
+    cerr << "Error parsing XML params file: " <<
+      "decomposition base bit-size should be in [1;" << FLINT_BITS - 1 <<
+      "]" << endl;
+    exit(0);
+  }
+
   if (node.child("coeff_modulo_log2")) {
     unsigned int log2_p = node.child("coeff_modulo_log2").text().as_uint();
-    fmpz_set_ui(FheParams::P, 2);
-    fmpz_pow_ui(FheParams::P, FheParams::P, log2_p);  
+    fmpz_set_ui(params.P, 2);
+    fmpz_pow_ui(params.P, params.P, log2_p);  
   } else {
-    r = fmpz_set_str(FheParams::P, node.child_value("coeff_modulo"), 10);
+    r = fmpz_set_str(params.P, node.child_value("coeff_modulo"), 10);
     assert(r == 0);
   }
 
   node = node.child("normal_distribution");
 
-  //r = fmpz_set_str(FheParams::SIGMA_K, node.child_value("sigma"), 10);
-  r = fmpz_set_str(FheParams::SIGMA_K, node.child_value("sigma_k"), 10);
+  //r = fmpz_set_str(params.SIGMA_K, node.child_value("sigma"), 10);
+  r = fmpz_set_str(params.SIGMA_K, node.child_value("sigma_k"), 10);
 
   assert(r == 0);
 
-  //r = fmpz_set_str(FheParams::B_K, node.child_value("bound"), 10);
-  r = fmpz_set_str(FheParams::B_K, node.child_value("bound_k"), 10);
+  //r = fmpz_set_str(params.B_K, node.child_value("bound"), 10);
+  r = fmpz_set_str(params.B_K, node.child_value("bound_k"), 10);
   assert(r == 0);
 }
 
 /** @brief Helper functions for XML parsing
  */
-void parseParamsSk(xml_node node) {
-  //FheParams::SK_H = node.child("hamming_weight").text().as_uint();
-  FheParams::SK_H = node.child("hamming_weight").text().as_int();
+void parseParamsSk(FheParams& params, xml_node node) {
+  //params.SK_H = node.child("hamming_weight").text().as_uint();
+  params.SK_H = node.child("hamming_weight").text().as_int();
 
 }
 
+/** @brief Helper functions for XML parsing
+ */
+void parseParamsRns(FheParams& params, xml_node node) {
+  if (node.empty()) return;
+
+  params.RnsPrimeBitsize = node.child("prime_bitsize").text().as_uint();
+  if (params.RnsPrimeBitsize >= FLINT_BITS - 2) {
+    cerr << "Error parsing XML params file: " <<
+      "RNS prime bit-size should be smaller than " << FLINT_BITS - 2 << endl;
+    exit(0);
+  }
+}
+
 /** @brief See header for description
  */
 void FheParams::readXml(const char* const fileName) {
+  FheContext::bind(FheContext::create(fileName));
+}
+
+/** @brief See header for description
+ */
+void FheParams::parseXml(const char* const fileName) {
   xml_document doc;
 
   xml_parse_result result = doc.load_file(fileName);
@@ -263,11 +308,12 @@ void FheParams::readXml(const char* const fileName) {
     exit(0);
   }
 
-  parseParamsPr(params.child("polynomial_ring"));
-  parseParamsPt(params.child("plaintext"));
-  parseParamsCt(params.child("ciphertext"));
-  parseParamsLi(params.child("linearization"));
-  parseParamsSk(params.child("secret_key"));
+  parseParamsPr(*this, params.child("polynomial_ring"));
+  parseParamsPt(*this, params.child("plaintext"));
+  parseParamsCt(*this, params.child("ciphertext"));
+  parseParamsLi(*this, params.child("linearization"));
+  parseParamsSk(*this, params.child("secret_key"));
+  parseParamsRns(*this, params.child("rns"));
 
   FheParams::computeParams();
 }
@@ -275,10 +321,6 @@ void FheParams::readXml(const char* const fileName) {
 /** @brief See header for description
  */
 void FheParams::computeParams() {
-  fmpz_mul(FheParams::PQ, FheParams::P, FheParams::Q);
-
-  fmpz_fdiv_q_ui(FheParams::Delta, FheParams::Q, FheParams::T);
-
   /* Cyclotomic polynomial degree */
   FheParams::D = fmpz_poly_degree(FheParams::PolyRingModulo);
 
@@ -286,6 +328,68 @@ void FheParams::computeParams() {
   FheParams::IsPowerOfTwoCyclotomic = 
     FheParams::isPowerOfTwoCyclotomicPolynomial(FheParams::PolyRingModulo);
 
+  if (FheParams::RnsPrimeBitsize > 0) {
+    FheParams::computeRnsParams();
+  } else {
+    clearModChain(FheParams::ModChain);
+    FheParams::ModChain.assign(1, ModLevel());
+  }
+
+  fmpz_mul(FheParams::PQ, FheParams::P, FheParams::Q);
+
+  /* Relinearization version 1 digits, prime-wise in RNS representation */
+  const unsigned int w = FheParams::RELIN_BASE_LOG2;
+  if (FheParams::RnsQ != nullptr) {
+    unsigned int bits = 0;
+    for (unsigned int i = 0; i < FheParams::RnsQ->size(); ++i) {
+      bits = max(bits, (unsigned int)FLINT_BIT_COUNT(FheParams::RnsQ->prime(i)));
+    }
+    FheParams::RELIN_PRIME_DIGITS = (bits + w - 1) / w;
+    FheParams::RELIN_DIGITS = FheParams::RELIN_PRIME_DIGITS * FheParams::RnsQ->size();
+  } else {
+    FheParams::RELIN_DIGITS = (fmpz_bits(FheParams::Q) + w - 1) / w;
+    FheParams::RELIN_PRIME_DIGITS = FheParams::RELIN_DIGITS;
+  }
+
+  fmpz_fdiv_q_ui(FheParams::Delta, FheParams::Q, FheParams::T);
+
+  /* Modulus switching rounding noise is about the secret key 1-norm,
+   *  each multiplication scales noise by about t.D. Relinearization
+   *  version 1 adds noise which does not scale with the modulus, about
+   *  2^w.B.D, which dominates at small moduli. */
+  const unsigned int h = FheParams::SK_H > 0 and FheParams::SK_H < FheParams::D ?
+                          FheParams::SK_H : FheParams::D / 2;
+  FheParams::MOD_SWITCH_BASE_BITS = FLINT_CLOG2(h + 1) + 8;
+  if (FheParams::RELIN_VERSION == 1) {
+    FheParams::MOD_SWITCH_BASE_BITS = max(FheParams::MOD_SWITCH_BASE_BITS,
+        FheParams::RELIN_BASE_LOG2 + (unsigned int)fmpz_bits(FheParams::B) +
+        FLINT_CLOG2(FheParams::D) + 2);
+  }
+  FheParams::MOD_SWITCH_MULT_BITS = FLINT_BIT_COUNT(FheParams::T) +
+                                    FLINT_CLOG2(FheParams::D) + 4;
+
+  /* Parameters fingerprint */
+  string desc = to_string(FheParams::T) + ":" +
+                to_string(FheParams::RnsPrimeBitsize) + ":" +
+                to_string(FheParams::RELIN_VERSION) + ":" +
+                to_string(FheParams::RELIN_BASE_LOG2);
+  const fmpz* const moduli[] = {FheParams::Q, FheParams::P};
+  for (const fmpz* m : moduli) {
+    char* buff = fmpz_get_str(NULL, 16, m);
+    desc = desc + ":" + buff;
+    free(buff);
+  }
+  for (slong i = 0; i < fmpz_poly_length(FheParams::PolyRingModulo); ++i) {
+    char* buff = fmpz_get_str(NULL, 16, FheParams::PolyRingModulo->coeffs + i);
+    desc = desc + (i == 0 ? ":" : ",") + buff;
+    free(buff);
+  }
+  FheParams::Fingerprint = Checksum::update(desc.data(), desc.size());
+
+  /* Noise distribution tables */
+  NormalRng::precompute(FheParams::SIGMA, FheParams::B);
+  NormalRng::precompute(FheParams::SIGMA_K, FheParams::B_K);
+
   /* Precompute the inverse of the cyclotomic polynomial
    *  used in ring modulo reduction if not power of two cyclotomic */
   if (not FheParams::IsPowerOfTwoCyclotomic) {
@@ -294,6 +398,114 @@ void FheParams::computeParams() {
   }
 }
 
+/** @brief Helper function, generates RNS primes such that their product
+ *    bit-size is at most \c bitsize
+ */
+vector<mp_limb_t> generateRnsPrimes(const FheParams& params,
+                                    const unsigned int bitsize,
+                                    const vector<mp_limb_t>& exclude) {
+  unsigned int cnt = (bitsize + params.RnsPrimeBitsize - 1) /
+                      params.RnsPrimeBitsize;
+  return RnsBase::generatePrimes(cnt, bitsize / cnt, 2 * params.D, exclude);
+}
+
+/** @brief See header for description
+ */
+void FheParams::computeRnsParams() {
+  clearModChain(FheParams::ModChain);
+  delete FheParams::RnsConvQB;
+  delete FheParams::RnsConvBQ;
+  delete FheParams::RnsConvQP;
+  delete FheParams::RnsScaleT;
+  delete FheParams::RnsScaleP;
+  delete FheParams::RnsQ;
+  delete FheParams::RnsP;
+  delete FheParams::RnsB;
+  delete FheParams::RnsQB;
+  delete FheParams::RnsPQ;
+
+  /* Ciphertext modulo q */
+  vector<mp_limb_t> primesQ = generateRnsPrimes(*this, fmpz_bits(FheParams::Q) - 1,
+                                                vector<mp_limb_t>());
+  FheParams::RnsQ = new RnsBase(primesQ);
+  fmpz_set(FheParams::Q, FheParams::RnsQ->modulus());
+  FheParams::Q_bitsize = fmpz_clog_ui(FheParams::Q, 2);
+
+  /* Relinearization key modulo factor p */
+  vector<mp_limb_t> primesP = generateRnsPrimes(*this, fmpz_bits(FheParams::P) - 1,
+                                                primesQ);
+  FheParams::RnsP = new RnsBase(primesP);
+  fmpz_set(FheParams::P, FheParams::RnsP->modulus());
+
+  /* Extension base b > 9.t.D.q, used for exact tensoring and rescaling
+   *  (fast conversions may add +-q to centered coefficients) */
+  vector<mp_limb_t> exclude(primesQ);
+  exclude.insert(exclude.end(), primesP.begin(), primesP.end());
+
+  unsigned int bitsizeB = fmpz_bits(FheParams::Q) + FLINT_CLOG2(FheParams::D) +
+                          FLINT_BIT_COUNT(FheParams::T) + 4;
+  unsigned int cntB = (bitsizeB + FheParams::RnsPrimeBitsize - 1) /
+                      FheParams::RnsPrimeBitsize;
+  FheParams::RnsB = new RnsBase(RnsBase::generatePrimes(cntB,
+                          FheParams::RnsPrimeBitsize, 2 * FheParams::D, exclude));
+
+  /* Negacyclic NTT twiddle factors, shared by concatenated bases */
+  if (FheParams::IsPowerOfTwoCyclotomic) {
+    FheParams::RnsQ->initNtt(FheParams::D);
+    FheParams::RnsP->initNtt(FheParams::D);
+    FheParams::RnsB->initNtt(FheParams::D);
+  }
+
+  FheParams::RnsQB = new RnsBase(*FheParams::RnsQ, *FheParams::RnsB);
+  FheParams::RnsPQ = new RnsBase(*FheParams::RnsQ, *FheParams::RnsP);
+
+  /* Word-level base conversions and rescalings */
+  FheParams::RnsConvQB = new RnsConv(*FheParams::RnsQ, *FheParams::RnsB);
+  FheParams::RnsConvBQ = new RnsConv(*FheParams::RnsB, *FheParams::RnsQ);
+  FheParams::RnsConvQP = new RnsConv(*FheParams::RnsQ, *FheParams::RnsP);
+  FheParams::RnsScaleT = new RnsScale(*FheParams::RnsQB, *FheParams::RnsB,
+                                      FheParams::T);
+  FheParams::RnsScaleP = new RnsScale(*FheParams::RnsPQ, *FheParams::RnsQ, 1);
+
+  /* Modulus chain, dropping the last prime of q at each level */
+  const unsigned int L = FheParams::RnsQ->size();
+  FheParams::ModChain.resize(L);
+  FheParams::ModChain[0] = {FheParams::RnsQ, FheParams::RnsQB, FheParams::RnsPQ,
+                            FheParams::RnsConvQB, FheParams::RnsConvBQ,
+                            FheParams::RnsConvQP, FheParams::RnsScaleT,
+                            FheParams::RnsScaleP, nullptr};
+  for (unsigned int l = 1; l < L; ++l) {
+    ModLevel& level = FheParams::ModChain[l];
+    level.Q = new RnsBase(*FheParams::RnsQ, L - l);
+    level.QB = new RnsBase(*level.Q, *FheParams::RnsB);
+    level.PQ = new RnsBase(*level.Q, *FheParams::RnsP);
+    level.ConvQB = new RnsConv(*level.Q, *FheParams::RnsB);
+    level.ConvBQ = new RnsConv(*FheParams::RnsB, *level.Q);
+    level.ConvQP = new RnsConv(*level.Q, *FheParams::RnsP);
+    level.ScaleT = new RnsScale(*level.QB, *FheParams::RnsB, FheParams::T);
+    level.ScaleP = new RnsScale(*level.PQ, *level.Q, 1);
+    level.ScaleNext = nullptr;
+
+    FheParams::ModChain[l - 1].ScaleNext =
+        new RnsScale(*FheParams::ModChain[l - 1].Q, *level.Q, 1);
+  }
+}
+
+/** @brief See header for description
+ */
+unsigned int FheParams::modLevel(const unsigned int depth) {
+  const FheParams& params = FheParams::get();
+  const unsigned int bits = FLINT_BIT_COUNT(params.T) +
+      params.MOD_SWITCH_BASE_BITS + depth * params.MOD_SWITCH_MULT_BITS;
+
+  unsigned int l = 0;
+  while (l + 1 < params.ModChain.size() and
+         fmpz_bits(params.ModChain[l + 1].Q->modulus()) >= bits) {
+    ++l;
+  }
+  return l;
+}
+
 /** @brief See header for description
  */
 bool FheParams::isPowerOfTwoCyclotomicPolynomial(fmpz_poly_t poly) {
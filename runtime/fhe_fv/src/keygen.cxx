@@ -24,9 +24,11 @@
 #include "rand_polynom.hxx"
 #include "polyring.hxx"
 #include "ciphertext.hxx"
+#include "batching.hxx"
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 
 using namespace std;
@@ -35,7 +37,7 @@ void KeyGen::generateSecretKey() {
   fmpz_poly_t tmp;
   fmpz_poly_init(tmp);
 
-  RandPolynom::sampleUniformBinary(tmp, FheParams::D, FheParams::SK_H);
+  RandPolynom::sampleUniformBinary(tmp, FheParams::get().D, FheParams::get().SK_H);
   
   keysAll.SecretKey = new PolyRing(tmp);
 
@@ -43,21 +45,30 @@ void KeyGen::generateSecretKey() {
 }
 
 void KeyGen::generatePublicKey() {
+  const FheParams& params = FheParams::get();
+
   fmpz_poly_t tmp;
   fmpz_poly_init(tmp);
   
   /* Sample a <- Rq and e <- \chi */
-  RandPolynom::sampleUniform(tmp, FheParams::D, FheParams::Q);
-  PolyRing *a = new PolyRing(tmp);
+  Prg::Seed seed;
+  PolyRing *a = new PolyRing();
+  if (seeded) {
+    Prg::randomSeed(seed);
+    CipherText::expandSeed(*a, seed, 0, CipherText::SeedModulus::Q);
+  } else {
+    RandPolynom::sampleUniform(tmp, params.D, params.Q);
+    *a = PolyRing(tmp);
+  }
 
   //RandPolynom::sampleNormal(tmp, FheParams::D, FheParams::SIGMA, FheParams::B);
-  if (FheParams::SK_H == -1)
+  if (params.SK_H == -1)
   {
-        RandPolynom::sampleUniformBinary(tmp, FheParams::D);
+        RandPolynom::sampleUniformBinary(tmp, params.D);
   }
   else
   {
-          RandPolynom::sampleUniformBinary(tmp, FheParams::D, FheParams::SK_H);
+          RandPolynom::sampleUniformBinary(tmp, params.D, params.SK_H);
   }
 
   PolyRing e(tmp);
@@ -67,26 +78,126 @@ void KeyGen::generatePublicKey() {
   PolyRing::multiply(*ct1, *(keysAll.SecretKey));
   PolyRing::add(*ct1, e);
   PolyRing::negate(*ct1);
-  PolyRing::modulo(*ct1, FheParams::Q);
+  PolyRing::modulo(*ct1, params.Q);
 
   /* Store key */
   keysAll.PublicKey = new CipherText(ct1, a);
+  if (seeded) {
+    keysAll.PublicKey->setSeed(seed, CipherText::SeedModulus::Q);
+  }
 
   fmpz_poly_clear(tmp);
 }
 
-void KeyGen::generateEvalKey() {
+CipherText* KeyGen::generateSwitchKey(const PolyRing& target) {
+  const FheParams& params = FheParams::get();
+
   fmpz_poly_t tmp;
   fmpz_poly_init(tmp);
+  fmpz_t g;
+  fmpz_init(g);
+
+  /* One (b_i, a_i) pair per digit, polynomials stored consecutively */
+  CipherText* key = new CipherText(2 * params.RELIN_DIGITS);
+  CipherText& rlk = *key;
+
+  Prg::Seed seed;
+  if (seeded) {
+    Prg::randomSeed(seed);
+    key->setSeed(seed, CipherText::SeedModulus::Q);
+  }
+
+  for (unsigned int i = 0; i < params.RELIN_DIGITS; ++i) {
+    /* Gadget value g_i = w^i, or (q/q_k).w^j in RNS representation */
+    const unsigned int j = i % params.RELIN_PRIME_DIGITS;
+    fmpz_one(g);
+    if (params.RnsQ != nullptr) {
+      fmpz_set(g, params.RnsQ->crtFactor(i / params.RELIN_PRIME_DIGITS));
+    }
+    fmpz_mul_2exp(g, g, j * params.RELIN_BASE_LOG2);
+
+    /* Sample a <- Rq and e <- \chi */
+    if (seeded) {
+      CipherText::expandSeed(rlk[2 * i + 1], seed, i, CipherText::SeedModulus::Q);
+    } else {
+      RandPolynom::sampleUniform(tmp, params.D, params.Q);
+      rlk[2 * i + 1] = PolyRing(tmp);
+    }
+
+    RandPolynom::sampleNormal(tmp, params.D, params.SIGMA, params.B);
+    PolyRing e(tmp);
+
+    /* Compute b = -(a . sk + e) + g . target mod q */
+    PolyRing& b = rlk[2 * i];
+    PolyRing::multiply(b, rlk[2 * i + 1], *(keysAll.SecretKey));
+    PolyRing::add(b, e);
+    PolyRing::negate(b);
+
+    PolyRing target_g(target);
+    PolyRing::multiply(target_g, g);
+    PolyRing::add(b, target_g);
+    PolyRing::modulo(b, params.Q);
+  }
+
+  fmpz_clear(g);
+  fmpz_poly_clear(tmp);
+
+  return key;
+}
+
+void KeyGen::generateEvalKeyV1() {
+  PolyRing sk2(*(keysAll.SecretKey));
+  PolyRing::square(sk2);
+
+  keysAll.EvalKey = generateSwitchKey(sk2);
+}
+
+void KeyGen::generateGaloisKeys() {
+  const PolyRing& sk = *(keysAll.SecretKey);
+
+  /* Power of two rotations of slot rows, and the row swap */
+  vector<unsigned int> elements;
+  for (unsigned int r = 1; r < FheParams::get().D / 2; r <<= 1) {
+    elements.push_back(Batching::galoisElement(r));
+  }
+  elements.push_back(Batching::galoisElementRows());
+
+  for (unsigned int i = 0; i < elements.size(); ++i) {
+    const unsigned int k = elements[i];
+    if (keysAll.GaloisKeys.count(k)) continue;
+
+    PolyRing sk_k;
+    PolyRing::automorphism(sk_k, sk, k);
+    PolyRing::modulo(sk_k, FheParams::get().Q);
+    keysAll.GaloisKeys[k] = generateSwitchKey(sk_k);
+  }
+}
+
+void KeyGen::generateEvalKey() {
+  const FheParams& params = FheParams::get();
 
   /* Re-linearization version 1 evaluation key */
+  if (params.RELIN_VERSION == 1) {
+    generateEvalKeyV1();
+    return;
+  }
+
+  fmpz_poly_t tmp;
+  fmpz_poly_init(tmp);
 
   /* Re-linearization version 2 evaluation key */  
   /* Sample a <- Rpq and e <- \chi */
-  RandPolynom::sampleUniform(tmp, FheParams::D, FheParams::PQ);
-  PolyRing *a = new PolyRing(tmp);
+  Prg::Seed seed;
+  PolyRing *a = new PolyRing();
+  if (seeded) {
+    Prg::randomSeed(seed);
+    CipherText::expandSeed(*a, seed, 0, CipherText::SeedModulus::PQ);
+  } else {
+    RandPolynom::sampleUniform(tmp, params.D, params.PQ);
+    *a = PolyRing(tmp);
+  }
   
-  RandPolynom::sampleNormal(tmp, FheParams::D, FheParams::SIGMA_K, FheParams::B_K);
+  RandPolynom::sampleNormal(tmp, params.D, params.SIGMA_K, params.B_K);
   PolyRing e(tmp);
 
   /* Compute ct1 = -(a . sk + e) */
@@ -98,22 +209,29 @@ void KeyGen::generateEvalKey() {
   /* Compute ct1 += p . sk^2 mod p.q */
   PolyRing sk_copy(*(keysAll.SecretKey));
   PolyRing::square(sk_copy);
-  PolyRing::multiply(sk_copy, FheParams::P);
+  PolyRing::multiply(sk_copy, params.P);
   PolyRing::add(*ct1, sk_copy);  
-  PolyRing::modulo(*ct1, FheParams::PQ);
+  PolyRing::modulo(*ct1, params.PQ);
   
   /* Store key */
   keysAll.EvalKey = new CipherText(ct1, a);
+  if (seeded) {
+    keysAll.EvalKey->setSeed(seed, CipherText::SeedModulus::PQ);
+  }
 
   fmpz_poly_clear(tmp);
 }
 
-void KeyGen::generateKeys() {
+void KeyGen::generateKeys(const bool galois) {
   generateSecretKey();
   generatePublicKey();
   generateEvalKey();
+  if (galois) {
+    generateGaloisKeys();
+  }
 }
 
-void KeyGen::writeKeys(const string& fileNamePrefix, const bool binary) {
-  keysAll.writeKeys(fileNamePrefix, binary);
+void KeyGen::writeKeys(const string& fileNamePrefix, const bool binary,
+                       const bool rns) {
+  keysAll.writeKeys(fileNamePrefix, binary, rns);
 }
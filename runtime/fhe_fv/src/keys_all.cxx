@@ -33,6 +33,7 @@ KeysAll::~KeysAll() {
 /** @brief See header for a description
  */
 void KeysAll::readSecretKey(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
   if (SecretKey != NULL) {
     delete SecretKey;
   }
@@ -60,6 +61,7 @@ void KeysAll::readSecretKey(const string& fileName, const bool binary) {
 /** @brief See header for a description
  */
 void KeysAll::writeSecretKey(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
   if (SecretKey != NULL) {
     SecretKey->write(stream, binary);
   }
@@ -75,14 +77,15 @@ void KeysAll::readKeys(const string& fileNamePrefix, const bool binary) {
 
 /** @brief See header for a description
  */
-void KeysAll::writeKeys(const string& fileNamePrefix, const bool binary) {
+void KeysAll::writeKeys(const string& fileNamePrefix, const bool binary,
+                        const bool rns) {
   FILE* stream;
 
   stream = fopen((fileNamePrefix + ".sk").c_str(), binary ? "wb" : "w");
   writeSecretKey(stream, binary);
   fclose(stream);
 
-  KeysShare::writeKeys(fileNamePrefix, binary);
+  KeysShare::writeKeys(fileNamePrefix, binary, rns);
 }
 
 
@@ -19,6 +19,7 @@
 */
 
 
+#include <assert.h>
 #include <iostream>
 #include <string>
 
@@ -27,16 +28,43 @@
 using namespace std;
 
 
+/** @brief Helper function, transforms a key once to RNS base \c base
+ *    and NTT form, keys read in RNS form must already be in this base
+ */
+static void prepareKey(CipherText& key, const RnsBase* const base,
+                       const char* const name) {
+  if (base == nullptr) return;
+  if (key.isRns() and &key.rns(0).getBase() != base) {
+    cerr << "ERROR: " << name << " key was written in another RNS base"
+         << endl;
+    exit(-1);
+  }
+  CipherText::toRns(key, *base);
+  CipherText::toNtt(key);
+}
+
+/** @brief Helper function, RNS base of evaluation keys, \c nullptr
+ *    without RNS representation. Version 1 keys are modulo q, version
+ *    2 ones modulo p.q
+ */
+static const RnsBase* evalKeyBase() {
+  return FheParams::get().RELIN_VERSION == 1 ? FheParams::get().RnsQ : FheParams::get().RnsPQ;
+}
+
 /** @brief See header for a description
  */
 KeysShare::~KeysShare() {
   delete PublicKey;
   delete EvalKey;
+  for (auto& key : GaloisKeys) {
+    delete key.second;
+  }
 }
 
 /** @brief See header for a description
  */
 void KeysShare::readPublicKey(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
   if (PublicKey != NULL) {
     delete PublicKey;
   }
@@ -48,44 +76,73 @@ void KeysShare::readPublicKey(FILE* const stream, const bool binary) {
 /** @brief See header for a description
  */
 void KeysShare::readPublicKey(const string& fileName, const bool binary) {
-  FILE* stream;
-
-  stream = fopen(fileName.c_str(), binary ? "rb" : "r");
-
-  if (stream == NULL) {
-    cout << "Cannot open public key file: '" << fileName << "'" << endl;
-    exit(-1);
+  FheContext::Scope scope(Context);
+  if (PublicKey != NULL) {
+    delete PublicKey;
   }
 
-  readPublicKey(stream, binary);
-  fclose(stream);
+  PublicKey = new CipherText();
+  PublicKey->read(fileName, binary);
 }
 
 /** @brief See header for a description
  */
 void KeysShare::readEvalKey(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
   if (EvalKey != NULL) {
-    delete PublicKey;
+    delete EvalKey;
   }
   
   EvalKey = new CipherText();
-  EvalKey->read(stream);
+  EvalKey->read(stream, binary);
+
+  /* Transform evaluation key once, it is used by each relinearization */
+  prepareKey(*EvalKey, evalKeyBase(), "evaluation");
 }
 
 /** @brief See header for a description
  */
 void KeysShare::readEvalKey(const string& fileName, const bool binary) {
-  FILE* stream;
+  FheContext::Scope scope(Context);
+  if (EvalKey != NULL) {
+    delete EvalKey;
+  }
+
+  /* keys written in RNS form are used in place from the file mapping */
+  EvalKey = new CipherText();
+  EvalKey->read(fileName, binary);
 
-  stream = fopen(fileName.c_str(), binary ? "rb" : "r");
+  prepareKey(*EvalKey, evalKeyBase(), "evaluation");
+}
 
-  if (stream == NULL) {
-    cout << "Cannot open evaluation key file: '" << fileName << "'" << endl;
-    exit(-1);
+/** @brief See header for a description
+ */
+void KeysShare::readGaloisKeys(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
+  for (auto& key : GaloisKeys) {
+    delete key.second;
   }
+  GaloisKeys.clear();
 
-  readEvalKey(stream, binary);
-  fclose(stream);
+  fmpz_t tmp;
+  fmpz_init(tmp);
+
+  PolyRing::read_fmpz(tmp, stream, binary);
+  const unsigned int count = fmpz_get_ui(tmp);
+
+  for (unsigned int i = 0; i < count; ++i) {
+    PolyRing::read_fmpz(tmp, stream, binary);
+    const unsigned int k = fmpz_get_ui(tmp);
+
+    CipherText* key = new CipherText();
+    key->read(stream, binary);
+
+    /* Galois keys are modulo q, like version 1 evaluation keys */
+    prepareKey(*key, FheParams::get().RnsQ, "Galois");
+    GaloisKeys[k] = key;
+  }
+
+  fmpz_clear(tmp);
 }
 
 /** @brief See header for a description
@@ -93,11 +150,18 @@ void KeysShare::readEvalKey(const string& fileName, const bool binary) {
 void KeysShare::readKeys(const string& fileNamePrefix, const bool binary) {
   readPublicKey(fileNamePrefix + ".pk", binary);
   readEvalKey(fileNamePrefix + ".evk", binary);
+
+  FILE* stream = fopen((fileNamePrefix + ".gk").c_str(), binary ? "rb" : "r");
+  if (stream != NULL) {
+    readGaloisKeys(stream, binary);
+    fclose(stream);
+  }
 }
 
 /** @brief See header for a description
  */
 void KeysShare::writePublicKey(FILE* const stream, const bool binary) {
+  FheContext::Scope scope(Context);
   if (PublicKey != NULL) {
     PublicKey->write(stream, binary);
   }
@@ -105,15 +169,50 @@ void KeysShare::writePublicKey(FILE* const stream, const bool binary) {
 
 /** @brief See header for a description
  */
-void KeysShare::writeEvalKey(FILE* const stream, const bool binary) {
-  if (EvalKey != NULL) {
+void KeysShare::writeEvalKey(FILE* const stream, const bool binary,
+                             const bool rns) {
+  FheContext::Scope scope(Context);
+  if (EvalKey == NULL) return;
+
+  if (rns) {
+    assert(binary and evalKeyBase() != nullptr);
+    CipherText key(*EvalKey);
+    prepareKey(key, evalKeyBase(), "evaluation");
+    key.writeRns(stream);
+  } else {
     EvalKey->write(stream, binary);
   }
 }
 
 /** @brief See header for a description
  */
-void KeysShare::writeKeys(const string& fileNamePrefix, const bool binary) {
+void KeysShare::writeGaloisKeys(FILE* const stream, const bool binary,
+                                const bool rns) {
+  FheContext::Scope scope(Context);
+  fmpz_t tmp;
+  fmpz_init_set_ui(tmp, GaloisKeys.size());
+  PolyRing::write_fmpz(stream, tmp, binary);
+
+  for (const auto& key : GaloisKeys) {
+    fmpz_set_ui(tmp, key.first);
+    PolyRing::write_fmpz(stream, tmp, binary);
+    if (rns) {
+      assert(binary and FheParams::get().RnsQ != nullptr);
+      CipherText rnsKey(*key.second);
+      prepareKey(rnsKey, FheParams::get().RnsQ, "Galois");
+      rnsKey.writeRns(stream);
+    } else {
+      key.second->write(stream, binary);
+    }
+  }
+
+  fmpz_clear(tmp);
+}
+
+/** @brief See header for a description
+ */
+void KeysShare::writeKeys(const string& fileNamePrefix, const bool binary,
+                          const bool rns) {
   FILE* stream;
 
   stream = fopen((fileNamePrefix + ".pk").c_str(), binary ? "wb" : "w");
@@ -121,7 +220,13 @@ void KeysShare::writeKeys(const string& fileNamePrefix, const bool binary) {
   fclose(stream);
 
   stream = fopen((fileNamePrefix + ".evk").c_str(), binary ? "wb" : "w");
-  writeEvalKey(stream, binary);
+  writeEvalKey(stream, binary, rns);
   fclose(stream);
+
+  if (not GaloisKeys.empty()) {
+    stream = fopen((fileNamePrefix + ".gk").c_str(), binary ? "wb" : "w");
+    writeGaloisKeys(stream, binary, rns);
+    fclose(stream);
+  }
 }
 
@@ -0,0 +1,56 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+
+#include "mapped_file.hxx"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/** @brief See header for description.
+ */
+MappedFile::MappedFile(const string& fileName): buff(nullptr), length(0) {
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd == -1) return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 and st.st_size > 0) {
+    /* read-only mapping: pages stay shared with the page cache */
+    void* const ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED) {
+      buff = (const unsigned char*)ptr;
+      length = st.st_size;
+      madvise(ptr, length, MADV_WILLNEED);
+    }
+  }
+  close(fd);
+}
+
+/** @brief See header for description.
+ */
+MappedFile::~MappedFile() {
+  if (buff != nullptr) {
+    munmap((void*)buff, length);
+  }
+}
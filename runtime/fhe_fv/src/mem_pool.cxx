@@ -0,0 +1,95 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "mem_pool.hxx"
+
+#include <stdlib.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+  /** @brief Free lists of a thread, one per buffer size
+   */
+  struct Slab {
+    vector<pair<size_t, vector<mp_limb_t*>>> bins;
+
+    ~Slab();
+
+    vector<mp_limb_t*>& bin(const size_t words) {
+      for (auto& b : bins) {
+        if (b.first == words) return b.second;
+      }
+      bins.emplace_back(words, vector<mp_limb_t*>());
+      bins.back().second.reserve(MemPool::MaxCached);
+      return bins.back().second;
+    }
+  };
+
+  thread_local Slab slab;
+
+  /** @brief Buffers released after the thread slab destruction (e.g. by
+   *    static objects) are returned to the system
+   */
+  thread_local bool slabAlive = true;
+
+  Slab::~Slab() {
+    slabAlive = false;
+    for (auto& b : bins) {
+      for (mp_limb_t* ptr : b.second) free(ptr);
+    }
+  }
+}
+
+/** @brief See header for a description
+ */
+mp_limb_t* MemPool::allocate(const size_t words) {
+  if (slabAlive) {
+    vector<mp_limb_t*>& b = slab.bin(words);
+    if (not b.empty()) {
+      mp_limb_t* ptr = b.back();
+      b.pop_back();
+      return ptr;
+    }
+  }
+
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, 64, (words > 0 ? words : 1) * sizeof(mp_limb_t))) {
+    throw bad_alloc();
+  }
+  return (mp_limb_t*)ptr;
+}
+
+/** @brief See header for a description
+ */
+void MemPool::release(mp_limb_t* const ptr, const size_t words) {
+  if (ptr == nullptr) return;
+
+  if (slabAlive) {
+    vector<mp_limb_t*>& b = slab.bin(words);
+    if (b.size() < MaxCached) {
+      b.push_back(ptr);
+      return;
+    }
+  }
+  free(ptr);
+}
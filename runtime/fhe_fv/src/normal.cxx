@@ -22,89 +22,220 @@
 #include "uniform.hxx"
 
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 #include <gmp.h>
 
-/** @brief See header for description.
+using namespace std;
+
+/** @brief Per-thread \c gmp PRNG state, seeded from @c UniformRng
  */
-gmp_randstate_t NormalRng::randstate;
+struct GmpRandState {
+  gmp_randstate_t state;
+
+  GmpRandState() {
+    gmp_randinit_mt(state);
+
+    fmpz_t seed;
+    fmpz_init(seed);
+    UniformRng::sample(seed, 8 * Prg::SEED_SIZE);
+
+    mpz_t seed1;
+    mpz_init(seed1);
+    fmpz_get_mpz(seed1, seed);
+
+    gmp_randseed(state, seed1);
+
+    fmpz_clear(seed);
+    mpz_clear(seed1);
+  }
+
+  ~GmpRandState() {
+    gmp_randclear(state);
+    mpfr_free_cache();
+  }
+};
 
 /** @brief See header for description.
  */
-void NormalRng::init() {
-  gmp_randinit_lc_2exp_size(randstate, 64);
-
-  fmpz_t seed;
-  fmpz_init(seed);
-  UniformRng::sample(seed, 64);
+std::deque<NormalRng::Cdt> NormalRng::tables;
 
-  mpz_t seed1;
-  mpz_init(seed1);
-  fmpz_get_mpz(seed1, seed);  
-  
-  gmp_randseed(randstate, seed1);
+/** @brief See header for description.
+ */
+std::mutex NormalRng::tablesLock;
 
-  fmpz_clear(seed);
-  mpz_clear(seed1);
+/** @brief Uniform double in \c{[0;1)} with 53 random bits
+ */
+static inline double uniform53(Prg& prg) {
+  return ldexp((double)(prg.next() >> 11), -53);
 }
 
 /** @brief See header for description.
  */
-NormalRng::_init::_init() {
-  NormalRng::init();
+void NormalRng::precompute(const fmpz_t sigma, const fmpz_t B) {
+  if (not fmpz_fits_si(sigma) or not fmpz_fits_si(B) or
+      fmpz_sgn(sigma) < 0 or fmpz_sgn(B) < 0) return;
+
+  const slong s = fmpz_get_si(sigma);
+  const slong bound = fmpz_get_si(B);
+  if (s > (slong)CDT_MAX_SIZE) return;
+
+  /* rho(k)/rho(0) < 2^-64 beyond sigma.sqrt(128.ln(2)) */
+  slong size = s == 0 ? 0 : (slong)ceil(s * sqrt(128 * log(2.0))) + 1;
+  if (size > bound) size = bound;
+  if (size > (slong)CDT_MAX_SIZE) return;
+
+  Cdt cdt;
+  cdt.sigma = s;
+  cdt.bound = bound;
+  cdt.cdf.resize(size);
+
+  /* P(0) = rho(0)/S and P(|x| = k) = 2.rho(k)/S, the last magnitude
+   *  (size) takes the remaining probability */
+  vector<long double> rho(size + 1);
+  long double sum = 0;
+  for (slong k = 0; k <= size; ++k) {
+    rho[k] = expl(-(long double)(k * k) / (2.0L * s * s));
+    sum += (k == 0 ? 1 : 2) * rho[k];
+  }
+
+  long double cum = 0;
+  for (slong k = 0; k < size; ++k) {
+    cum += (k == 0 ? 1 : 2) * rho[k] / sum;
+    const long double c = ldexpl(cum, 64);
+    cdt.cdf[k] = c >= ldexpl(1, 64) ? UINT64_MAX : (uint64_t)c;
+  }
+
+  lock_guard<mutex> lock(tablesLock);
+  for (const Cdt& t : tables) {
+    if (t.sigma == s and t.bound == bound) return;
+  }
+  tables.push_back(cdt);
 }
 
 /** @brief See header for description.
  */
-NormalRng::_init::~_init() {
-  gmp_randclear(randstate);
-  mpfr_free_cache();
+const NormalRng::Cdt* NormalRng::findTable(const fmpz_t sigma,
+                                           const fmpz_t B) {
+  lock_guard<mutex> lock(tablesLock);
+  for (const Cdt& t : tables) {
+    if (fmpz_cmp_si(sigma, t.sigma) == 0 and fmpz_cmp_si(B, t.bound) == 0) {
+      return &t;
+    }
+  }
+  return nullptr;
 }
 
 /** @brief See header for description.
  */
-NormalRng::_init NormalRng::_initializer;
-
+void NormalRng::sample(fmpz* const nums, const unsigned int cnt,
+                       const Cdt& cdt) {
+  const unsigned int batch = 64;
+  uint64_t r[batch];
+  uint64_t mag[batch];
+  Prg& prg = UniformRng::generator();
+
+  for (unsigned int i = 0; i < cnt; i += batch) {
+    const unsigned int m = min(batch, cnt - i);
+    prg.bytes((unsigned char*)r, m * sizeof(uint64_t));
+    const uint64_t signs = prg.next();
+
+    /* table-wise scan, vectorized over the batch */
+    for (unsigned int j = 0; j < m; ++j) mag[j] = 0;
+    for (const uint64_t c : cdt.cdf) {
+      for (unsigned int j = 0; j < m; ++j) {
+        mag[j] += (r[j] >= c);
+      }
+    }
+
+    for (unsigned int j = 0; j < m; ++j) {
+      const uint64_t neg = (signs >> j) & 1;
+      fmpz_set_si(nums + i + j, (slong)((mag[j] ^ -neg) + neg));
+    }
+  }
+}
 
 /** @brief See header for description.
  */
 void NormalRng::sample(mpfr_t mpfr_num, mpfr_t mpfr_sigma) {
-  mpfr_grandom(mpfr_num, NULL, randstate, MPFR_RNDNA);
+  thread_local GmpRandState randstate;
 
-  mpfr_mul(mpfr_num, mpfr_num, mpfr_sigma, MPFR_RNDNA);  
-}
+  mpfr_grandom(mpfr_num, NULL, randstate.state, MPFR_RNDNA);
 
+  mpfr_mul(mpfr_num, mpfr_num, mpfr_sigma, MPFR_RNDNA);
+}
 
 /** @brief See header for description.
  */
 void NormalRng::sample(fmpz_t num_p, const fmpz_t sigma_p, const fmpz_t B) {
+  if (fmpz_bits(B) <= DOUBLE_MAX_BITS or findTable(sigma_p, B) != nullptr) {
+    NormalRng::sample(num_p, 1, sigma_p, B);
+    return;
+  }
+
   mpz_t sigma, num;
 
   mpz_init(sigma);
   fmpz_get_mpz(sigma, sigma_p);
 
   mpz_init(num);
-  
-  int prec = fmpz_sizeinbase(B, 2) + 2; 
+
+  int prec = fmpz_sizeinbase(B, 2) + 2;
 
   mpfr_t mpfr_num;
   mpfr_init2(mpfr_num, prec);
 
   mpfr_t mpfr_sigma;
   mpfr_init(mpfr_sigma);
-  mpfr_set_z(mpfr_sigma, sigma, MPFR_RNDNA);  
+  mpfr_set_z(mpfr_sigma, sigma, MPFR_RNDNA);
 
-  NormalRng::sample(mpfr_num, mpfr_sigma);
-
-  mpfr_get_z(num, mpfr_num, MPFR_RNDNA);
+  do {
+    NormalRng::sample(mpfr_num, mpfr_sigma);
+    mpfr_get_z(num, mpfr_num, MPFR_RNDNA);
+    fmpz_set_mpz(num_p, num);
+  } while (fmpz_cmpabs(num_p, B) > 0);
 
   mpfr_clear(mpfr_num);
   mpfr_clear(mpfr_sigma);
 
-  fmpz_set_mpz(num_p, num);
-
   mpz_clear(sigma);
   mpz_clear(num);
 }
 
-
+/** @brief See header for description.
+ */
+void NormalRng::sample(fmpz* const nums, const unsigned int cnt,
+                       const fmpz_t sigma, const fmpz_t B) {
+  const Cdt* const cdt = findTable(sigma, B);
+  if (cdt != nullptr) {
+    NormalRng::sample(nums, cnt, *cdt);
+    return;
+  }
+
+  if (fmpz_bits(B) > DOUBLE_MAX_BITS) {
+    for (unsigned int i = 0; i < cnt; ++i) {
+      NormalRng::sample(nums + i, sigma, B);
+    }
+    return;
+  }
+
+  const double s = fmpz_get_d(sigma);
+  const slong bound = fmpz_get_si(B);
+  Prg& prg = UniformRng::generator();
+
+  /* Box-Muller transform, two samples per pair of uniforms */
+  unsigned int i = 0;
+  while (i < cnt) {
+    const double u1 = 1.0 - uniform53(prg);
+    const double u2 = uniform53(prg);
+    const double r = s * sqrt(-2.0 * log(u1));
+    const double z[2] = { r * cos(2.0 * M_PI * u2), r * sin(2.0 * M_PI * u2) };
+
+    for (unsigned int k = 0; k < 2 and i < cnt; ++k) {
+      const slong x = lround(z[k]);
+      if (x >= -bound and x <= bound) {
+        fmpz_set_si(nums + i++, x);
+      }
+    }
+  }
+}
@@ -0,0 +1,203 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "ntt.hxx"
+#include "vec_mod.hxx"
+
+#include <assert.h>
+#include <flint/longlong.h>
+#include <flint/ulong_extras.h>
+
+using namespace std;
+
+namespace {
+  /** @brief Shoup quotient \c{floor(w.2^64/p)}, \c w must be smaller than \c p
+   */
+  inline mp_limb_t shoup(const mp_limb_t w, const mp_limb_t p) {
+    mp_limb_t q, r;
+    udiv_qrnnd(q, r, w, 0, p);
+    (void) r;
+    return q;
+  }
+
+  /** @brief Lazy Shoup modular multiplication, result in \c{[0;2p)}
+   */
+  inline mp_limb_t mulmod_shoup_lazy(const mp_limb_t x, const mp_limb_t w,
+                  const mp_limb_t w_shoup, const mp_limb_t p) {
+    mp_limb_t q, lo;
+    umul_ppmm(q, lo, x, w_shoup);
+    (void) lo;
+    return x * w - q * p;
+  }
+
+  /** @brief Reverse the \c bits least significant bits of \c x
+   */
+  inline unsigned int bit_reverse(unsigned int x, const unsigned int bits) {
+    unsigned int r = 0;
+    for (unsigned int i = 0; i < bits; ++i, x >>= 1) {
+      r = (r << 1) | (x & 1);
+    }
+    return r;
+  }
+}
+
+/** @brief See header for a description
+ */
+Ntt::Ntt(const unsigned int n_p, const mp_limb_t p): n(n_p) {
+  assert(n > 0 and (n & (n - 1)) == 0);
+  assert((p - 1) % (2 * n) == 0 and (p >> 62) == 0);
+
+  nmod_init(&mod, p);
+  logn = FLINT_CLOG2(n);
+
+  /* primitive 2n-th root of unity */
+  const mp_limb_t g = n_primitive_root_prime(p);
+  const mp_limb_t psi = n_powmod2_preinv(g, (p - 1) / (2 * n), p, mod.ninv);
+  const mp_limb_t psi_inv = n_invmod(psi, p);
+
+  psiPow.resize(n);
+  psiPowShoup.resize(n);
+  psiInvPow.resize(n);
+  psiInvPowShoup.resize(n);
+
+  mp_limb_t w = 1, w_inv = 1;
+  for (unsigned int i = 0; i < n; ++i) {
+    const unsigned int idx = bit_reverse(i, logn);
+    psiPow[idx] = w;
+    psiPowShoup[idx] = shoup(w, p);
+    psiInvPow[idx] = w_inv;
+    psiInvPowShoup[idx] = shoup(w_inv, p);
+
+    w = n_mulmod2_preinv(w, psi, p, mod.ninv);
+    w_inv = n_mulmod2_preinv(w_inv, psi_inv, p, mod.ninv);
+  }
+
+  nInv = n_invmod(n, p);
+  nInvShoup = shoup(nInv, p);
+}
+
+/** @brief See header for a description
+ */
+void Ntt::forward(mp_limb_t* const a) const {
+  const mp_limb_t p = mod.n;
+  const mp_limb_t p2 = 2 * p;
+
+  /* Cooley-Tukey butterflies, values are kept in [0;4p) */
+  for (unsigned int m = 1, t = n >> 1; m < n; m <<= 1, t >>= 1) {
+    for (unsigned int i = 0; i < m; ++i) {
+      const mp_limb_t w = psiPow[m + i];
+      const mp_limb_t w_shoup = psiPowShoup[m + i];
+      mp_limb_t* x = a + 2 * i * t;
+      mp_limb_t* y = x + t;
+
+      for (unsigned int j = 0; j < t; ++j) {
+        mp_limb_t u = x[j];
+        if (u >= p2) u -= p2;
+        const mp_limb_t v = mulmod_shoup_lazy(y[j], w, w_shoup, p);
+        x[j] = u + v;
+        y[j] = u - v + p2;
+      }
+    }
+  }
+
+  for (unsigned int j = 0; j < n; ++j) {
+    mp_limb_t u = a[j];
+    if (u >= p2) u -= p2;
+    if (u >= p) u -= p;
+    a[j] = u;
+  }
+}
+
+/** @brief See header for a description
+ */
+void Ntt::inverse(mp_limb_t* const a) const {
+  const mp_limb_t p = mod.n;
+  const mp_limb_t p2 = 2 * p;
+
+  /* Gentleman-Sande butterflies, values are kept in [0;2p) */
+  for (unsigned int h = n >> 1, t = 1; h > 0; h >>= 1, t <<= 1) {
+    for (unsigned int i = 0; i < h; ++i) {
+      const mp_limb_t w = psiInvPow[h + i];
+      const mp_limb_t w_shoup = psiInvPowShoup[h + i];
+      mp_limb_t* x = a + 2 * i * t;
+      mp_limb_t* y = x + t;
+
+      for (unsigned int j = 0; j < t; ++j) {
+        const mp_limb_t u = x[j];
+        const mp_limb_t v = y[j];
+        mp_limb_t s = u + v;
+        if (s >= p2) s -= p2;
+        x[j] = s;
+        y[j] = mulmod_shoup_lazy(u - v + p2, w, w_shoup, p);
+      }
+    }
+  }
+
+  for (unsigned int j = 0; j < n; ++j) {
+    mp_limb_t u = mulmod_shoup_lazy(a[j], nInv, nInvShoup, p);
+    if (u >= p) u -= p;
+    a[j] = u;
+  }
+}
+
+/** @brief See header for a description
+ */
+void Ntt::multiply(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b) const {
+  VecMod::mul(res, a, b, n, mod);
+}
+
+/** @brief See header for a description
+ */
+unsigned int Ntt::evaluationIndex(const unsigned int n, const unsigned int e) {
+  assert(e % 2 == 1 and e < 2 * n);
+  return bit_reverse((e - 1) / 2, FLINT_CLOG2(n));
+}
+
+/** @brief See header for a description
+ */
+vector<unsigned int> Ntt::galoisPermutation(const unsigned int n,
+                                            const unsigned int k) {
+  assert(k % 2 == 1 and k < 2 * n);
+  const unsigned int logn = FLINT_CLOG2(n);
+
+  /* Index i holds the evaluation in psi^(2.brv(i)+1) */
+  vector<unsigned int> perm(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    const unsigned int e = (2UL * bit_reverse(i, logn) + 1) * k % (2 * n);
+    perm[i] = bit_reverse((e - 1) / 2, logn);
+  }
+  return perm;
+}
+
+/** @brief See header for a description
+ */
+void Ntt::convolve(mp_limb_t* const res, const mp_limb_t* const a,
+                    const mp_limb_t* const b) const {
+  vector<mp_limb_t> tmp(b, b + n);
+  if (res != a) {
+    copy(a, a + n, res);
+  }
+
+  forward(res);
+  forward(tmp.data());
+  multiply(res, res, tmp.data());
+  inverse(res);
+}
@@ -21,6 +21,8 @@
 #include "polyring.hxx"
 #include "fhe_params.hxx"
 
+#include <algorithm>
+#include <assert.h>
 #include <iostream>
 #include <sstream>
 #include <stdlib.h>
@@ -36,7 +38,7 @@ void PolyRing::write_fmpz(FILE* const stream, fmpz_t d, const bool binary) {
   if (binary) {
     fmpz_out_raw(stream, d);
   } else {
-    char* buff = fmpz_get_str(NULL, FheParams::POLY_RW_BASE, d);
+    char* buff = fmpz_get_str(NULL, FheParams::get().POLY_RW_BASE, d);
     fprintf(stream, "%s\n", buff);
     free(buff);
   }
@@ -50,7 +52,7 @@ void PolyRing::read_fmpz(fmpz_t d, FILE* const stream, const bool binary) {
   } else {
     char* buff;
     fscanf(stream, "%ms", &buff);
-    fmpz_set_str(d, buff, FheParams::POLY_RW_BASE);
+    fmpz_set_str(d, buff, FheParams::get().POLY_RW_BASE);
     free(buff);
   }
 }
@@ -58,14 +60,14 @@ void PolyRing::read_fmpz(fmpz_t d, FILE* const stream, const bool binary) {
 /** @brief See header for a description
  */
 PolyRing::PolyRing() {
-  fmpz_poly_init2(this->polyData, FheParams::D);
+  fmpz_poly_init2(this->polyData, FheParams::get().D);
 }
 
 /** @brief See header for a description
  */
 PolyRing::PolyRing(fmpz_poly_t poly, bool copy) {
   if (copy) {
-    fmpz_poly_init2(this->polyData, FheParams::D);
+    fmpz_poly_init2(this->polyData, FheParams::get().D);
     fmpz_poly_set(this->polyData, poly);
   } else {
     *(this->polyData) = *poly;
@@ -76,17 +78,26 @@ PolyRing::PolyRing(fmpz_poly_t poly, bool copy) {
 /** @brief See header for a description
  */
 PolyRing::PolyRing(const PolyRing& prElem) {
-  fmpz_poly_init2(this->polyData, FheParams::D);
+  fmpz_poly_init2(this->polyData, FheParams::get().D);
   fmpz_poly_set(this->polyData, prElem.polyData);
 }
 
+/** @brief See header for a description
+ */
+PolyRing::PolyRing(PolyRing&& prElem) {
+  fmpz_poly_init(this->polyData);
+  fmpz_poly_swap(this->polyData, prElem.polyData);
+}
+
 /**
  * @brief See header for a description
  */
 PolyRing::PolyRing(const vector<unsigned int>& poly_coeff) {
-  fmpz_poly_init2(this->polyData, FheParams::D);
+  const FheParams& params = FheParams::get();
+
+  fmpz_poly_init2(this->polyData, params.D);
   unsigned int n = poly_coeff.size();
-  if (n > FheParams::D) n = FheParams::D;
+  if (n > params.D) n = params.D;
   for (unsigned int i = 0; i < n; ++i) {
     fmpz_poly_set_coeff_ui(this->polyData, i, poly_coeff[i]);
   }
@@ -134,22 +145,36 @@ void PolyRing::sub(PolyRing& left, const PolyRing& right) {
   fmpz_poly_sub(left.polyData, left.polyData, right.polyData);
 }
 
+/** @brief See header for a description
+ */
+void PolyRing::add(PolyRing& res, const PolyRing& left, const PolyRing& right) {
+  fmpz_poly_add(res.polyData, left.polyData, right.polyData);
+}
+
+/** @brief See header for a description
+ */
+void PolyRing::sub(PolyRing& res, const PolyRing& left, const PolyRing& right) {
+  fmpz_poly_sub(res.polyData, left.polyData, right.polyData);
+}
+
 /** @brief See header for a description
  */
 void PolyRing::reduce(PolyRing& prElem) {
-  if (FheParams::IsPowerOfTwoCyclotomic) {
+  const FheParams& params = FheParams::get();
+
+  if (params.IsPowerOfTwoCyclotomic) {
     /* Use simplified modulo operation for
      *  power of two cyclotomic polynomials */
-    if (prElem.length() > FheParams::D) {
+    if (prElem.length() > params.D) {
       _fmpz_vec_sub(prElem.polyData->coeffs,
                     prElem.polyData->coeffs,
-                    prElem.polyData->coeffs + FheParams::D,
-                    prElem.length() - FheParams::D);
-      fmpz_poly_truncate(prElem.polyData, FheParams::D);
+                    prElem.polyData->coeffs + params.D,
+                    prElem.length() - params.D);
+      fmpz_poly_truncate(prElem.polyData, params.D);
     }
   } else {
     fmpz_poly_rem_powers_precomp(prElem.polyData, prElem.polyData,
-        FheParams::PolyRingModulo, FheParams::PolyRingModuloInv);
+        params.PolyRingModulo, params.PolyRingModuloInv);
   }
 }
 
@@ -169,9 +194,8 @@ void PolyRing::multiply(PolyRing& result, const PolyRing& left,
 /** @brief See header for a description
  */
 void PolyRing::multiply(PolyRing& result, const PolyRing& right) {
-  PolyRing prod;
-  PolyRing::multiply(prod, result, right);
-  result = prod;
+  /* FLINT handles aliased operands */
+  PolyRing::multiply(result, result, right);
 }
 
 /** @brief See header for a description
@@ -221,6 +245,34 @@ void PolyRing::square(PolyRing& prElem) {
   reduce(prElem);
 }
 
+/** @brief See header for a description
+ */
+void PolyRing::automorphism(PolyRing& res, const PolyRing& poly, const unsigned int k) {
+  const FheParams& params = FheParams::get();
+
+  assert(params.IsPowerOfTwoCyclotomic);
+  assert(k % 2 == 1 and k < 2 * params.D);
+  assert(&res != &poly);
+
+  const unsigned long D = params.D;
+  fmpz_t c;
+  fmpz_init(c);
+
+  fmpz_poly_zero(res.polyData);
+  for (unsigned long j = 0; j < poly.length(); ++j) {
+    /* X^(j.k) = -X^(j.k - D) modulo X^D + 1 */
+    const unsigned long e = j * k % (2 * D);
+    if (e < D) {
+      fmpz_set(c, poly.getCoeff(j));
+    } else {
+      fmpz_neg(c, poly.getCoeff(j));
+    }
+    fmpz_poly_set_coeff_fmpz(res.polyData, e % D, c);
+  }
+
+  fmpz_clear(c);
+}
+
 /** @brief See header for a description
  */
 PolyRing& PolyRing::operator=(const PolyRing& prElem) {
@@ -230,6 +282,13 @@ PolyRing& PolyRing::operator=(const PolyRing& prElem) {
   return *this;
 }
 
+/** @brief See header for a description
+ */
+PolyRing& PolyRing::operator=(PolyRing&& prElem) {
+  fmpz_poly_swap(this->polyData, prElem.polyData);
+  return *this;
+}
+
 /** @brief See header for a description
  */
 void PolyRing::read(FILE* const stream, const bool binary) {
@@ -265,6 +324,171 @@ void PolyRing::write(FILE* const stream, const bool binary) const {
   fmpz_clear(d);
 }
 
+/** @brief Mask of the \c bits low bits, \c{bits <= 64}
+ */
+static inline uint64_t lowMask(const unsigned int bits) {
+  return bits == 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;
+}
+
+/** @brief Little-endian bit stream writer, by 64-bit words
+ */
+class BitWriter {
+  unsigned char* out;
+  uint64_t acc;
+  unsigned int cnt;
+
+  void store() {
+    for (unsigned int i = 0; i < 8; ++i) *out++ = (unsigned char)(acc >> (8 * i));
+  }
+
+public:
+  BitWriter(unsigned char* const buff): out(buff), acc(0), cnt(0) {}
+
+  /** @brief Append the \c bits low bits of \c v, \c{bits <= 64}
+   */
+  void put(uint64_t v, const unsigned int bits) {
+    if (bits == 0) return;
+    v &= lowMask(bits);
+    acc |= v << cnt;
+    if (cnt + bits >= 64) {
+      store();
+      acc = cnt == 0 ? 0 : v >> (64 - cnt);
+      cnt = cnt + bits - 64;
+    } else {
+      cnt += bits;
+    }
+  }
+
+  /** @brief Write the last partial word
+   */
+  void flush() {
+    if (cnt > 0) store();
+    acc = 0;
+    cnt = 0;
+  }
+};
+
+/** @brief Little-endian bit stream reader, see @c BitWriter
+ */
+class BitReader {
+  const unsigned char* in;
+  uint64_t acc;
+  unsigned int cnt;
+
+  uint64_t load() {
+    uint64_t w = 0;
+    for (unsigned int i = 0; i < 8; ++i) w |= (uint64_t)*in++ << (8 * i);
+    return w;
+  }
+
+public:
+  BitReader(const unsigned char* const buff): in(buff), acc(0), cnt(0) {}
+
+  /** @brief Read next \c bits bits, \c{bits <= 64}
+   */
+  uint64_t get(const unsigned int bits) {
+    if (bits == 0) return 0;
+    if (cnt >= bits) {
+      const uint64_t v = acc & lowMask(bits);
+      acc = bits == 64 ? 0 : acc >> bits;
+      cnt -= bits;
+      return v;
+    }
+
+    const uint64_t w = load();
+    const uint64_t v = (acc | (w << cnt)) & lowMask(bits);
+    const unsigned int used = bits - cnt;
+    acc = used == 64 ? 0 : w >> used;
+    cnt = 64 - used;
+    return v;
+  }
+};
+
+/** @brief See header for a description
+ */
+size_t PolyRing::packedSize(const unsigned int bits) {
+  return ((size_t)FheParams::get().D * bits + 63) / 64 * 8;
+}
+
+/** @brief See header for a description
+ */
+unsigned int PolyRing::maxBits(bool& negative) const {
+  unsigned int bits = 0;
+  negative = false;
+  for (unsigned int i = 0; i < length(); i++) {
+    const fmpz* const c = polyData->coeffs + i;
+    bits = max(bits, (unsigned int)fmpz_bits(c));
+    negative = negative or fmpz_sgn(c) < 0;
+  }
+  return bits;
+}
+
+/** @brief See header for a description
+ */
+void PolyRing::pack(unsigned char* const buff, const unsigned int bits,
+                    const bool sign) const {
+  const unsigned int words = (bits + 63) / 64;
+  const unsigned int topBits = words > 1 ? bits - 64 * (words - 1) : bits;
+  uint64_t limbs[words + 1];
+
+  fmpz_t tmp;
+  fmpz_init(tmp);
+
+  BitWriter writer(buff);
+  for (unsigned int i = 0; i < FheParams::get().D; i++) {
+    const fmpz* c = i < length() ? polyData->coeffs + i : tmp;
+    const bool neg = fmpz_sgn(c) < 0;
+    if (neg) {
+      fmpz_neg(tmp, c);
+      c = tmp;
+    }
+
+    if (words <= 1) {
+      writer.put(fmpz_get_ui(c), bits);
+    } else {
+      fmpz_get_ui_array((mp_limb_t*)limbs, words, c);
+      for (unsigned int k = 0; k + 1 < words; ++k) {
+        writer.put(limbs[k], 64);
+      }
+      writer.put(limbs[words - 1], topBits);
+    }
+    if (sign) writer.put(neg, 1);
+    fmpz_zero(tmp);
+  }
+  writer.flush();
+
+  fmpz_clear(tmp);
+}
+
+/** @brief See header for a description
+ */
+void PolyRing::unpack(const unsigned char* const buff, const unsigned int bits,
+                      const bool sign) {
+  const unsigned int words = (bits + 63) / 64;
+  const unsigned int topBits = words > 1 ? bits - 64 * (words - 1) : bits;
+  uint64_t limbs[words + 1];
+
+  fmpz_poly_fit_length(polyData, FheParams::get().D);
+  _fmpz_poly_set_length(polyData, FheParams::get().D);
+
+  BitReader reader(buff);
+  for (unsigned int i = 0; i < FheParams::get().D; i++) {
+    fmpz* const c = polyData->coeffs + i;
+
+    if (words <= 1) {
+      fmpz_set_ui(c, reader.get(bits));
+    } else {
+      for (unsigned int k = 0; k + 1 < words; ++k) {
+        limbs[k] = reader.get(64);
+      }
+      limbs[words - 1] = reader.get(topBits);
+      fmpz_set_ui_array(c, (const mp_limb_t*)limbs, words);
+    }
+    if (sign and reader.get(1)) fmpz_neg(c, c);
+  }
+  _fmpz_poly_normalise(polyData);
+}
+
 /** @brief See header for a description
  */
 void PolyRing::print(FILE* const stream) const {
@@ -0,0 +1,149 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "prg.hxx"
+#include "uniform.hxx"
+
+#include <string.h>
+
+using namespace std;
+
+/** @brief ChaCha20 quarter round
+ */
+#define QUARTER_ROUND(a, b, c, d) \
+  a += b; d ^= a; d = (d << 16) | (d >> 16); \
+  c += d; b ^= c; b = (b << 12) | (b >> 20); \
+  a += b; d ^= a; d = (d << 8) | (d >> 24);  \
+  c += d; b ^= c; b = (b << 7) | (b >> 25);
+
+/** @brief Read a little-endian 32-bit word
+ */
+static inline uint32_t load32(const unsigned char* const p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+/** @brief See header for description.
+ */
+Prg::Prg(const Seed& seed, const uint64_t stream): used(sizeof(block)) {
+  /* "expand 32-byte k" */
+  state[0] = 0x61707865;
+  state[1] = 0x3320646e;
+  state[2] = 0x79622d32;
+  state[3] = 0x6b206574;
+  for (unsigned int i = 0; i < 8; ++i) {
+    state[4 + i] = load32(seed.data() + 4 * i);
+  }
+
+  /* 64-bit block counter and 64-bit nonce */
+  state[12] = 0;
+  state[13] = 0;
+  state[14] = (uint32_t)stream;
+  state[15] = (uint32_t)(stream >> 32);
+}
+
+/** @brief See header for description.
+ */
+void Prg::randomSeed(Seed& seed) {
+  UniformRng::sample(seed.data(), SEED_SIZE);
+}
+
+/** @brief See header for description.
+ */
+void Prg::chacha20(uint32_t out[16], const uint32_t in[16]) {
+  uint32_t x[16];
+  memcpy(x, in, sizeof(x));
+
+  for (unsigned int i = 0; i < 10; ++i) {
+    /* column rounds */
+    QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+    QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+    QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+    QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+    /* diagonal rounds */
+    QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+    QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+    QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+    QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+  }
+
+  for (unsigned int i = 0; i < 16; ++i) {
+    out[i] = x[i] + in[i];
+  }
+}
+
+/** @brief See header for description.
+ */
+void Prg::generate(unsigned char out[64]) {
+  uint32_t x[16];
+  chacha20(x, state);
+
+  for (unsigned int i = 0; i < 16; ++i) {
+    out[4 * i] = (unsigned char)x[i];
+    out[4 * i + 1] = (unsigned char)(x[i] >> 8);
+    out[4 * i + 2] = (unsigned char)(x[i] >> 16);
+    out[4 * i + 3] = (unsigned char)(x[i] >> 24);
+  }
+
+  if (++state[12] == 0) ++state[13];
+}
+
+/** @brief See header for description.
+ */
+void Prg::refill() {
+  generate(block);
+  used = 0;
+}
+
+/** @brief See header for description.
+ */
+void Prg::bytes(unsigned char* const out, const size_t len) {
+  size_t done = 0;
+  while (done < len) {
+    if (used == sizeof(block)) {
+      /* bypass the buffer for whole blocks */
+      while (len - done >= sizeof(block)) {
+        generate(out + done);
+        done += sizeof(block);
+      }
+      if (done == len) break;
+      refill();
+    }
+
+    size_t cnt = sizeof(block) - used;
+    if (cnt > len - done) cnt = len - done;
+    memcpy(out + done, block + used, cnt);
+    used += cnt;
+    done += cnt;
+  }
+}
+
+/** @brief See header for description.
+ */
+uint64_t Prg::next() {
+  unsigned char buff[8];
+  bytes(buff, sizeof(buff));
+
+  uint64_t r = 0;
+  for (int i = 7; i >= 0; --i) {
+    r = (r << 8) | buff[i];
+  }
+  return r;
+}
@@ -22,70 +22,110 @@
 #include "uniform.hxx"
 #include "normal.hxx"
 
-/** @brief See header for description.
+#include <assert.h>
+#include <flint/fmpz_vec.h>
+
+/** @brief Set polynomial length to \c len, coefficients are set by
+ *    the caller afterwards
  */
-void RandPolynom::populateBinaryPolyRing(fmpz_poly_t poly, fmpz_t num) {
-  fmpz_poly_bit_unpack_unsigned(poly, num, 1);
+static void fitPoly(fmpz_poly_t poly, const unsigned int len) {
+  fmpz_poly_fit_length(poly, len);
+  _fmpz_vec_zero(poly->coeffs, poly->alloc);
+  _fmpz_poly_set_length(poly, len);
 }
 
 /** @brief See header for description.
  */
 void RandPolynom::sampleUniformBinary(fmpz_poly_t poly, unsigned int len) {
-  fmpz_t num;
-  fmpz_init(num);
-
-  UniformRng::sample(num, len);
-
-  populateBinaryPolyRing(poly, num);
+  Prg& prg = UniformRng::generator();
+  fitPoly(poly, len);
 
-  fmpz_clear(num);
+  uint64_t bits = 0;
+  for (unsigned int i = 0; i < len; i++) {
+    if (i % 64 == 0) bits = prg.next();
+    fmpz_set_ui(poly->coeffs + i, (bits >> (i % 64)) & 1);
+  }
+  _fmpz_poly_normalise(poly);
 }
 
 /** @brief See header for description.
  */
 void RandPolynom::sampleUniformBinary(fmpz_poly_t poly, unsigned int len, unsigned int hammingWeight) {
-  fmpz_t num;
-  fmpz_init(num);
-
-  UniformRng::sample(num, len, hammingWeight);
-
-  populateBinaryPolyRing(poly, num);
-
-  fmpz_clear(num);
+  assert(hammingWeight <= len);
+
+  Prg& prg = UniformRng::generator();
+  fitPoly(poly, len);
+
+  /* Uniform positions in [0;len) by rejection, already set ones are
+   *  drawn again */
+  const unsigned int bitSize = FLINT_BIT_COUNT(len - 1);
+  const uint64_t mask = bitSize == 64 ? ~UINT64_C(0) :
+                          (UINT64_C(1) << bitSize) - 1;
+  for (unsigned int cnt = 0; cnt < hammingWeight; ) {
+    const uint64_t pos = prg.next() & mask;
+    if (pos < len and fmpz_is_zero(poly->coeffs + pos)) {
+      fmpz_one(poly->coeffs + pos);
+      cnt++;
+    }
+  }
+  _fmpz_poly_normalise(poly);
 }
 
 /** @brief See header for description.
  */
 void RandPolynom::sampleUniform(fmpz_poly_t poly, unsigned int len, unsigned int coeffBitCnt) {
-  fmpz_t d;
-  fmpz_init(d);
-  
-  for (unsigned int i = 0; i < len; i++){
-    UniformRng::sample(d, coeffBitCnt);
-    fmpz_poly_set_coeff_fmpz(poly, i, d);
+  const unsigned int words = (coeffBitCnt + FLINT_BITS - 1) / FLINT_BITS;
+  const mp_limb_t mask = coeffBitCnt % FLINT_BITS == 0 ? ~UWORD(0) :
+                          (UWORD(1) << (coeffBitCnt % FLINT_BITS)) - 1;
+  Prg& prg = UniformRng::generator();
+  fitPoly(poly, len);
+
+  mp_limb_t buff[words + 1];
+  for (unsigned int i = 0; i < len; i++) {
+    if (words == 0) break;
+    prg.bytes((unsigned char*)buff, words * sizeof(mp_limb_t));
+    buff[words - 1] &= mask;
+    fmpz_set_ui_array(poly->coeffs + i, buff, words);
   }
-
-  fmpz_clear(d);
+  _fmpz_poly_normalise(poly);
 }
 
 /** @brief See header for description.
  */
-void RandPolynom::sampleUniform(fmpz_poly_t poly, unsigned int len, fmpz_t q) {
-  sampleUniform(poly, len, fmpz_sizeinbase(q, 2));
+void RandPolynom::sampleUniform(fmpz_poly_t poly, unsigned int len,
+                                const fmpz_t q) {
+  sampleUniform(poly, len, q, UniformRng::generator());
 }
 
 /** @brief See header for description.
  */
-void RandPolynom::sampleNormal(fmpz_poly_t poly, unsigned int len, fmpz_t sigma, fmpz_t B) {
-  fmpz_t d;
-  fmpz_init(d);
-  
-  for (unsigned int i = 0; i < len; i++){
-    NormalRng::sample(d, sigma, B);
-    fmpz_poly_set_coeff_fmpz(poly, i, d);
+void RandPolynom::sampleUniform(fmpz_poly_t poly, unsigned int len,
+                                const fmpz_t q, Prg& prg) {
+  const unsigned int bits = fmpz_bits(q);
+  const unsigned int words = (bits + FLINT_BITS - 1) / FLINT_BITS;
+  const mp_limb_t mask = bits % FLINT_BITS == 0 ? ~UWORD(0) :
+                          (UWORD(1) << (bits % FLINT_BITS)) - 1;
+  mp_limb_t buff[words];
+
+  fitPoly(poly, len);
+  for (unsigned int i = 0; i < len; i++) {
+    fmpz* const d = poly->coeffs + i;
+    do {
+      for (unsigned int k = 0; k < words; ++k) {
+        buff[k] = prg.next();
+      }
+      buff[words - 1] &= mask;
+      fmpz_set_ui_array(d, buff, words);
+    } while (fmpz_cmp(d, q) >= 0);
   }
-
-  fmpz_clear(d);
+  _fmpz_poly_normalise(poly);
 }
 
-
+/** @brief See header for description.
+ */
+void RandPolynom::sampleNormal(fmpz_poly_t poly, unsigned int len,
+                               const fmpz_t sigma, const fmpz_t B) {
+  fitPoly(poly, len);
+  NormalRng::sample(poly->coeffs, len, sigma, B);
+  _fmpz_poly_normalise(poly);
+}
@@ -0,0 +1,164 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "rns_base.hxx"
+
+#include <assert.h>
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <flint/fmpz_vec.h>
+#include <flint/ulong_extras.h>
+
+using namespace std;
+
+/** @brief See header for a description
+ */
+RnsBase::RnsBase(const vector<mp_limb_t>& primes_p): primes(primes_p) {
+  init();
+}
+
+/** @brief See header for a description
+ */
+RnsBase::RnsBase(const RnsBase& base1, const RnsBase& base2):
+    primes(base1.primes) {
+  primes.insert(primes.end(), base2.primes.begin(), base2.primes.end());
+  init();
+
+  /* share NTT tables of the two bases */
+  if (base1.hasNtt() and base2.hasNtt()) {
+    ntts = base1.ntts;
+    ntts.insert(ntts.end(), base2.ntts.begin(), base2.ntts.end());
+  }
+}
+
+/** @brief See header for a description
+ */
+RnsBase::RnsBase(const RnsBase& base, const unsigned int count):
+    primes(base.primes.begin(), base.primes.begin() + count) {
+  assert(count <= base.size());
+  init();
+
+  if (base.hasNtt()) {
+    ntts.assign(base.ntts.begin(), base.ntts.begin() + count);
+  }
+}
+
+/** @brief See header for a description
+ */
+RnsBase::~RnsBase() {
+  _fmpz_vec_clear(Mhat, size());
+  fmpz_clear(M);
+}
+
+/** @brief See header for a description
+ */
+void RnsBase::init() {
+  assert(size() > 0);
+
+  mods.resize(size());
+  for (unsigned int i = 0; i < size(); ++i) {
+    nmod_init(&mods[i], primes[i]);
+  }
+
+  maxLazyBound = UWORD_MAX / *max_element(primes.begin(), primes.end());
+
+  fmpz_init_set_ui(M, 1);
+  for (unsigned int i = 0; i < size(); ++i) {
+    fmpz_mul_ui(M, M, primes[i]);
+  }
+
+  Mhat = _fmpz_vec_init(size());
+  MhatInv.resize(size());
+  for (unsigned int i = 0; i < size(); ++i) {
+    fmpz_divexact_ui(Mhat + i, M, primes[i]);
+    MhatInv[i] = n_invmod(fmpz_fdiv_ui(Mhat + i, primes[i]), primes[i]);
+  }
+}
+
+/** @brief See header for a description
+ */
+void RnsBase::initNtt(const unsigned int n) {
+  ntts.clear();
+  for (unsigned int i = 0; i < size(); ++i) {
+    ntts.push_back(make_shared<const Ntt>(n, primes[i]));
+  }
+}
+
+/** @brief See header for a description
+ */
+void RnsBase::reduce(mp_limb_t* const residues, const fmpz_t x,
+                      const unsigned int stride) const {
+  for (unsigned int i = 0; i < size(); ++i) {
+    residues[i * stride] = fmpz_fdiv_ui(x, primes[i]);
+  }
+}
+
+/** @brief See header for a description
+ */
+void RnsBase::reconstruct(fmpz_t x, const mp_limb_t* const residues,
+                  const unsigned int stride, const bool centered) const {
+  fmpz_zero(x);
+  for (unsigned int i = 0; i < size(); ++i) {
+    mp_limb_t v = n_mulmod2_preinv(residues[i * stride], MhatInv[i],
+                                    mods[i].n, mods[i].ninv);
+    fmpz_addmul_ui(x, Mhat + i, v);
+  }
+  fmpz_mod(x, x, M);
+
+  if (centered) {
+    fmpz_t x2;
+    fmpz_init(x2);
+    fmpz_mul_2exp(x2, x, 1);
+    if (fmpz_cmp(x2, M) > 0) {
+      fmpz_sub(x, x, M);
+    }
+    fmpz_clear(x2);
+  }
+}
+
+/** @brief See header for a description
+ */
+vector<mp_limb_t> RnsBase::generatePrimes(const unsigned int count,
+              const unsigned int bitsize, const mp_limb_t m,
+              const vector<mp_limb_t>& exclude) {
+  assert(bitsize < FLINT_BITS);
+
+  vector<mp_limb_t> res;
+  mp_limb_t p = ((((mp_limb_t)1 << bitsize) - 1) / m) * m + 1;
+  if (p >> bitsize) p -= m;
+
+  while (res.size() < count) {
+    if (p <= m) {
+      cerr << "ERROR: RnsBase::generatePrimes cannot find " << count
+        << " primes of " << bitsize << " bits congruent to 1 modulo "
+        << m << endl;
+      exit(-1);
+    }
+
+    if (n_is_prime(p) and
+        find(exclude.begin(), exclude.end(), p) == exclude.end()) {
+      res.push_back(p);
+    }
+    p -= m;
+  }
+
+  return res;
+}
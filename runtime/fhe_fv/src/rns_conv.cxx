@@ -0,0 +1,274 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "rns_conv.hxx"
+#include "mem_pool.hxx"
+#include "vec_mod.hxx"
+
+#include <assert.h>
+#include <flint/fmpz.h>
+#include <flint/longlong.h>
+#include <flint/ulong_extras.h>
+
+using namespace std;
+
+/** @brief Split \c{x mod 2^128} in two words
+ */
+static void fmpz_get_uu(mp_limb_t& hi, mp_limb_t& lo, const fmpz_t x) {
+  fmpz_t tmp;
+  fmpz_init(tmp);
+  fmpz_fdiv_r_2exp(tmp, x, FLINT_BITS);
+  lo = fmpz_get_ui(tmp);
+  fmpz_fdiv_q_2exp(tmp, x, FLINT_BITS);
+  fmpz_fdiv_r_2exp(tmp, tmp, FLINT_BITS);
+  hi = fmpz_get_ui(tmp);
+  fmpz_clear(tmp);
+}
+
+/** @brief Fixed-point fraction \c{floor(r.2^128/p)} of \c{r/p}, \c{r < p}
+ */
+static void fraction(mp_limb_t& hi, mp_limb_t& lo, const fmpz_t r,
+                     const mp_limb_t p) {
+  fmpz_t tmp;
+  fmpz_init(tmp);
+  fmpz_mul_2exp(tmp, r, 2 * FLINT_BITS);
+  fmpz_fdiv_q_ui(tmp, tmp, p);
+  fmpz_get_uu(hi, lo, tmp);
+  fmpz_clear(tmp);
+}
+
+/** @brief Add \c{y.f} to a fixed-point accumulator
+ *
+ *  \c f is a 128-bit fraction, \c{(hi, lo)} has 64 fractional bits and
+ *    \c carry counts overflows of \c hi. The last 64 bits of \c{y.f} are
+ *    truncated.
+ */
+static inline void addmul_frac(mp_limb_t& carry, mp_limb_t& hi, mp_limb_t& lo,
+                               const mp_limb_t y, const mp_limb_t f_hi,
+                               const mp_limb_t f_lo) {
+  mp_limb_t ph, pl, qh, ql;
+  umul_ppmm(ph, pl, y, f_hi);
+  umul_ppmm(qh, ql, y, f_lo);
+  (void)ql;
+  add_ssaaaa(ph, pl, ph, pl, 0, qh);
+
+  const mp_limb_t old = hi;
+  add_ssaaaa(hi, lo, hi, lo, ph, pl);
+  carry += (hi < old);
+}
+
+/** @brief Add \c{a.b} to a two word accumulator \c{(hi, lo)} modulo \c p
+ *
+ *  \c hi is kept smaller than \c p, hence \c{a.b} must be smaller
+ *    than \c{p.2^64}.
+ */
+static inline void addmul_mod(mp_limb_t& hi, mp_limb_t& lo, const mp_limb_t a,
+                              const mp_limb_t b, const mp_limb_t p) {
+  mp_limb_t ph, pl;
+  umul_ppmm(ph, pl, a, b);
+  add_ssaaaa(hi, lo, hi, lo, ph, pl);
+  if (hi >= p) hi -= p;
+}
+
+/** @brief See header for a description
+ */
+RnsConv::RnsConv(const RnsBase& from_p, const RnsBase& to_p):
+    from(from_p), to(to_p) {
+  const unsigned int na = from.size();
+  const unsigned int nc = to.size();
+
+  ahatInv.resize(na);
+  ahatInvShoup.resize(na);
+  invHi.resize(na);
+  invLo.resize(na);
+  ahatModC.resize(nc * na);
+  negAModC.resize(nc);
+
+  fmpz_t ahat, one;
+  fmpz_init(ahat);
+  fmpz_init_set_ui(one, 1);
+
+  for (unsigned int i = 0; i < na; ++i) {
+    const mp_limb_t p = from.prime(i);
+    fmpz_divexact_ui(ahat, from.modulus(), p);
+    ahatInv[i] = n_invmod(fmpz_fdiv_ui(ahat, p), p);
+    ahatInvShoup[i] = VecMod::shoup(ahatInv[i], p);
+    fraction(invHi[i], invLo[i], one, p);
+
+    for (unsigned int j = 0; j < nc; ++j) {
+      ahatModC[j * na + i] = fmpz_fdiv_ui(ahat, to.prime(j));
+    }
+  }
+
+  for (unsigned int j = 0; j < nc; ++j) {
+    const mp_limb_t c = to.prime(j);
+    negAModC[j] = (c - fmpz_fdiv_ui(from.modulus(), c)) % c;
+  }
+
+  fmpz_clear(ahat);
+  fmpz_clear(one);
+}
+
+/** @brief See header for a description
+ */
+void RnsConv::convert(mp_limb_t* const dst, const mp_limb_t* const src,
+                      const unsigned int n) const {
+  const unsigned int na = from.size();
+  const unsigned int nc = to.size();
+
+  /* y_i = [x_i.(a/a_i)^-1]_{a_i} */
+  mp_limb_t* y = MemPool::allocate(na * n);
+  for (unsigned int i = 0; i < na; ++i) {
+    VecMod::scalar_mul(y + i * n, src + i * n, n, ahatInv[i],
+                       ahatInvShoup[i], from.prime(i));
+  }
+
+  for (unsigned int k = 0; k < n; ++k) {
+    /* v = round(sum y_i/a_i) */
+    mp_limb_t v_carry = 0, v = 0, v_frac = UWORD(1) << (FLINT_BITS - 1);
+    for (unsigned int i = 0; i < na; ++i) {
+      addmul_frac(v_carry, v, v_frac, y[i * n + k], invHi[i], invLo[i]);
+    }
+    assert(v_carry == 0);
+
+    /* sum y_i.(a/a_i) - v.a modulo c_j */
+    for (unsigned int j = 0; j < nc; ++j) {
+      const nmod_t& mod = to.mod(j);
+      const mp_limb_t* const ahat = ahatModC.data() + j * na;
+      mp_limb_t hi = 0, lo = 0;
+      addmul_mod(hi, lo, v, negAModC[j], mod.n);
+      for (unsigned int i = 0; i < na; ++i) {
+        addmul_mod(hi, lo, y[i * n + k], ahat[i], mod.n);
+      }
+      dst[j * n + k] = n_ll_mod_preinv(hi, lo, mod.n, mod.ninv);
+    }
+  }
+
+  MemPool::release(y, na * n);
+}
+
+/** @brief See header for a description
+ */
+RnsScale::RnsScale(const RnsBase& base_p, const RnsBase& keep_p,
+                   const mp_limb_t t): base(base_p), keep(keep_p) {
+  assert(base.size() > keep.size());
+  const unsigned int nk = keep.size();
+  dropSize = base.size() - nk;
+
+  if (base.prime(0) == keep.prime(0)) {
+    keepOffset = 0;
+    dropOffset = nk;
+  } else {
+    dropOffset = 0;
+    keepOffset = dropSize;
+  }
+  for (unsigned int j = 0; j < nk; ++j) {
+    assert(base.prime(keepOffset + j) == keep.prime(j));
+  }
+
+  dhatInv.resize(dropSize);
+  dhatInvShoup.resize(dropSize);
+  fracHi.resize(dropSize);
+  fracLo.resize(dropSize);
+  intModK.resize(nk * dropSize);
+  tdInv.resize(nk);
+  tdInvShoup.resize(nk);
+
+  fmpz_t d, tk, dhat, w, r;
+  fmpz_init(d);
+  fmpz_init(tk);
+  fmpz_init(dhat);
+  fmpz_init(w);
+  fmpz_init(r);
+
+  fmpz_divexact(d, base.modulus(), keep.modulus());
+  fmpz_mul_ui(tk, keep.modulus(), t);
+
+  for (unsigned int i = 0; i < dropSize; ++i) {
+    const mp_limb_t p = base.prime(dropOffset + i);
+    fmpz_divexact_ui(dhat, base.modulus(), p);
+    dhatInv[i] = n_invmod(fmpz_fdiv_ui(dhat, p), p);
+    dhatInvShoup[i] = VecMod::shoup(dhatInv[i], p);
+
+    /* t.k/d_i = w_i + r_i/d_i */
+    fmpz_fdiv_q_ui(w, tk, p);
+    fmpz_set_ui(r, fmpz_fdiv_ui(tk, p));
+    fraction(fracHi[i], fracLo[i], r, p);
+
+    for (unsigned int j = 0; j < nk; ++j) {
+      intModK[j * dropSize + i] = fmpz_fdiv_ui(w, keep.prime(j));
+    }
+  }
+
+  for (unsigned int j = 0; j < nk; ++j) {
+    const mp_limb_t p = keep.prime(j);
+    tdInv[j] = n_mulmod2_preinv(t % p, n_invmod(fmpz_fdiv_ui(d, p), p),
+                                p, keep.mod(j).ninv);
+    tdInvShoup[j] = VecMod::shoup(tdInv[j], p);
+  }
+
+  fmpz_clear(d);
+  fmpz_clear(tk);
+  fmpz_clear(dhat);
+  fmpz_clear(w);
+  fmpz_clear(r);
+}
+
+/** @brief See header for a description
+ */
+void RnsScale::scale(mp_limb_t* const dst, const mp_limb_t* const src,
+                     const unsigned int n) const {
+  const unsigned int nk = keep.size();
+
+  /* y_i = [x_i.(m/d_i)^-1]_{d_i} */
+  mp_limb_t* y = MemPool::allocate(dropSize * n);
+  for (unsigned int i = 0; i < dropSize; ++i) {
+    VecMod::scalar_mul(y + i * n, src + (dropOffset + i) * n, n, dhatInv[i],
+                       dhatInvShoup[i], base.prime(dropOffset + i));
+  }
+
+  /* t.d^-1.x_j */
+  for (unsigned int j = 0; j < nk; ++j) {
+    VecMod::scalar_mul(dst + j * n, src + (keepOffset + j) * n, n, tdInv[j],
+                       tdInvShoup[j], keep.prime(j));
+  }
+
+  for (unsigned int k = 0; k < n; ++k) {
+    /* round(sum y_i.f_i) */
+    mp_limb_t r_carry = 0, r = 0, r_frac = UWORD(1) << (FLINT_BITS - 1);
+    for (unsigned int i = 0; i < dropSize; ++i) {
+      addmul_frac(r_carry, r, r_frac, y[i * n + k], fracHi[i], fracLo[i]);
+    }
+
+    /* + sum y_i.w_i modulo k_j */
+    for (unsigned int j = 0; j < nk; ++j) {
+      const nmod_t& mod = keep.mod(j);
+      const mp_limb_t* const w = intModK.data() + j * dropSize;
+      mp_limb_t hi = r_carry, lo = r;
+      addmul_mod(hi, lo, dst[j * n + k], 1, mod.n);
+      for (unsigned int i = 0; i < dropSize; ++i) {
+        addmul_mod(hi, lo, y[i * n + k], w[i], mod.n);
+      }
+      dst[j * n + k] = n_ll_mod_preinv(hi, lo, mod.n, mod.ninv);
+    }
+  }
+
+  MemPool::release(y, dropSize * n);
+}
@@ -0,0 +1,492 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "rns_poly.hxx"
+#include "fhe_params.hxx"
+#include "mem_pool.hxx"
+#include "thread_pool.hxx"
+#include "vec_mod.hxx"
+
+#include <algorithm>
+#include <string.h>
+#include <flint/nmod_poly.h>
+#include <flint/nmod_vec.h>
+
+using namespace std;
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(const RnsBase& base_p, const bool ntt):
+    base(&base_p), nttForm(ntt), owner(true), bound(1) {
+  data = MemPool::allocate(size() * FheParams::get().D);
+  memset(data, 0, size() * FheParams::get().D * sizeof(mp_limb_t));
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(const RnsBase& base_p, mp_limb_t* const data_p, const bool ntt):
+    base(&base_p), data(data_p), nttForm(ntt), owner(false), bound(1) {
+  memset(data, 0, size() * FheParams::get().D * sizeof(mp_limb_t));
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(const RnsBase& base_p, mp_limb_t* const data_p, const bool ntt,
+                 const unsigned int bound_p):
+    base(&base_p), data(data_p), nttForm(ntt), owner(false), bound(bound_p) {
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(const RnsBase& base_p, const PolyRing& poly):
+    RnsPoly(base_p, false) {
+  for (unsigned int j = 0; j < poly.length() and j < FheParams::get().D; ++j) {
+    base->reduce(data + j, poly.getCoeff(j), FheParams::get().D);
+  }
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(const RnsPoly& poly):
+    base(poly.base), nttForm(poly.nttForm), owner(true), bound(poly.bound) {
+  data = MemPool::allocate(size() * FheParams::get().D);
+  memcpy(data, poly.data, size() * FheParams::get().D * sizeof(mp_limb_t));
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::RnsPoly(RnsPoly&& poly) noexcept:
+    base(poly.base), data(poly.data), nttForm(poly.nttForm),
+    owner(poly.owner), bound(poly.bound) {
+  poly.data = nullptr;
+  poly.owner = false;
+}
+
+/** @brief See header for a description
+ */
+RnsPoly::~RnsPoly() {
+  if (owner) MemPool::release(data, size() * FheParams::get().D);
+}
+
+/** @brief See header for a description
+ */
+RnsPoly& RnsPoly::operator=(const RnsPoly& poly) {
+  assert(base == poly.base);
+  if (this != &poly) {
+    memcpy(data, poly.data, size() * FheParams::get().D * sizeof(mp_limb_t));
+    nttForm = poly.nttForm;
+    bound = poly.bound;
+  }
+  return *this;
+}
+
+/** @brief See header for a description
+ */
+RnsPoly RnsPoly::prefix(const RnsPoly& poly, const RnsBase& base) {
+  assert(base.size() <= poly.size());
+  assert(base.prime(base.size() - 1) == poly.base->prime(base.size() - 1));
+
+  return RnsPoly(base, poly.data, poly.nttForm, poly.bound);
+}
+
+/** @brief See header for a description
+ */
+RnsPoly RnsPoly::view(const RnsBase& base, mp_limb_t* const data,
+                      const bool ntt) {
+  return RnsPoly(base, data, ntt, 1);
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::project(RnsPoly& dst, const RnsPoly& src) {
+  const vector<mp_limb_t>& primes = src.base->getPrimes();
+  for (unsigned int i = 0; i < dst.size(); ++i) {
+    const unsigned int j = find(primes.begin(), primes.end(),
+                                dst.base->prime(i)) - primes.begin();
+    assert(j < src.size());
+    memcpy(dst.limb(i), src.limb(j), FheParams::get().D * sizeof(mp_limb_t));
+  }
+  dst.nttForm = src.nttForm;
+  dst.bound = src.bound;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::moveTo(mp_limb_t* const buffer) {
+  memcpy(buffer, data, size() * FheParams::get().D * sizeof(mp_limb_t));
+  if (owner) MemPool::release(data, size() * FheParams::get().D);
+  data = buffer;
+  owner = false;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::toPolyRing(PolyRing& poly, const bool centered) const {
+  if (nttForm) {
+    RnsPoly tmp(*this);
+    tmp.fromNtt();
+    tmp.toPolyRing(poly, centered);
+    return;
+  }
+
+  PolyRing res;
+  fmpz_t x;
+  fmpz_init(x);
+
+  for (unsigned int j = 0; j < FheParams::get().D; ++j) {
+    base->reconstruct(x, data + j, FheParams::get().D, centered);
+    res.setCoeff(j, x);
+  }
+  poly = res;
+
+  fmpz_clear(x);
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::toNtt() {
+  if (nttForm) return;
+  assert(base->hasNtt());
+
+  normalize();
+  ThreadPool::parallelFor(size(), [this](unsigned int i) {
+    base->ntt(i).forward(limb(i));
+  });
+  nttForm = true;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::fromNtt() {
+  if (not nttForm) return;
+
+  normalize();
+  ThreadPool::parallelFor(size(), [this](unsigned int i) {
+    base->ntt(i).inverse(limb(i));
+  });
+  nttForm = false;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::normalize() {
+  if (bound == 1) return;
+
+  for (unsigned int i = 0; i < size(); ++i) {
+    const mp_limb_t p = base->prime(i);
+    if (bound == 2) {
+      VecMod::reduce(limb(i), limb(i), FheParams::get().D, p);
+    } else {
+      /* Shoup multiplication by 1 reduces any word */
+      VecMod::scalar_mul(limb(i), limb(i), FheParams::get().D, 1, VecMod::shoup(1, p), p);
+    }
+  }
+  bound = 1;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::reduce(mp_limb_t* const res, mp_limb_t* const prod,
+                      const unsigned int idx) const {
+  const unsigned int D = FheParams::get().D;
+  const nmod_t& mod = base->mod(idx);
+
+  if (FheParams::get().IsPowerOfTwoCyclotomic) {
+    /* X^D = -1, fold upper half of the product */
+    _nmod_vec_sub(res, prod, prod + D, D - 1, mod);
+    res[D - 1] = prod[D - 1];
+  } else {
+    mp_limb_t* modulo = _nmod_vec_init(D + 1);
+    for (unsigned int i = 0; i <= D; ++i) {
+      modulo[i] = fmpz_fdiv_ui(
+          fmpz_poly_get_coeff_ptr(FheParams::get().PolyRingModulo, i), mod.n);
+    }
+    _nmod_poly_rem(res, prod, 2 * D - 1, modulo, D + 1, mod);
+    _nmod_vec_clear(modulo);
+  }
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::negate(RnsPoly& poly) {
+  poly.normalize();
+  for (unsigned int i = 0; i < poly.size(); ++i) {
+    VecMod::neg(poly.limb(i), poly.limb(i), FheParams::get().D, poly.base->prime(i));
+  }
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::add(RnsPoly& left, const RnsPoly& right) {
+  assert(left.base == right.base);
+  if (left.nttForm != right.nttForm) {
+    RnsPoly tmp(right);
+    left.nttForm ? tmp.toNtt() : tmp.fromNtt();
+    RnsPoly::add(left, tmp);
+    return;
+  }
+
+  if (left.bound + right.bound > left.base->lazyBound()) {
+    left.normalize();
+    if (right.bound == left.base->lazyBound()) {
+      RnsPoly tmp(right);
+      tmp.normalize();
+      RnsPoly::add(left, tmp);
+      return;
+    }
+  }
+
+  for (unsigned int i = 0; i < left.size(); ++i) {
+    VecMod::add_lazy(left.limb(i), left.limb(i), right.limb(i), FheParams::get().D);
+  }
+  left.bound += right.bound;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::sub(RnsPoly& left, const RnsPoly& right) {
+  assert(left.base == right.base);
+  if (left.nttForm != right.nttForm) {
+    RnsPoly tmp(right);
+    left.nttForm ? tmp.toNtt() : tmp.fromNtt();
+    RnsPoly::sub(left, tmp);
+    return;
+  }
+
+  if (left.bound + right.bound > left.base->lazyBound()) {
+    left.normalize();
+    if (right.bound == left.base->lazyBound()) {
+      RnsPoly tmp(right);
+      tmp.normalize();
+      RnsPoly::sub(left, tmp);
+      return;
+    }
+  }
+
+  /* left + k.p - right, with right < k.p */
+  for (unsigned int i = 0; i < left.size(); ++i) {
+    VecMod::sub_lazy(left.limb(i), left.limb(i), right.limb(i),
+                FheParams::get().D, right.bound * left.base->prime(i));
+  }
+  left.bound += right.bound;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::add(RnsPoly& res, const RnsPoly& left, const RnsPoly& right) {
+  if (&res == &left) {
+    RnsPoly::add(res, right);
+    return;
+  }
+  if (&res == &right) {
+    RnsPoly::add(res, left);
+    if (res.nttForm != left.nttForm) {
+      left.nttForm ? res.toNtt() : res.fromNtt();
+    }
+    return;
+  }
+
+  assert(res.base == left.base and left.base == right.base);
+  if (left.nttForm != right.nttForm or
+      left.bound + right.bound > left.base->lazyBound()) {
+    res = left;
+    RnsPoly::add(res, right);
+    return;
+  }
+
+  for (unsigned int i = 0; i < left.size(); ++i) {
+    VecMod::add_lazy(res.limb(i), left.limb(i), right.limb(i), FheParams::get().D);
+  }
+  res.nttForm = left.nttForm;
+  res.bound = left.bound + right.bound;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::sub(RnsPoly& res, const RnsPoly& left, const RnsPoly& right) {
+  if (&res == &left) {
+    RnsPoly::sub(res, right);
+    return;
+  }
+
+  assert(res.base == left.base and left.base == right.base);
+  if (&res == &right or left.nttForm != right.nttForm or
+      left.bound + right.bound > left.base->lazyBound()) {
+    RnsPoly tmp(left);
+    RnsPoly::sub(tmp, right);
+    res = tmp;
+    return;
+  }
+
+  for (unsigned int i = 0; i < left.size(); ++i) {
+    VecMod::sub_lazy(res.limb(i), left.limb(i), right.limb(i),
+                FheParams::get().D, right.bound * left.base->prime(i));
+  }
+  res.nttForm = left.nttForm;
+  res.bound = left.bound + right.bound;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::multiply(RnsPoly& prod, const RnsPoly& left, const RnsPoly& right) {
+  assert(&prod != &left and &prod != &right);
+  prod = left;
+  RnsPoly::multiply(prod, right);
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::multiply(RnsPoly& left, const RnsPoly& right) {
+  assert(left.base == right.base);
+  const unsigned int D = FheParams::get().D;
+
+  if (left.base->hasNtt()) {
+    if (not right.nttForm) {
+      RnsPoly tmp(right);
+      tmp.toNtt();
+      RnsPoly::multiply(left, tmp);
+      return;
+    }
+
+    /* coefficient-wise products accept unreduced residues */
+    const bool coeffForm = not left.nttForm;
+    left.toNtt();
+    ThreadPool::parallelFor(left.size(), [&left, &right](unsigned int i) {
+      left.base->ntt(i).multiply(left.limb(i), left.limb(i), right.limb(i));
+    });
+    left.bound = 1;
+    if (coeffForm) left.fromNtt();
+    return;
+  }
+
+  assert(not left.nttForm and not right.nttForm);
+  if (right.bound > 1) {
+    RnsPoly tmp(right);
+    tmp.normalize();
+    RnsPoly::multiply(left, tmp);
+    return;
+  }
+  left.normalize();
+
+  mp_limb_t* prod = _nmod_vec_init(2 * D - 1);
+
+  for (unsigned int i = 0; i < left.size(); ++i) {
+    _nmod_poly_mul(prod, left.limb(i), D, right.limb(i), D, left.base->mod(i));
+    left.reduce(left.limb(i), prod, i);
+  }
+
+  _nmod_vec_clear(prod);
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::multiply(RnsPoly& poly, const fmpz_t t) {
+  for (unsigned int i = 0; i < poly.size(); ++i) {
+    const mp_limb_t p = poly.base->prime(i);
+    const mp_limb_t c = fmpz_fdiv_ui(t, p);
+    VecMod::scalar_mul(poly.limb(i), poly.limb(i), FheParams::get().D,
+                       c, VecMod::shoup(c, p), p);
+  }
+  poly.bound = 1;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::automorphism(RnsPoly& res, const RnsPoly& poly,
+                           const unsigned int k) {
+  assert(FheParams::get().IsPowerOfTwoCyclotomic);
+  assert(res.base == poly.base and &res != &poly);
+  const unsigned int D = FheParams::get().D;
+
+  res.nttForm = poly.nttForm;
+  if (poly.nttForm) {
+    const vector<unsigned int> perm = Ntt::galoisPermutation(D, k);
+    for (unsigned int i = 0; i < poly.size(); ++i) {
+      const mp_limb_t* const src = poly.limb(i);
+      mp_limb_t* const dst = res.limb(i);
+      for (unsigned int j = 0; j < D; ++j) {
+        dst[j] = src[perm[j]];
+      }
+    }
+    res.bound = poly.bound;
+    return;
+  }
+
+  /* X^j -> X^(j.k), negated when j.k mod 2D >= D */
+  for (unsigned int i = 0; i < poly.size(); ++i) {
+    const mp_limb_t p = poly.base->prime(i);
+    const mp_limb_t* const src = poly.limb(i);
+    mp_limb_t* const dst = res.limb(i);
+    for (unsigned long j = 0; j < D; ++j) {
+      const unsigned long e = j * k % (2 * D);
+      const mp_limb_t v = poly.bound > 1 ? src[j] % p : src[j];
+      if (e < D) {
+        dst[e] = v;
+      } else {
+        dst[e - D] = v == 0 ? 0 : p - v;
+      }
+    }
+  }
+  res.bound = 1;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::convert(RnsPoly& dst, const RnsPoly& src, const RnsConv& conv) {
+  const FheParams& params = FheParams::get();
+
+  assert(src.base == &conv.source());
+  if (src.nttForm) {
+    RnsPoly tmp(src);
+    tmp.fromNtt();
+    RnsPoly::convert(dst, tmp, conv);
+    return;
+  }
+
+  if (dst.base == &conv.target()) {
+    conv.convert(dst.data, src.data, params.D);
+    dst.bound = 1;
+  } else {
+    /* dst base is the concatenation of src and conv target bases */
+    assert(dst.size() == src.size() + conv.target().size());
+    assert(dst.base->prime(src.size()) == conv.target().prime(0));
+    memcpy(dst.data, src.data, src.size() * params.D * sizeof(mp_limb_t));
+    conv.convert(dst.limb(src.size()), src.data, params.D);
+    dst.bound = src.bound;
+  }
+  dst.nttForm = false;
+}
+
+/** @brief See header for a description
+ */
+void RnsPoly::multiply_round(RnsPoly& dst, const RnsPoly& src,
+                              const RnsScale& scale) {
+  assert(src.base == &scale.source() and dst.base == &scale.target());
+  if (src.nttForm) {
+    RnsPoly tmp(src);
+    tmp.fromNtt();
+    RnsPoly::multiply_round(dst, tmp, scale);
+    return;
+  }
+
+  scale.scale(dst.data, src.data, FheParams::get().D);
+  dst.nttForm = false;
+  dst.bound = 1;
+}
@@ -0,0 +1,181 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "thread_pool.hxx"
+#include "fhe_context.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+  /** @brief Iterations of a parallel loop, shared by the calling thread
+   *    and the helpers running it
+   */
+  struct Loop {
+    const function<void (unsigned int)>* fn;
+    shared_ptr<const FheContext> context;
+    unsigned int n;
+
+    /** @brief Width of the threads running iterations
+     */
+    unsigned int width;
+
+    /** @brief Next iteration to start and number of finished iterations
+     */
+    atomic<unsigned int> next;
+    atomic<unsigned int> done;
+
+    mutex mtx;
+    condition_variable cond;
+
+    Loop(const function<void (unsigned int)>& fn_p, const unsigned int n_p,
+         const unsigned int width_p):
+        fn(&fn_p), context(FheContext::current()), n(n_p), width(width_p),
+        next(0), done(0) {}
+
+    /** @brief Run iterations until none is left to start
+     */
+    void run() {
+      ThreadPool::Width w(width);
+      unsigned int i;
+      while ((i = next++) < n) {
+        (*fn)(i);
+        if (++done == n) {
+          lock_guard<mutex> lck(mtx);
+          cond.notify_all();
+        }
+      }
+    }
+  };
+
+  /** @brief Helper threads and queue of loops waiting for helpers, a
+   *    loop is queued once per helper it can use
+   */
+  struct Pool {
+    vector<thread> threads;
+    deque<shared_ptr<Loop>> queue;
+    bool stop = false;
+    mutex mtx;
+    condition_variable cond;
+
+    ~Pool() {
+      resize(0);
+    }
+
+    void resize(const unsigned int size);
+    void work();
+  };
+
+  Pool pool;
+
+  thread_local unsigned int threadWidth = 1;
+
+  void Pool::resize(const unsigned int size) {
+    unique_lock<mutex> lck(mtx);
+    stop = true;
+    queue.clear();
+    lck.unlock();
+    cond.notify_all();
+
+    for (thread& th : threads) th.join();
+    threads.clear();
+
+    stop = false;
+    for (unsigned int i = 0; i < size; ++i) {
+      threads.emplace_back(&Pool::work, this);
+    }
+  }
+
+  void Pool::work() {
+    while (true) {
+      unique_lock<mutex> lck(mtx);
+      cond.wait(lck, [this]{ return stop or not queue.empty(); });
+      if (stop) break;
+      shared_ptr<Loop> loop = move(queue.front());
+      queue.pop_front();
+      lck.unlock();
+
+      if (FheContext::current() != loop->context) {
+        FheContext::bind(loop->context);
+      }
+      loop->run();
+    }
+
+    FheContext::bind(nullptr);
+    flint_cleanup();
+  }
+}
+
+/** @brief See header for description.
+ */
+void ThreadPool::resize(const unsigned int threads) {
+  pool.resize(threads);
+}
+
+/** @brief See header for description.
+ */
+unsigned int ThreadPool::size() {
+  return pool.threads.size();
+}
+
+/** @brief See header for description.
+ */
+unsigned int ThreadPool::width() {
+  return threadWidth;
+}
+
+/** @brief See header for description.
+ */
+void ThreadPool::setWidth(const unsigned int w) {
+  threadWidth = max(w, 1u);
+}
+
+/** @brief See header for description.
+ */
+void ThreadPool::parallelFor(const unsigned int n,
+                             const function<void (unsigned int)>& fn) {
+  const unsigned int w = min({threadWidth, n, size() + 1});
+  if (w <= 1) {
+    for (unsigned int i = 0; i < n; ++i) fn(i);
+    return;
+  }
+
+  shared_ptr<Loop> loop = make_shared<Loop>(fn, n, max(threadWidth / w, 1u));
+
+  unique_lock<mutex> lck(pool.mtx);
+  for (unsigned int k = 1; k < w; ++k) {
+    pool.queue.push_back(loop);
+  }
+  lck.unlock();
+  pool.cond.notify_all();
+
+  loop->run();
+
+  unique_lock<mutex> lck_loop(loop->mtx);
+  loop->cond.wait(lck_loop, [&loop]{ return loop->done == loop->n; });
+}
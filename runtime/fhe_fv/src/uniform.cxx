@@ -48,14 +48,9 @@ unsigned int sizeInBits(unsigned int bitCnt) {
   return (int)bitSize;
 }
 
-unsigned int bits2Bytes(unsigned int bitSize) {
-  double byteSize = ceil((float)bitSize / 8);
-  return (int)byteSize;
-}
-
-/** @brief See header for description.
+/** @brief Read \c byteCnt bytes from the system random generator
  */
-void UniformRng::sample(fmpz_t num, unsigned int bitCnt) {
+static void osRandom(unsigned char* const buff, const unsigned int byteCnt) {
   int randDev = open("/dev/urandom", O_RDONLY);
   if (randDev == -1) {
     cerr << "File: " << __FILE__ << " line: " << __LINE__
@@ -63,14 +58,42 @@ void UniformRng::sample(fmpz_t num, unsigned int bitCnt) {
     exit(-1);
   }
 
-  unsigned int byteCnt = bits2Bytes(bitCnt);
-  unsigned char buff[byteCnt];
-
   unsigned int r = read(randDev, buff, byteCnt);
   assert(r == byteCnt);
   close(randDev);
+}
+
+/** @brief Seed a thread generator from the system random generator
+ */
+static Prg::Seed osSeed() {
+  Prg::Seed seed;
+  osRandom(seed.data(), Prg::SEED_SIZE);
+  return seed;
+}
+
+/** @brief See header for description.
+ */
+Prg& UniformRng::generator() {
+  thread_local Prg prg(osSeed());
+  return prg;
+}
+
+/** @brief See header for description.
+ */
+void UniformRng::sample(fmpz_t num, unsigned int bitCnt) {
+  const unsigned int wordCnt = (bitCnt + FLINT_BITS - 1) / FLINT_BITS;
+  mp_limb_t buff[wordCnt + 1];
+  buff[wordCnt] = 0;
 
-  fmpz_bit_unpack_unsigned(num, (mp_limb_t*)buff, 0, bitCnt);
+  generator().bytes((unsigned char*)buff, wordCnt * sizeof(mp_limb_t));
+
+  fmpz_bit_unpack_unsigned(num, buff, 0, bitCnt);
+}
+
+/** @brief See header for description.
+ */
+void UniformRng::sample(unsigned char* const buff, unsigned int byteCnt) {
+  generator().bytes(buff, byteCnt);
 }
 
 /** @brief See header for description.
@@ -80,35 +103,20 @@ void UniformRng::sample(fmpz_t num_p,
                         unsigned int hammingWeight) {
   assert(2 * hammingWeight <= bitCnt);
 
-  int randDev = open("/dev/urandom", O_RDONLY);
-  if (randDev == -1) {
-    cerr << "File: " << __FILE__ << " line: " << __LINE__
-      << " - cannot open random generator \"/dev/urandom\"" << endl;
-    exit(-1);
-  }
-
   unsigned int bitSize = sizeInBits(bitCnt - 1);
   assert(bitSize <= FLINT_BITS);
-  
-  unsigned int byteSize = bits2Bytes(bitSize);
-  unsigned int mask = (1 << bitSize) - 1;
+
+  const mp_limb_t mask = bitSize == FLINT_BITS ? ~UWORD(0) :
+                          (UWORD(1) << bitSize) - 1;
+  Prg& prg = generator();
 
   fmpz_zero(num_p);
 
   while (fmpz_popcnt(num_p) < hammingWeight) {
-    unsigned int pos = 0;
-    unsigned char b;
-
-    for (unsigned int i = 0; i < byteSize; i++) {
-      int r = read(randDev, &b, 1);
-      assert(r == 1);
-      pos |= (b << (8 * i));
-    }
-    pos &= mask;
+    mp_limb_t pos = prg.next() & mask;
 
     if (pos < bitCnt) {
       fmpz_combit(num_p, pos);
     }
-  }  
+  }
 }
-
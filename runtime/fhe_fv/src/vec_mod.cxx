@@ -0,0 +1,572 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "vec_mod.hxx"
+
+#include <flint/longlong.h>
+#include <flint/ulong_extras.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define VEC_MOD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  typedef void (*binary_fn)(mp_limb_t*, const mp_limb_t*, const mp_limb_t*,
+                            slong, mp_limb_t);
+  typedef void (*unary_fn)(mp_limb_t*, const mp_limb_t*, slong, mp_limb_t);
+  typedef void (*lazy_binary_fn)(mp_limb_t*, const mp_limb_t*, const mp_limb_t*,
+                            slong);
+  typedef void (*scalar_mul_fn)(mp_limb_t*, const mp_limb_t*, slong,
+                            mp_limb_t, mp_limb_t, mp_limb_t);
+  typedef void (*mul_fn)(mp_limb_t*, const mp_limb_t*, const mp_limb_t*,
+                            slong, nmod_t);
+
+  /** @brief Kernels of an implementation
+   */
+  struct Kernels {
+    VecMod::Isa isa;
+    const char* name;
+    binary_fn add;
+    binary_fn sub;
+    unary_fn neg;
+    unary_fn reduce;
+    scalar_mul_fn scalar_mul;
+    lazy_binary_fn add_lazy;
+    binary_fn sub_lazy;
+    mul_fn mul;
+  };
+
+  /* Portable scalar kernels, also used for vector tails */
+
+  inline mp_limb_t mulhi(const mp_limb_t a, const mp_limb_t b) {
+    mp_limb_t hi, lo;
+    umul_ppmm(hi, lo, a, b);
+    (void) lo;
+    return hi;
+  }
+
+  void add_scalar(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    for (slong i = 0; i < len; ++i) {
+      const mp_limb_t s = a[i] + b[i];
+      res[i] = s >= p ? s - p : s;
+    }
+  }
+
+  void sub_scalar(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    for (slong i = 0; i < len; ++i) {
+      const mp_limb_t d = a[i] - b[i];
+      res[i] = a[i] < b[i] ? d + p : d;
+    }
+  }
+
+  void neg_scalar(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    for (slong i = 0; i < len; ++i) {
+      res[i] = a[i] ? p - a[i] : 0;
+    }
+  }
+
+  void reduce_scalar(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    for (slong i = 0; i < len; ++i) {
+      res[i] = a[i] >= p ? a[i] - p : a[i];
+    }
+  }
+
+  void scalar_mul_scalar(mp_limb_t* res, const mp_limb_t* a, slong len,
+                  mp_limb_t c, mp_limb_t c_shoup, mp_limb_t p) {
+    for (slong i = 0; i < len; ++i) {
+      const mp_limb_t r = a[i] * c - mulhi(a[i], c_shoup) * p;
+      res[i] = r >= p ? r - p : r;
+    }
+  }
+
+  void mul_scalar(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, nmod_t mod) {
+    for (slong i = 0; i < len; ++i) {
+      res[i] = n_mulmod2_preinv(a[i], b[i], mod.n, mod.ninv);
+    }
+  }
+
+  /** @brief Barrett constant \c{floor(2^(2.bits)/p)} of a prime of
+   *    \c bits bits, smaller than \c{2^(bits+1)}
+   */
+  mp_limb_t barrett(const mp_limb_t p, const unsigned int bits) {
+    if (2 * bits < FLINT_BITS) return (UWORD(1) << (2 * bits)) / p;
+
+    mp_limb_t q, r;
+    udiv_qrnnd(q, r, UWORD(1) << (2 * bits - FLINT_BITS), 0, p);
+    (void) r;
+    return q;
+  }
+
+  void add_lazy_scalar(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len) {
+    for (slong i = 0; i < len; ++i) {
+      res[i] = a[i] + b[i];
+    }
+  }
+
+  void sub_lazy_scalar(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t kp) {
+    for (slong i = 0; i < len; ++i) {
+      res[i] = a[i] + (kp - b[i]);
+    }
+  }
+
+
+  const Kernels kernels_scalar = { VecMod::SCALAR, "scalar",
+    add_scalar, sub_scalar, neg_scalar, reduce_scalar, scalar_mul_scalar,
+    add_lazy_scalar, sub_lazy_scalar, mul_scalar };
+
+#ifdef VEC_MOD_X86
+  /* AVX2 kernels, 4 residues per vector. Residues are smaller than 2^63,
+   *  so signed comparisons can be used. */
+
+  #define TARGET_AVX2 __attribute__((target("avx2")))
+
+  TARGET_AVX2 inline __m256i reduce_avx2(const __m256i x, const __m256i vp) {
+    const __m256i lt = _mm256_cmpgt_epi64(vp, x);
+    return _mm256_sub_epi64(x, _mm256_andnot_si256(lt, vp));
+  }
+
+  /** @brief 64x64 high product from 32x32 products
+   */
+  TARGET_AVX2 inline __m256i mulhi_avx2(const __m256i a, const __m256i b) {
+    const __m256i mask32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i a_hi = _mm256_srli_epi64(a, 32);
+    const __m256i b_hi = _mm256_srli_epi64(b, 32);
+    const __m256i lolo = _mm256_mul_epu32(a, b);
+    const __m256i lohi = _mm256_mul_epu32(a, b_hi);
+    const __m256i hilo = _mm256_mul_epu32(a_hi, b);
+    const __m256i hihi = _mm256_mul_epu32(a_hi, b_hi);
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(lolo, 32),
+                                   _mm256_and_si256(lohi, mask32));
+    mid = _mm256_add_epi64(mid, _mm256_and_si256(hilo, mask32));
+    __m256i hi = _mm256_add_epi64(hihi, _mm256_srli_epi64(lohi, 32));
+    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(hilo, 32));
+    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+  }
+
+  /** @brief 64x64 low product from 32x32 products
+   */
+  TARGET_AVX2 inline __m256i mullo_avx2(const __m256i a, const __m256i b) {
+    const __m256i lolo = _mm256_mul_epu32(a, b);
+    const __m256i lohi = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    const __m256i hilo = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    const __m256i mid = _mm256_slli_epi64(_mm256_add_epi64(lohi, hilo), 32);
+    return _mm256_add_epi64(lolo, mid);
+  }
+
+  TARGET_AVX2 void add_avx2(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    const __m256i vp = _mm256_set1_epi64x(p);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+      const __m256i s = _mm256_add_epi64(va, vb);
+      _mm256_storeu_si256((__m256i*)(res + i), reduce_avx2(s, vp));
+    }
+    add_scalar(res + i, a + i, b + i, len - i, p);
+  }
+
+  TARGET_AVX2 void sub_avx2(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    const __m256i vp = _mm256_set1_epi64x(p);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+      const __m256i lt = _mm256_cmpgt_epi64(vb, va);
+      const __m256i d = _mm256_add_epi64(_mm256_sub_epi64(va, vb),
+                                         _mm256_and_si256(lt, vp));
+      _mm256_storeu_si256((__m256i*)(res + i), d);
+    }
+    sub_scalar(res + i, a + i, b + i, len - i, p);
+  }
+
+  TARGET_AVX2 void neg_avx2(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    const __m256i vp = _mm256_set1_epi64x(p);
+    const __m256i zero = _mm256_setzero_si256();
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i eq = _mm256_cmpeq_epi64(va, zero);
+      const __m256i d = _mm256_andnot_si256(eq, _mm256_sub_epi64(vp, va));
+      _mm256_storeu_si256((__m256i*)(res + i), d);
+    }
+    neg_scalar(res + i, a + i, len - i, p);
+  }
+
+  TARGET_AVX2 void reduce_avx2(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    const __m256i vp = _mm256_set1_epi64x(p);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      _mm256_storeu_si256((__m256i*)(res + i), reduce_avx2(va, vp));
+    }
+    reduce_scalar(res + i, a + i, len - i, p);
+  }
+
+  TARGET_AVX2 void scalar_mul_avx2(mp_limb_t* res, const mp_limb_t* a, slong len,
+                  mp_limb_t c, mp_limb_t c_shoup, mp_limb_t p) {
+    const __m256i vp = _mm256_set1_epi64x(p);
+    const __m256i vc = _mm256_set1_epi64x(c);
+    const __m256i vcs = _mm256_set1_epi64x(c_shoup);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i q = mulhi_avx2(va, vcs);
+      const __m256i r = _mm256_sub_epi64(mullo_avx2(va, vc), mullo_avx2(q, vp));
+      _mm256_storeu_si256((__m256i*)(res + i), reduce_avx2(r, vp));
+    }
+    scalar_mul_scalar(res + i, a + i, len - i, c, c_shoup, p);
+  }
+
+  TARGET_AVX2 void add_lazy_avx2(mp_limb_t* res, const mp_limb_t* a,
+                  const mp_limb_t* b, slong len) {
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+      _mm256_storeu_si256((__m256i*)(res + i), _mm256_add_epi64(va, vb));
+    }
+    add_lazy_scalar(res + i, a + i, b + i, len - i);
+  }
+
+  TARGET_AVX2 void sub_lazy_avx2(mp_limb_t* res, const mp_limb_t* a,
+                  const mp_limb_t* b, slong len, mp_limb_t kp) {
+    const __m256i vkp = _mm256_set1_epi64x(kp);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+      const __m256i d = _mm256_add_epi64(va, _mm256_sub_epi64(vkp, vb));
+      _mm256_storeu_si256((__m256i*)(res + i), d);
+    }
+    sub_lazy_scalar(res + i, a + i, b + i, len - i, kp);
+  }
+
+
+  /* The product x < 2^(2.bits) of operands of at most bits bits is
+   *  reduced with Barrett's method: q = floor(floor(x/2^(bits-1)).m /
+   *  2^(bits+1)), with m the Barrett constant, underestimates x/p by at
+   *  most 2. Larger operands are first reduced with Shoup's
+   *  multiplication by 1. */
+
+  TARGET_AVX2 void mul_avx2(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, nmod_t mod) {
+    const unsigned int bits = FLINT_BITS - mod.norm;
+    const __m256i vp = _mm256_set1_epi64x(mod.n);
+    const __m256i vone = _mm256_set1_epi64x(VecMod::shoup(1, mod.n));
+    const __m256i vm = _mm256_set1_epi64x(barrett(mod.n, bits));
+    const __m128i top = _mm_cvtsi64_si128(bits);
+    const __m128i x_lo = _mm_cvtsi64_si128(bits - 1);
+    const __m128i x_hi = _mm_cvtsi64_si128(FLINT_BITS + 1 - bits);
+    const __m128i q_lo = _mm_cvtsi64_si128(bits + 1);
+    const __m128i q_hi = _mm_cvtsi64_si128(FLINT_BITS - 1 - bits);
+    slong i = 0;
+    for (; i + 4 <= len; i += 4) {
+      __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+      __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+      const __m256i big = _mm256_srl_epi64(_mm256_or_si256(va, vb), top);
+      if (not _mm256_testz_si256(big, big)) {
+        va = reduce_avx2(_mm256_sub_epi64(va, mullo_avx2(mulhi_avx2(va, vone), vp)), vp);
+        vb = reduce_avx2(_mm256_sub_epi64(vb, mullo_avx2(mulhi_avx2(vb, vone), vp)), vp);
+      }
+
+      const __m256i lo = mullo_avx2(va, vb);
+      const __m256i x = _mm256_or_si256(_mm256_sll_epi64(mulhi_avx2(va, vb), x_hi),
+                                        _mm256_srl_epi64(lo, x_lo));
+      const __m256i q = _mm256_or_si256(_mm256_sll_epi64(mulhi_avx2(x, vm), q_hi),
+                                        _mm256_srl_epi64(mullo_avx2(x, vm), q_lo));
+      /* r < 3p can exceed 2^63, r - p is negative as signed when r < p */
+      const __m256i r = _mm256_sub_epi64(lo, mullo_avx2(q, vp));
+      const __m256i d = _mm256_sub_epi64(r, vp);
+      const __m256i lt = _mm256_cmpgt_epi64(_mm256_setzero_si256(), d);
+      _mm256_storeu_si256((__m256i*)(res + i),
+                          reduce_avx2(_mm256_blendv_epi8(d, r, lt), vp));
+    }
+    mul_scalar(res + i, a + i, b + i, len - i, mod);
+  }
+
+
+  const Kernels kernels_avx2 = { VecMod::AVX2, "avx2",
+    add_avx2, sub_avx2, neg_avx2, reduce_avx2, scalar_mul_avx2,
+    add_lazy_avx2, sub_lazy_avx2, mul_avx2 };
+
+  /* AVX-512 kernels, 8 residues per vector. Conditional subtractions
+   *  use unsigned comparison masks. */
+
+  #define TARGET_AVX512 __attribute__((target("avx512f,avx512dq")))
+
+  /* GCC 12 AVX-512 intrinsics headers trigger spurious warnings */
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+  TARGET_AVX512 inline __m512i reduce_avx512(const __m512i x, const __m512i vp) {
+    return _mm512_mask_sub_epi64(x, _mm512_cmpge_epu64_mask(x, vp), x, vp);
+  }
+
+  TARGET_AVX512 inline __m512i mulhi_avx512(const __m512i a, const __m512i b) {
+    const __m512i mask32 = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i a_hi = _mm512_srli_epi64(a, 32);
+    const __m512i b_hi = _mm512_srli_epi64(b, 32);
+    const __m512i lolo = _mm512_mul_epu32(a, b);
+    const __m512i lohi = _mm512_mul_epu32(a, b_hi);
+    const __m512i hilo = _mm512_mul_epu32(a_hi, b);
+    const __m512i hihi = _mm512_mul_epu32(a_hi, b_hi);
+    __m512i mid = _mm512_add_epi64(_mm512_srli_epi64(lolo, 32),
+                                   _mm512_and_si512(lohi, mask32));
+    mid = _mm512_add_epi64(mid, _mm512_and_si512(hilo, mask32));
+    __m512i hi = _mm512_add_epi64(hihi, _mm512_srli_epi64(lohi, 32));
+    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(hilo, 32));
+    return _mm512_add_epi64(hi, _mm512_srli_epi64(mid, 32));
+  }
+
+  TARGET_AVX512 void add_avx512(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    const __m512i vp = _mm512_set1_epi64(p);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      const __m512i s = _mm512_add_epi64(_mm512_loadu_si512(a + i),
+                                         _mm512_loadu_si512(b + i));
+      _mm512_storeu_si512(res + i, reduce_avx512(s, vp));
+    }
+    add_scalar(res + i, a + i, b + i, len - i, p);
+  }
+
+  TARGET_AVX512 void sub_avx512(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, mp_limb_t p) {
+    const __m512i vp = _mm512_set1_epi64(p);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      const __m512i va = _mm512_loadu_si512(a + i);
+      const __m512i vb = _mm512_loadu_si512(b + i);
+      const __m512i d = _mm512_sub_epi64(va, vb);
+      _mm512_storeu_si512(res + i, _mm512_mask_add_epi64(d,
+                              _mm512_cmplt_epu64_mask(va, vb), d, vp));
+    }
+    sub_scalar(res + i, a + i, b + i, len - i, p);
+  }
+
+  TARGET_AVX512 void neg_avx512(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    const __m512i vp = _mm512_set1_epi64(p);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      const __m512i d = _mm512_sub_epi64(vp, _mm512_loadu_si512(a + i));
+      _mm512_storeu_si512(res + i, reduce_avx512(d, vp));
+    }
+    neg_scalar(res + i, a + i, len - i, p);
+  }
+
+  TARGET_AVX512 void reduce_avx512(mp_limb_t* res, const mp_limb_t* a, slong len, mp_limb_t p) {
+    const __m512i vp = _mm512_set1_epi64(p);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      _mm512_storeu_si512(res + i, reduce_avx512(_mm512_loadu_si512(a + i), vp));
+    }
+    reduce_scalar(res + i, a + i, len - i, p);
+  }
+
+  TARGET_AVX512 void scalar_mul_avx512(mp_limb_t* res, const mp_limb_t* a, slong len,
+                  mp_limb_t c, mp_limb_t c_shoup, mp_limb_t p) {
+    const __m512i vp = _mm512_set1_epi64(p);
+    const __m512i vc = _mm512_set1_epi64(c);
+    const __m512i vcs = _mm512_set1_epi64(c_shoup);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      const __m512i va = _mm512_loadu_si512(a + i);
+      const __m512i q = mulhi_avx512(va, vcs);
+      const __m512i r = _mm512_sub_epi64(_mm512_mullo_epi64(va, vc),
+                                         _mm512_mullo_epi64(q, vp));
+      _mm512_storeu_si512(res + i, reduce_avx512(r, vp));
+    }
+    scalar_mul_scalar(res + i, a + i, len - i, c, c_shoup, p);
+  }
+
+  TARGET_AVX512 void add_lazy_avx512(mp_limb_t* res, const mp_limb_t* a,
+                  const mp_limb_t* b, slong len) {
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      _mm512_storeu_si512(res + i, _mm512_add_epi64(_mm512_loadu_si512(a + i),
+                                                    _mm512_loadu_si512(b + i)));
+    }
+    add_lazy_scalar(res + i, a + i, b + i, len - i);
+  }
+
+  TARGET_AVX512 void sub_lazy_avx512(mp_limb_t* res, const mp_limb_t* a,
+                  const mp_limb_t* b, slong len, mp_limb_t kp) {
+    const __m512i vkp = _mm512_set1_epi64(kp);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      const __m512i d = _mm512_sub_epi64(vkp, _mm512_loadu_si512(b + i));
+      _mm512_storeu_si512(res + i, _mm512_add_epi64(_mm512_loadu_si512(a + i), d));
+    }
+    sub_lazy_scalar(res + i, a + i, b + i, len - i, kp);
+  }
+
+
+  TARGET_AVX512 void mul_avx512(mp_limb_t* res, const mp_limb_t* a, const mp_limb_t* b,
+                  slong len, nmod_t mod) {
+    const unsigned int bits = FLINT_BITS - mod.norm;
+    const __m512i vp = _mm512_set1_epi64(mod.n);
+    const __m512i vone = _mm512_set1_epi64(VecMod::shoup(1, mod.n));
+    const __m512i vm = _mm512_set1_epi64(barrett(mod.n, bits));
+    const __m128i top = _mm_cvtsi64_si128(bits);
+    const __m128i x_lo = _mm_cvtsi64_si128(bits - 1);
+    const __m128i x_hi = _mm_cvtsi64_si128(FLINT_BITS + 1 - bits);
+    const __m128i q_lo = _mm_cvtsi64_si128(bits + 1);
+    const __m128i q_hi = _mm_cvtsi64_si128(FLINT_BITS - 1 - bits);
+    slong i = 0;
+    for (; i + 8 <= len; i += 8) {
+      __m512i va = _mm512_loadu_si512(a + i);
+      __m512i vb = _mm512_loadu_si512(b + i);
+      const __m512i big = _mm512_srl_epi64(_mm512_or_si512(va, vb), top);
+      if (_mm512_test_epi64_mask(big, big)) {
+        va = reduce_avx512(_mm512_sub_epi64(va,
+                _mm512_mullo_epi64(mulhi_avx512(va, vone), vp)), vp);
+        vb = reduce_avx512(_mm512_sub_epi64(vb,
+                _mm512_mullo_epi64(mulhi_avx512(vb, vone), vp)), vp);
+      }
+
+      const __m512i lo = _mm512_mullo_epi64(va, vb);
+      const __m512i x = _mm512_or_si512(_mm512_sll_epi64(mulhi_avx512(va, vb), x_hi),
+                                        _mm512_srl_epi64(lo, x_lo));
+      const __m512i q = _mm512_or_si512(_mm512_sll_epi64(mulhi_avx512(x, vm), q_hi),
+                                        _mm512_srl_epi64(_mm512_mullo_epi64(x, vm), q_lo));
+      const __m512i r = _mm512_sub_epi64(lo, _mm512_mullo_epi64(q, vp));
+      _mm512_storeu_si512(res + i, reduce_avx512(reduce_avx512(r, vp), vp));
+    }
+    mul_scalar(res + i, a + i, b + i, len - i, mod);
+  }
+
+
+  const Kernels kernels_avx512 = { VecMod::AVX512, "avx512",
+    add_avx512, sub_avx512, neg_avx512, reduce_avx512, scalar_mul_avx512,
+    add_lazy_avx512, sub_lazy_avx512, mul_avx512 };
+
+  #pragma GCC diagnostic pop
+#endif
+
+  /** @brief Best implementation supported by the CPU, not above \c max_isa
+   */
+  const Kernels* best_kernels(const VecMod::Isa max_isa) {
+#ifdef VEC_MOD_X86
+    __builtin_cpu_init();
+    if (max_isa >= VecMod::AVX512 and __builtin_cpu_supports("avx512f")
+        and __builtin_cpu_supports("avx512dq")) {
+      return &kernels_avx512;
+    }
+    if (max_isa >= VecMod::AVX2 and __builtin_cpu_supports("avx2")) {
+      return &kernels_avx2;
+    }
+#endif
+    return &kernels_scalar;
+  }
+
+  const Kernels* kernels = best_kernels(VecMod::AVX512);
+}
+
+/** @brief See header for a description
+ */
+VecMod::Isa VecMod::isa() {
+  return kernels->isa;
+}
+
+/** @brief See header for a description
+ */
+const char* VecMod::isaName() {
+  return kernels->name;
+}
+
+/** @brief See header for a description
+ */
+void VecMod::select(const Isa isa) {
+  kernels = best_kernels(isa);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::add(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b, const slong len, const mp_limb_t p) {
+  kernels->add(res, a, b, len, p);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::sub(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b, const slong len, const mp_limb_t p) {
+  kernels->sub(res, a, b, len, p);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::neg(mp_limb_t* const res, const mp_limb_t* const a,
+                  const slong len, const mp_limb_t p) {
+  kernels->neg(res, a, len, p);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::add_lazy(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b, const slong len) {
+  kernels->add_lazy(res, a, b, len);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::sub_lazy(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b, const slong len, const mp_limb_t kp) {
+  kernels->sub_lazy(res, a, b, len, kp);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::reduce(mp_limb_t* const res, const mp_limb_t* const a,
+                  const slong len, const mp_limb_t p) {
+  kernels->reduce(res, a, len, p);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::scalar_mul(mp_limb_t* const res, const mp_limb_t* const a,
+                  const slong len, const mp_limb_t c, const mp_limb_t c_shoup,
+                  const mp_limb_t p) {
+  kernels->scalar_mul(res, a, len, c, c_shoup, p);
+}
+
+/** @brief See header for a description
+ */
+void VecMod::mul(mp_limb_t* const res, const mp_limb_t* const a,
+                  const mp_limb_t* const b, const slong len, const nmod_t mod) {
+  kernels->mul(res, a, b, len, mod);
+}
+
+/** @brief See header for a description
+ */
+mp_limb_t VecMod::shoup(const mp_limb_t c, const mp_limb_t p) {
+  mp_limb_t q, r;
+  udiv_qrnnd(q, r, c, 0, p);
+  (void) r;
+  return q;
+}
@@ -0,0 +1,121 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file fhe_test.hxx
+ * @brief Test fixture with small FHE parameters and keys
+ */
+
+#ifndef __FHE_TEST_HXX__
+#define __FHE_TEST_HXX__
+
+#include "fv.hxx"
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Fixture binding small parameters (keys are generated in a few
+ *  milliseconds) and keys in a temporary directory
+ */
+class FheTest: public ::testing::Test {
+  protected:
+    std::string dir;
+
+    /* keys are bound to the context current at their construction */
+    std::unique_ptr<KeysAll> keys;
+
+    /** @brief XML elements added to the parameters
+     */
+    virtual const char* extraParams() const {
+      return "";
+    }
+
+    void SetUp() override {
+      char tmpl[] = "/tmp/fhe_test_XXXXXX";
+      ASSERT_NE(mkdtemp(tmpl), nullptr);
+      dir = tmpl;
+
+      writeParams(path("fhe_params.xml"), extraParams());
+      FheParams::readXml(path("fhe_params.xml").c_str());
+
+      KeyGen keygen;
+      keygen.generateKeys();
+      keygen.writeKeys(path("fhe_key"));
+      keys.reset(new KeysAll());
+      keys->readKeys(path("fhe_key"));
+    }
+
+    void TearDown() override {
+      ASSERT_EQ(system(("rm -rf " + dir).c_str()), 0);
+    }
+
+    /** @brief Write the test parameters to a file
+     *
+     *  @param extra XML elements added to the parameters
+     *  @param linearization XML elements added to the linearization ones
+     */
+    static void writeParams(const std::string& fileName,
+        const std::string& extra, const std::string& linearization = "") {
+      FILE* stream = fopen(fileName.c_str(), "w");
+      fprintf(stream,
+        "<?xml version=\"1.0\"?>\n"
+        "<fhe_params>\n"
+        "  <polynomial_ring><cyclotomic_polynomial><index>512</index></cyclotomic_polynomial></polynomial_ring>\n"
+        "  <plaintext><coeff_modulo>2</coeff_modulo></plaintext>\n"
+        "  <ciphertext><coeff_modulo_log2>200</coeff_modulo_log2><normal_distribution><sigma>3.19</sigma><bound>41</bound></normal_distribution></ciphertext>\n"
+        "  <linearization>%s<coeff_modulo_log2>220</coeff_modulo_log2><normal_distribution><sigma_k>3</sigma_k><bound_k>30</bound_k></normal_distribution></linearization>\n"
+        "  <secret_key><hamming_weight>63</hamming_weight></secret_key>\n"
+        "  %s\n"
+        "</fhe_params>\n", linearization.c_str(), extra.c_str());
+      fclose(stream);
+    }
+
+    /** @brief Path of a file in the test directory
+     */
+    std::string path(const std::string& name) const {
+      return dir + "/" + name;
+    }
+
+    CipherText encrypt(const unsigned int bit) const {
+      return EncDec::Encrypt(bit, *keys->PublicKey);
+    }
+
+    unsigned int decrypt(const CipherText& ct) const {
+      return EncDec::Decrypt(ct, *keys->SecretKey);
+    }
+};
+
+/**
+ * @brief Fixture \c Base with RNS arithmetic
+ */
+template <class Base>
+class WithRns: public Base {
+  protected:
+    const char* extraParams() const override {
+      return "<rns><prime_bitsize>60</prime_bitsize></rns>";
+    }
+};
+
+#endif
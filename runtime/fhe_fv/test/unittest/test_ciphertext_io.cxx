@@ -0,0 +1,426 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_ciphertext_io.cxx
+ * @brief Round trips and corruptions of the compact ciphertext container
+ */
+
+#include "fhe_test.hxx"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/* Container header fields, see CipherText::write */
+static const size_t VERSION_OFFSET = 4;
+static const size_t BASE_OFFSET = 7;
+static const size_t FINGERPRINT_OFFSET = 8;
+static const size_t LEVEL_OFFSET = 16;
+static const size_t HEADER_SIZE = 32;
+
+static vector<unsigned char> readBytes(FILE* const stream) {
+  vector<unsigned char> bytes;
+  unsigned char buff[4096];
+  size_t r;
+  while ((r = fread(buff, 1, sizeof(buff), stream)) > 0) {
+    bytes.insert(bytes.end(), buff, buff + r);
+  }
+  return bytes;
+}
+
+static vector<unsigned char> readBytes(const string& fileName) {
+  FILE* stream = fopen(fileName.c_str(), "rb");
+  vector<unsigned char> bytes = readBytes(stream);
+  fclose(stream);
+  return bytes;
+}
+
+static void writeBytes(const string& fileName, const vector<unsigned char>& bytes) {
+  FILE* stream = fopen(fileName.c_str(), "wb");
+  fwrite(bytes.data(), 1, bytes.size(), stream);
+  fclose(stream);
+}
+
+/* Compact container of a ciphertext, written to a stream */
+static vector<unsigned char> image(const CipherText& ct) {
+  FILE* stream = tmpfile();
+  ct.write(stream);
+  rewind(stream);
+  vector<unsigned char> bytes = readBytes(stream);
+  fclose(stream);
+  return bytes;
+}
+
+class CiphertextIo: public FheTest {
+  protected:
+    void SetUp() override {
+      FheTest::SetUp();
+      CipherText::WriteChecksum = true;
+    }
+
+    void TearDown() override {
+      CipherText::WriteChecksum = true;
+      FheTest::TearDown();
+    }
+
+    /* Write the container of an encryption of 1 and return it */
+    vector<unsigned char> container(const string& name) const {
+      encrypt(1).write(path(name));
+      return readBytes(path(name));
+    }
+};
+
+typedef WithRns<CiphertextIo> CiphertextIoRns;
+
+TEST_F(CiphertextIo, RoundTripFile) {
+  for (unsigned int bit = 0; bit < 2; ++bit) {
+    const CipherText ct = encrypt(bit);
+    ct.write(path("ct"));
+
+    const vector<unsigned char> bytes = readBytes(path("ct"));
+    ASSERT_GE(bytes.size(), HEADER_SIZE);
+    EXPECT_EQ(string(bytes.begin(), bytes.begin() + 4), "CGCT");
+
+    CipherText res;
+    res.read(path("ct"));
+    EXPECT_EQ(res.size(), ct.size());
+    EXPECT_EQ(image(res), image(ct));
+    EXPECT_EQ(decrypt(res), bit);
+  }
+}
+
+TEST_F(CiphertextIo, RoundTripStream) {
+  const CipherText ct = encrypt(1);
+  FILE* stream = tmpfile();
+  ct.write(stream);
+  ct.write(stream);
+  rewind(stream);
+
+  /* containers are read one after the other */
+  CipherText res1, res2;
+  res1.read(stream);
+  res2.read(stream);
+  fclose(stream);
+
+  EXPECT_EQ(image(res1), image(ct));
+  EXPECT_EQ(image(res2), image(ct));
+}
+
+TEST_F(CiphertextIo, RoundTripWithoutChecksum) {
+  const CipherText ct = encrypt(1);
+  const size_t size = image(ct).size();
+
+  CipherText::WriteChecksum = false;
+  ct.write(path("ct"));
+  EXPECT_EQ(readBytes(path("ct")).size(), size - 8);
+
+  CipherText res;
+  res.read(path("ct"));
+  EXPECT_EQ(decrypt(res), 1u);
+}
+
+TEST_F(CiphertextIo, RoundTripSeeded) {
+  PolyRing pTxt;
+  pTxt.setCoeffUi(0, 1);
+  const CipherText ct = EncDec::EncryptPoly(pTxt, *keys->SecretKey);
+  ct.write(path("ct"));
+
+  CipherText res;
+  res.read(path("ct"));
+  EXPECT_EQ(image(res), image(ct));
+  EXPECT_EQ(decrypt(res), 1u);
+}
+
+TEST_F(CiphertextIo, LegacyText) {
+  const CipherText ct = encrypt(1);
+  ct.write(path("ct"), false);
+
+  CipherText res;
+  res.read(path("ct"), false);
+  EXPECT_EQ(image(res), image(ct));
+}
+
+TEST_F(CiphertextIo, LegacyBinary) {
+  /* size followed by the polynomials, as written before containers */
+  const CipherText ct = encrypt(1);
+  FILE* stream = fopen(path("ct").c_str(), "wb");
+  fmpz_t size;
+  fmpz_init_set_ui(size, ct.size());
+  PolyRing::write_fmpz(stream, size, true);
+  fmpz_clear(size);
+  for (unsigned int i = 0; i < ct.size(); ++i) {
+    ct[i].write(stream, true);
+  }
+  fclose(stream);
+
+  CipherText res;
+  res.read(path("ct"));
+  EXPECT_EQ(image(res), image(ct));
+
+  stream = fopen(path("ct").c_str(), "rb");
+  CipherText res2;
+  res2.read(stream);
+  fclose(stream);
+  EXPECT_EQ(image(res2), image(ct));
+}
+
+TEST_F(CiphertextIo, UnsupportedVersion) {
+  vector<unsigned char> bytes = container("ct");
+  bytes[VERSION_OFFSET]++;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "unsupported ciphertext format version");
+}
+
+TEST_F(CiphertextIo, FingerprintMismatch) {
+  vector<unsigned char> bytes = container("ct");
+  bytes[FINGERPRINT_OFFSET] ^= 1;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "written with other FHE parameters");
+}
+
+TEST_F(CiphertextIo, FingerprintCoversRelinearization) {
+  const uint64_t fingerprint = FheParams::get().Fingerprint;
+
+  const string paramsFile = path("fhe_params_relin.xml");
+  writeParams(paramsFile, extraParams(),
+              "<version>1</version><decomposition_base_log2>16</decomposition_base_log2>");
+
+  FheContext::Scope scope(FheContext::create(paramsFile));
+  EXPECT_NE(FheParams::get().Fingerprint, fingerprint);
+}
+
+TEST_F(CiphertextIo, OperandsFromOtherContext) {
+  CipherText ct1 = encrypt(1);
+  const CipherText ct2 = encrypt(0);
+
+  /* same parameters, but another context */
+  {
+    FheContext::Scope scope(FheContext::create(path("fhe_params.xml")));
+    EXPECT_DEBUG_DEATH(CipherText::add(ct1, ct2), "context");
+
+    CipherText res;
+    EXPECT_DEBUG_DEATH(CipherText::add(res, ct1, ct2), "context");
+  }
+
+  CipherText::add(ct1, ct2);
+  EXPECT_EQ(decrypt(ct1), 1u);
+}
+
+TEST_F(CiphertextIo, LevelOutOfChain) {
+  vector<unsigned char> bytes = container("ct");
+  bytes[LEVEL_OFFSET] = 99;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "not in the modulus chain");
+}
+
+TEST_F(CiphertextIo, TruncatedHeader) {
+  vector<unsigned char> bytes = container("ct");
+  bytes.resize(HEADER_SIZE / 2);
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "truncated ciphertext header");
+}
+
+TEST_F(CiphertextIo, TruncatedBody) {
+  vector<unsigned char> bytes = container("ct");
+  bytes.resize(bytes.size() - 10);
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "truncated ciphertext");
+
+  EXPECT_EXIT({
+      FILE* stream = fopen(path("ct").c_str(), "rb");
+      res.read(stream);
+    }, ::testing::ExitedWithCode(255), "truncated ciphertext");
+}
+
+TEST_F(CiphertextIo, ChecksumMismatch) {
+  vector<unsigned char> bytes = container("ct");
+  bytes[HEADER_SIZE + 1] ^= 1;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "checksum mismatch");
+}
+
+TEST_F(CiphertextIoRns, RoundTripModSwitched) {
+  CipherText ct = encrypt(1);
+  CipherText::toRns(ct);
+  ASSERT_GT(FheParams::get().ModChain.size(), 1u);
+  CipherText::mod_switch(ct, 1);
+  ct.write(path("ct"));
+
+  CipherText res;
+  res.read(path("ct"));
+  EXPECT_EQ(res.level(), 1u);
+  EXPECT_EQ(image(res), image(ct));
+  EXPECT_EQ(decrypt(res), 1u);
+}
+
+TEST_F(CiphertextIoRns, RoundTripResidues) {
+  for (unsigned int level = 0; level < 2; ++level) {
+    for (unsigned int ntt = 0; ntt < 2; ++ntt) {
+      CipherText ct = encrypt(1);
+      CipherText::toRns(ct);
+      CipherText::mod_switch(ct, level);
+      if (ntt) CipherText::toNtt(ct);
+      ct.writeRns(path("ct"));
+
+      /* residues are used in place from the file mapping */
+      CipherText res;
+      res.read(path("ct"));
+      EXPECT_TRUE(res.isRns());
+      EXPECT_EQ(res.isNtt(), ntt == 1);
+      EXPECT_EQ(res.level(), level);
+      EXPECT_EQ(image(res), image(ct));
+
+      /* and copied from streams */
+      FILE* stream = fopen(path("ct").c_str(), "rb");
+      CipherText res2;
+      res2.read(stream);
+      fclose(stream);
+      EXPECT_TRUE(res2.isRns());
+      EXPECT_EQ(image(res2), image(ct));
+
+      /* in place residues are copied before being modified */
+      const vector<unsigned char> bytes = readBytes(path("ct"));
+      CipherText::add(res, res2);
+      EXPECT_EQ(readBytes(path("ct")), bytes);
+      CipherText res3;
+      res3.read(path("ct"));
+      EXPECT_EQ(image(res3), image(ct));
+    }
+  }
+}
+
+/* Residues of a ciphertext, as they are in memory */
+static vector<mp_limb_t> residues(const CipherText& ct) {
+  vector<mp_limb_t> limbs;
+  for (unsigned int i = 0; i < ct.size(); ++i) {
+    const mp_limb_t* const p = ct.rns(i).limb(0);
+    limbs.insert(limbs.end(), p, p + ct.rns(i).size() * FheParams::get().D);
+  }
+  return limbs;
+}
+
+TEST_F(CiphertextIoRns, MappedResiduesAreReadOnly) {
+  CipherText ct = encrypt(1);
+  CipherText::toRns(ct);
+  CipherText::toNtt(ct);
+  ct.writeRns(path("ct"));
+
+  CipherText res;
+  res.read(path("ct"));
+  EXPECT_EXIT(res.rns(0).limb(0)[0]++, ::testing::KilledBySignal(SIGSEGV), "");
+}
+
+TEST_F(CiphertextIoRns, MappedResiduesAreUnchanged) {
+  typedef void (*InPlace)(CipherText&, const CipherText&);
+  const vector<pair<string, InPlace>> opers = {
+    {"add", [](CipherText& ct, const CipherText& ct2) { CipherText::add(ct, ct2); }},
+    {"sub", [](CipherText& ct, const CipherText& ct2) { CipherText::sub(ct, ct2); }},
+    {"mod_switch", [](CipherText& ct, const CipherText&) { CipherText::mod_switch(ct, 1); }},
+    {"fromNtt", [](CipherText& ct, const CipherText&) { CipherText::fromNtt(ct); }},
+    {"modulo", [](CipherText& ct, const CipherText&) {
+      CipherText::modulo(ct, FheParams::get().Q);
+    }},
+  };
+
+  CipherText ct = encrypt(1);
+  CipherText::toRns(ct);
+  CipherText::toNtt(ct);
+  ct.writeRns(path("ct"));
+
+  for (const auto& oper: opers) {
+    /* the result leaves the read-only mapping, which could not be
+        written, and the mapped operand stays in place */
+    CipherText res, other;
+    res.read(path("ct"));
+    other.read(path("ct"));
+    const vector<mp_limb_t> limbs = residues(other);
+    const mp_limb_t* const mapped = res.rns(0).limb(0);
+
+    CipherText expected(ct);
+    oper.second(expected, ct);
+    oper.second(res, other);
+    EXPECT_NE(res.rns(0).limb(0), mapped) << oper.first;
+    EXPECT_EQ(image(res), image(expected)) << oper.first;
+    EXPECT_EQ(residues(other), limbs) << oper.first;
+    EXPECT_EQ(residues(other), residues(ct)) << oper.first;
+  }
+
+  /* toNtt of residues in NTT form keeps them in place */
+  CipherText res;
+  res.read(path("ct"));
+  const mp_limb_t* const mapped = res.rns(0).limb(0);
+  CipherText::toNtt(res);
+  EXPECT_EQ(res.rns(0).limb(0), mapped);
+  CipherText::fromNtt(res);
+  CipherText::toNtt(res);
+  EXPECT_NE(res.rns(0).limb(0), mapped);
+  EXPECT_EQ(image(res), image(ct));
+}
+
+TEST_F(CiphertextIoRns, ResidueBaseMismatch) {
+  CipherText ct = encrypt(1);
+  CipherText::toRns(ct);
+  ct.writeRns(path("ct"));
+
+  vector<unsigned char> bytes = readBytes(path("ct"));
+  bytes[BASE_OFFSET] = 0;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "does not match the RNS parameters");
+}
+
+TEST_F(CiphertextIoRns, ResidueChecksumMismatch) {
+  CipherText ct = encrypt(1);
+  CipherText::toRns(ct);
+  ct.writeRns(path("ct"));
+
+  vector<unsigned char> bytes = readBytes(path("ct"));
+  bytes[bytes.size() - 20] ^= 1;
+  writeBytes(path("ct"), bytes);
+
+  CipherText res;
+  EXPECT_EXIT(res.read(path("ct")), ::testing::ExitedWithCode(255),
+              "checksum mismatch");
+}
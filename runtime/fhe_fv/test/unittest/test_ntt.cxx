@@ -0,0 +1,165 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_ntt.cxx
+ * @brief Negacyclic transforms against coefficient domain arithmetic
+ */
+
+#include "ntt.hxx"
+#include "rns_base.hxx"
+
+#include <flint/fmpz_poly.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using namespace std;
+
+typedef vector<mp_limb_t> Coeffs;
+
+/* 62-bit primes are the largest the lazy butterflies allow, values
+    reach 4p there */
+static const unsigned int PRIME_BITSIZE = 62;
+static const unsigned int LENGTHS[] = {8, 256, 4096};
+
+static Coeffs randomCoeffs(mt19937_64& rng, const unsigned int n,
+    const mp_limb_t p) {
+  Coeffs a(n);
+  for (mp_limb_t& c: a) {
+    c = rng() % p;
+  }
+  return a;
+}
+
+/* Random polynomials and the ones with all coefficients p-1 */
+static vector<Coeffs> operands(mt19937_64& rng, const unsigned int n,
+    const mp_limb_t p) {
+  return {randomCoeffs(rng, n, p), randomCoeffs(rng, n, p), Coeffs(n, p - 1)};
+}
+
+/* a.b mod (X^n+1, p) with FLINT integer polynomials */
+static Coeffs negacyclicProduct(const Coeffs& a, const Coeffs& b,
+    const mp_limb_t p) {
+  const unsigned int n = a.size();
+  fmpz_poly_t x, y;
+  fmpz_poly_init(x);
+  fmpz_poly_init(y);
+  for (unsigned int i = 0; i < n; ++i) {
+    fmpz_poly_set_coeff_ui(x, i, a[i]);
+    fmpz_poly_set_coeff_ui(y, i, b[i]);
+  }
+  fmpz_poly_mul(x, x, y);
+
+  fmpz_t c, hi, m;
+  fmpz_init(c);
+  fmpz_init(hi);
+  fmpz_init_set_ui(m, p);
+  Coeffs res(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    fmpz_poly_get_coeff_fmpz(c, x, i);
+    fmpz_poly_get_coeff_fmpz(hi, x, i + n);
+    fmpz_sub(c, c, hi);
+    fmpz_mod(c, c, m);
+    res[i] = fmpz_get_ui(c);
+  }
+  fmpz_clear(c);
+  fmpz_clear(hi);
+  fmpz_clear(m);
+  fmpz_poly_clear(x);
+  fmpz_poly_clear(y);
+  return res;
+}
+
+/* a(X^k) mod (X^n+1, p), X^n is -1 */
+static Coeffs automorphism(const Coeffs& a, const unsigned int k,
+    const mp_limb_t p) {
+  const unsigned int n = a.size();
+  Coeffs res(n, 0);
+  for (unsigned int i = 0; i < n; ++i) {
+    const unsigned int e = (unsigned int)(((uint64_t)i * k) % (2 * n));
+    if (e < n) {
+      res[e] = a[i];
+    } else {
+      res[e - n] = a[i] == 0 ? 0 : p - a[i];
+    }
+  }
+  return res;
+}
+
+TEST(Ntt, ForwardInverse) {
+  mt19937_64 rng(1);
+  for (const unsigned int n: LENGTHS) {
+    for (const mp_limb_t p: RnsBase::generatePrimes(2, PRIME_BITSIZE, 2 * n)) {
+      const Ntt ntt(n, p);
+      for (const Coeffs& a: operands(rng, n, p)) {
+        Coeffs b = a;
+        ntt.forward(b.data());
+        for (const mp_limb_t c: b) {
+          ASSERT_LT(c, p) << "n " << n << ", p " << p;
+        }
+        ntt.inverse(b.data());
+        EXPECT_EQ(b, a) << "n " << n << ", p " << p;
+      }
+    }
+  }
+}
+
+TEST(Ntt, Convolve) {
+  mt19937_64 rng(2);
+  for (const unsigned int n: LENGTHS) {
+    for (const mp_limb_t p: RnsBase::generatePrimes(2, PRIME_BITSIZE, 2 * n)) {
+      const Ntt ntt(n, p);
+      const vector<Coeffs> ops = operands(rng, n, p);
+      for (const Coeffs& a: ops) {
+        for (const Coeffs& b: ops) {
+          Coeffs res(n);
+          ntt.convolve(res.data(), a.data(), b.data());
+          EXPECT_EQ(res, negacyclicProduct(a, b, p)) << "n " << n << ", p " << p;
+        }
+      }
+    }
+  }
+}
+
+TEST(Ntt, GaloisPermutation) {
+  mt19937_64 rng(3);
+  for (const unsigned int n: LENGTHS) {
+    const mp_limb_t p = RnsBase::generatePrimes(1, PRIME_BITSIZE, 2 * n)[0];
+    const Ntt ntt(n, p);
+    const Coeffs a = randomCoeffs(rng, n, p);
+    Coeffs ntta = a;
+    ntt.forward(ntta.data());
+
+    for (const unsigned int k: {3u, 5u, 2 * n - 1, n + 1, 2 * n - 3}) {
+      const vector<unsigned int> perm = Ntt::galoisPermutation(n, k);
+      ASSERT_EQ(perm.size(), n);
+
+      Coeffs expected = automorphism(a, k, p);
+      ntt.forward(expected.data());
+      Coeffs permuted(n);
+      for (unsigned int i = 0; i < n; ++i) {
+        permuted[i] = ntta[perm[i]];
+      }
+      EXPECT_EQ(permuted, expected) << "n " << n << ", k " << k;
+    }
+  }
+}
@@ -0,0 +1,167 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_prg.cxx
+ * @brief ChaCha20 known answers and keystream chunking of the generator
+ */
+
+#include "prg.hxx"
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static vector<unsigned char> fromHex(const string& hex) {
+  vector<unsigned char> bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back((unsigned char)stoul(hex.substr(i, 2), nullptr, 16));
+  }
+  return bytes;
+}
+
+static Prg::Seed seedOf(const string& hex) {
+  const vector<unsigned char> bytes = fromHex(hex);
+  Prg::Seed seed;
+  copy(bytes.begin(), bytes.end(), seed.begin());
+  return seed;
+}
+
+static vector<unsigned char> keystream(Prg& prg, const size_t len) {
+  vector<unsigned char> bytes(len);
+  prg.bytes(bytes.data(), len);
+  return bytes;
+}
+
+/* Original ChaCha20 vectors (64-bit counter and nonce) of
+    draft-agl-tls-chacha20poly1305 and
+    draft-strombergson-chacha-test-vectors, the nonce is given as the
+    little-endian stream index */
+static const struct {
+  const char* key;
+  uint64_t stream;
+  const char* keystream;
+} VECTORS[] = {
+  {"0000000000000000000000000000000000000000000000000000000000000000", 0,
+   "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+   "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586"
+   "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+   "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f"},
+  {"0000000000000000000000000000000000000000000000000000000000000001", 0,
+   "4540f05a9f1fb296d7736e7b208e3c96eb4fe1834688d2604f450952ed432d41"
+   "bbe2a0b6ea7566d2a5d1e7e20d42af2c53d792b1c43fea817e9ad275ae546963"},
+  {"0000000000000000000000000000000000000000000000000000000000000000",
+   0x0100000000000000ull,
+   "de9cba7bf3d69ef5e786dc63973f653a0b49e015adbff7134fcb7df137821031"
+   "e85a050278a7084527214f73efc7fa5b5277062eb7a0433e445f41e3"},
+  {"0000000000000000000000000000000000000000000000000000000000000000", 1,
+   "ef3fdfd6c61578fbf5cf35bd3dd33b8009631634d21e42ac33960bd138e50d32"
+   "111e4caf237ee53ca8ad6426194a88545ddc497a0b466e7d6bbdb0041b2f586b"},
+  {"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+   0x0706050403020100ull,
+   "f798a189f195e66982105ffb640bb7757f579da31602fc93ec01ac56f85ac3c1"
+   "34a4547b733b46413042c9440049176905d3be59ea1c53f15916155c2be8241a"
+   "38008b9a26bc35941e2444177c8ade6689de95264986d95889fb60e84629c9bd"
+   "9a5acb1cc118be563eb9b3a4a472f82e09a7e778492b562ef7130e88dfe031c7"
+   "9db9d4f7c7a899151b9a475032b63fc385245fe054e3dd5a97a5f576fe064025"
+   "d3ce042c566ab2c507b138db853e3d6959660996546cc9c4a6eafdc777c040d7"
+   "0eaf46f76dad3979e5c5360c3317166a1c894c94a371876a94df7628fe4eaaf2"
+   "ccb27d5aaae0ad7ad0f9d4b6ad3b54098746d4524d38407a6deb3ab78fab78c9"},
+};
+
+TEST(Prg, KnownAnswers) {
+  for (const auto& v: VECTORS) {
+    const vector<unsigned char> expected = fromHex(v.keystream);
+    Prg prg(seedOf(v.key), v.stream);
+    EXPECT_EQ(keystream(prg, expected.size()), expected) << v.key << " " << v.stream;
+  }
+}
+
+TEST(Prg, BlockFunction) {
+  /* RFC 7539, section 2.3.2: the 32-bit counter and 96-bit nonce fill
+      the same words as the 64-bit counter and nonce */
+  const uint32_t in[16] = {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+    0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c,
+    0x13121110, 0x17161514, 0x1b1a1918, 0x1f1e1d1c,
+    0x00000001, 0x09000000, 0x4a000000, 0x00000000,
+  };
+  const uint32_t expected[16] = {
+    0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3,
+    0xc7f4d1c7, 0x0368c033, 0x9aaa2204, 0x4e6cd4c3,
+    0x466482d2, 0x09aa9f07, 0x05d7c214, 0xa2028bd9,
+    0xd19c12b5, 0xb94e16de, 0xe883d0cb, 0x4e3c50a2,
+  };
+
+  uint32_t out[16];
+  Prg::chacha20(out, in);
+  for (unsigned int i = 0; i < 16; ++i) {
+    EXPECT_EQ(out[i], expected[i]) << "word " << i;
+  }
+}
+
+TEST(Prg, ChunkedBytes) {
+  /* Chunks start and end inside blocks and on block boundaries, whole
+      blocks of a request bypass the internal buffer */
+  const vector<size_t> chunks = {1, 63, 64, 65, 130, 7, 128, 0, 200, 3, 61, 500};
+  size_t total = 0;
+  for (const size_t len: chunks) {
+    total += len;
+  }
+
+  const Prg::Seed seed = seedOf(VECTORS[4].key);
+  Prg bulk(seed, VECTORS[4].stream);
+  const vector<unsigned char> expected = keystream(bulk, total);
+  const vector<unsigned char> known = fromHex(VECTORS[4].keystream);
+  ASSERT_TRUE(equal(known.begin(), known.end(), expected.begin()));
+
+  Prg chunked(seed, VECTORS[4].stream);
+  size_t done = 0;
+  for (const size_t len: chunks) {
+    EXPECT_EQ(keystream(chunked, len),
+              vector<unsigned char>(expected.begin() + done,
+                                    expected.begin() + done + len))
+        << "chunk of " << len << " bytes at " << done;
+    done += len;
+  }
+}
+
+TEST(Prg, NextWords) {
+  const Prg::Seed seed = seedOf(VECTORS[4].key);
+  Prg bytes(seed, VECTORS[4].stream);
+  const vector<unsigned char> expected = keystream(bytes, 8 * 20 + 5);
+
+  /* Words straddle blocks after an unaligned read */
+  Prg words(seed, VECTORS[4].stream);
+  EXPECT_EQ(keystream(words, 5), vector<unsigned char>(expected.begin(),
+                                                       expected.begin() + 5));
+  for (unsigned int i = 0; i < 20; ++i) {
+    uint64_t word = 0;
+    for (int k = 7; k >= 0; --k) {
+      word = (word << 8) | expected[5 + 8 * i + k];
+    }
+    EXPECT_EQ(words.next(), word) << "word " << i;
+  }
+}
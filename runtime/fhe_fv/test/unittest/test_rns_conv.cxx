@@ -0,0 +1,267 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_rns_conv.cxx
+ * @brief RNS base conversion and scaling against big integer arithmetic
+ */
+
+#include "rns_base.hxx"
+#include "rns_conv.hxx"
+
+#include <flint/fmpz.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const unsigned int PRIME_BITSIZE = 60;
+
+/* Integers given with fmpz, cleared with the object */
+class Integers {
+  public:
+    vector<fmpz> values;
+    /* tolerate a result off by one step (a for conversions, 1 for
+        scalings) at rounding boundaries */
+    vector<bool> boundary;
+
+    Integers() = default;
+    Integers(const Integers&) = delete;
+    ~Integers() {
+      for (fmpz& x: values) {
+        fmpz_clear(&x);
+      }
+    }
+
+    void add(const fmpz_t x, const bool isBoundary = false) {
+      values.emplace_back();
+      fmpz_init_set(&values.back(), x);
+      boundary.push_back(isBoundary);
+    }
+};
+
+/* Uniform integer in [0;m) */
+static void randomInteger(fmpz_t x, mt19937_64& rng, const fmpz_t m) {
+  fmpz_zero(x);
+  for (slong i = 0; i <= (slong)fmpz_bits(m) / 64; ++i) {
+    fmpz_mul_2exp(x, x, 64);
+    fmpz_add_ui(x, x, rng());
+  }
+  fmpz_mod(x, x, m);
+}
+
+/* Residues of integers limb-wise, reduced or increased by the prime */
+static vector<mp_limb_t> residues(const Integers& xs, const RnsBase& base,
+    const bool reduced) {
+  const unsigned int n = xs.values.size();
+  vector<mp_limb_t> res(base.size() * n);
+  for (unsigned int i = 0; i < base.size(); ++i) {
+    for (unsigned int k = 0; k < n; ++k) {
+      res[i * n + k] = fmpz_fdiv_ui(&xs.values[k], base.prime(i)) +
+                       (reduced ? 0 : base.prime(i));
+    }
+  }
+  return res;
+}
+
+/* Base of the primes [first;first+count) of a list */
+static RnsBase* subBase(const vector<mp_limb_t>& primes,
+    const unsigned int first, const unsigned int count) {
+  return new RnsBase(vector<mp_limb_t>(primes.begin() + first,
+                                       primes.begin() + first + count));
+}
+
+TEST(RnsConv, Convert) {
+  const pair<unsigned int, unsigned int> sizes[] = {{1, 1}, {1, 3}, {2, 3},
+                                                    {4, 2}, {6, 6}};
+  mt19937_64 rng(1);
+  for (const auto& size: sizes) {
+    const vector<mp_limb_t> primes =
+      RnsBase::generatePrimes(size.first + size.second, PRIME_BITSIZE, 2);
+    unique_ptr<RnsBase> from(subBase(primes, 0, size.first));
+    unique_ptr<RnsBase> to(subBase(primes, size.first, size.second));
+    const RnsConv conv(*from, *to);
+    const fmpz* const a = from->modulus();
+
+    fmpz_t x, half, delta;
+    fmpz_init(x);
+    fmpz_init(half);
+    fmpz_init(delta);
+    Integers xs;
+    for (unsigned int k = 0; k < 64; ++k) {
+      randomInteger(x, rng, a);
+      xs.add(x);
+    }
+    fmpz_zero(x);
+    xs.add(x);
+    fmpz_one(x);
+    xs.add(x);
+    fmpz_sub_ui(x, a, 1);
+    xs.add(x);
+
+    /* a is odd, (a-1)/2 and (a+1)/2 are the centered representatives
+        closest to a/2 and -a/2 */
+    fmpz_fdiv_q_2exp(half, a, 1);
+    xs.add(half, true);
+    fmpz_add_ui(x, half, 1);
+    xs.add(x, true);
+
+    /* 2^-50.a away from a/2 the representative is exact */
+    fmpz_fdiv_q_2exp(delta, a, 50);
+    fmpz_add_ui(delta, delta, 1);
+    fmpz_sub(x, half, delta);
+    xs.add(x);
+    fmpz_add(x, half, delta);
+    fmpz_add_ui(x, x, 1);
+    xs.add(x);
+
+    const unsigned int n = xs.values.size();
+    for (const bool reduced: {true, false}) {
+      const vector<mp_limb_t> src = residues(xs, *from, reduced);
+      vector<mp_limb_t> dst(to->size() * n);
+      conv.convert(dst.data(), src.data(), n);
+
+      for (unsigned int k = 0; k < n; ++k) {
+        /* centered representative of x and the other one */
+        fmpz_set(x, &xs.values[k]);
+        fmpz_mul_2exp(delta, x, 1);
+        if (fmpz_cmp(delta, a) > 0) fmpz_sub(x, x, a);
+        fmpz_set(delta, x);
+        if (fmpz_sgn(delta) > 0) {
+          fmpz_sub(delta, delta, a);
+        } else {
+          fmpz_add(delta, delta, a);
+        }
+
+        for (unsigned int j = 0; j < to->size(); ++j) {
+          const mp_limb_t c = to->prime(j);
+          const mp_limb_t exact = fmpz_fdiv_ui(x, c);
+          const mp_limb_t other = fmpz_fdiv_ui(delta, c);
+          const mp_limb_t res = dst[j * n + k];
+          EXPECT_TRUE(res == exact or (xs.boundary[k] and res == other))
+              << size.first << " to " << size.second << " primes, input "
+              << k << ", prime " << j << (reduced ? "" : ", unreduced");
+        }
+      }
+    }
+
+    fmpz_clear(x);
+    fmpz_clear(half);
+    fmpz_clear(delta);
+  }
+}
+
+TEST(RnsScale, Scale) {
+  /* kept and dropped primes, dropped primes first or last */
+  const struct {
+    unsigned int keep, drop;
+    bool dropFirst;
+  } sizes[] = {{1, 1, false}, {2, 1, false}, {1, 3, true},
+               {3, 2, false}, {2, 4, true}, {5, 5, false}};
+  const mp_limb_t ts[] = {1, 2, 65537};
+
+  mt19937_64 rng(2);
+  for (const auto& size: sizes) {
+    const vector<mp_limb_t> primes =
+      RnsBase::generatePrimes(size.keep + size.drop, PRIME_BITSIZE, 2);
+    unique_ptr<RnsBase> keep(subBase(primes, 0, size.keep));
+    unique_ptr<RnsBase> drop(subBase(primes, size.keep, size.drop));
+    unique_ptr<RnsBase> base(size.dropFirst ? new RnsBase(*drop, *keep)
+                                            : new RnsBase(*keep, *drop));
+    const fmpz* const m = base->modulus();
+    const fmpz* const d = drop->modulus();
+
+    for (const mp_limb_t t: ts) {
+      const RnsScale scale(*base, *keep, t);
+
+      fmpz_t x, y, q, delta;
+      fmpz_init(x);
+      fmpz_init(y);
+      fmpz_init(q);
+      fmpz_init(delta);
+      Integers xs;
+      for (unsigned int k = 0; k < 64; ++k) {
+        randomInteger(x, rng, m);
+        xs.add(x);
+      }
+      fmpz_zero(x);
+      xs.add(x);
+      fmpz_sub_ui(x, m, 1);
+      xs.add(x);
+
+      /* t.x/d closest to the half-integers j+1/2, from below and above,
+          and 2^-50 away from them */
+      fmpz_fdiv_q_2exp(delta, d, 50);
+      fmpz_add_ui(delta, delta, 1);
+      for (unsigned int k = 0; k < 8; ++k) {
+        randomInteger(y, rng, keep->modulus());
+        fmpz_mul_2exp(y, y, 1);
+        fmpz_add_ui(y, y, 1);
+        fmpz_mul(y, y, d);
+        fmpz_fdiv_q_ui(q, y, 2 * t);
+        xs.add(q, true);
+        fmpz_add_ui(x, q, 1);
+        xs.add(x, true);
+        fmpz_sub(x, q, delta);
+        xs.add(x);
+        fmpz_add(x, q, delta);
+        xs.add(x);
+      }
+
+      const unsigned int n = xs.values.size();
+      for (const bool reduced: {true, false}) {
+        const vector<mp_limb_t> src = residues(xs, *base, reduced);
+        vector<mp_limb_t> dst(keep->size() * n);
+        scale.scale(dst.data(), src.data(), n);
+
+        for (unsigned int k = 0; k < n; ++k) {
+          /* round(t.x/d) = floor((2.t.x + d)/2d), and floor(t.x/d) */
+          fmpz_mul_ui(x, &xs.values[k], 2 * t);
+          fmpz_add(x, x, d);
+          fmpz_mul_2exp(y, d, 1);
+          fmpz_fdiv_q(q, x, y);
+          fmpz_mul_ui(x, &xs.values[k], t);
+          fmpz_fdiv_q(y, x, d);
+
+          for (unsigned int j = 0; j < keep->size(); ++j) {
+            const mp_limb_t p = keep->prime(j);
+            const mp_limb_t exact = fmpz_fdiv_ui(q, p);
+            const mp_limb_t down = fmpz_fdiv_ui(y, p);
+            const mp_limb_t res = dst[j * n + k];
+            EXPECT_TRUE(res == exact or (xs.boundary[k] and
+                                         (res == down or res == (down + 1) % p)))
+                << size.keep << " kept and " << size.drop
+                << " dropped primes, t " << t << ", input " << k
+                << ", prime " << j << (reduced ? "" : ", unreduced");
+          }
+        }
+      }
+
+      fmpz_clear(x);
+      fmpz_clear(y);
+      fmpz_clear(q);
+      fmpz_clear(delta);
+    }
+  }
+}
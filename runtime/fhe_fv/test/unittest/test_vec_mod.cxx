@@ -0,0 +1,159 @@
+/*
+    (C) Copyright 2017 CEA LIST. All Rights Reserved.
+    Contributor(s): Cingulata team
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * @file test_vec_mod.cxx
+ * @brief Vector kernels against the scalar ones
+ */
+
+#include "rns_base.hxx"
+#include "vec_mod.hxx"
+
+#include <flint/ulong_extras.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using namespace std;
+
+typedef vector<mp_limb_t> Words;
+
+/* Lengths with every tail of 4- and 8-wide vectors */
+static const slong LENGTHS[] = {0, 1, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 31, 1021};
+
+/* Largest prime of each bit-size, up to the 62 bits kernels allow */
+static vector<mp_limb_t> primes() {
+  vector<mp_limb_t> res;
+  for (const unsigned int bits: {13u, 20u, 31u, 32u, 33u, 45u, 60u, 61u, 62u}) {
+    res.push_back(RnsBase::generatePrimes(1, bits, 2)[0]);
+  }
+  return res;
+}
+
+/* Words below bound, with the extreme values first */
+static Words randomWords(mt19937_64& rng, const slong len, const mp_limb_t bound) {
+  Words res(len);
+  for (slong i = 0; i < len; ++i) {
+    res[i] = i == 0 ? bound - 1 : i == 1 ? 0 : rng() % bound;
+  }
+  return res;
+}
+
+class VecModKernels: public ::testing::TestWithParam<VecMod::Isa> {
+  protected:
+    void SetUp() override {
+      VecMod::select(GetParam());
+      if (VecMod::isa() != GetParam()) {
+        VecMod::select(VecMod::AVX512);
+        GTEST_SKIP() << "not supported by the CPU";
+      }
+    }
+
+    void TearDown() override {
+      VecMod::select(VecMod::AVX512);
+    }
+
+    /* Run a kernel with the scalar and the tested implementation */
+    template <class Kernel>
+    void compare(const slong len, const mp_limb_t p, Kernel kernel) {
+      Words expected(len), res(len);
+      VecMod::select(VecMod::SCALAR);
+      kernel(expected.data());
+      VecMod::select(GetParam());
+      kernel(res.data());
+      EXPECT_EQ(res, expected) << "length " << len << ", prime " << p;
+    }
+};
+
+TEST_P(VecModKernels, Reduced) {
+  mt19937_64 rng(1);
+  for (const mp_limb_t p: primes()) {
+    for (const slong len: LENGTHS) {
+      const Words a = randomWords(rng, len, p);
+      const Words b = randomWords(rng, len, p);
+      const mp_limb_t c = rng() % p;
+      const mp_limb_t c_shoup = VecMod::shoup(c, p);
+
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::add(res, a.data(), b.data(), len, p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::sub(res, a.data(), b.data(), len, p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::neg(res, a.data(), len, p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::add_lazy(res, a.data(), b.data(), len); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::sub_lazy(res, a.data(), b.data(), len, 2 * p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::scalar_mul(res, a.data(), len, c, c_shoup, p); });
+    }
+  }
+}
+
+TEST_P(VecModKernels, Lazy) {
+  mt19937_64 rng(2);
+  for (const mp_limb_t p: primes()) {
+    /* lazyBound().p, the largest multiple of p below 2^64 */
+    const mp_limb_t lazy = (~UWORD(0) / p) * p;
+    for (const slong len: LENGTHS) {
+      const Words a = randomWords(rng, len, 2 * p);
+      const Words x = randomWords(rng, len, lazy);
+      const Words y = randomWords(rng, len, lazy);
+      const mp_limb_t c = rng() % p;
+      const mp_limb_t c_shoup = VecMod::shoup(c, p);
+
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::reduce(res, a.data(), len, p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::scalar_mul(res, x.data(), len, c, c_shoup, p); });
+      compare(len, p, [&](mp_limb_t* res) {
+        VecMod::scalar_mul(res, x.data(), len, 1, VecMod::shoup(1, p), p); });
+    }
+  }
+}
+
+TEST_P(VecModKernels, Mul) {
+  mt19937_64 rng(3);
+  for (const mp_limb_t p: primes()) {
+    nmod_t mod;
+    nmod_init(&mod, p);
+    const mp_limb_t lazy = (~UWORD(0) / p) * p;
+    for (const slong len: LENGTHS) {
+      for (const mp_limb_t bound: {p, lazy}) {
+        const Words a = randomWords(rng, len, bound);
+        const Words b = randomWords(rng, len, bound);
+        compare(len, p, [&](mp_limb_t* res) {
+          VecMod::mul(res, a.data(), b.data(), len, mod); });
+
+        /* in place, and against 128-bit arithmetic */
+        Words res = a;
+        VecMod::mul(res.data(), res.data(), b.data(), len, mod);
+        for (slong i = 0; i < len; ++i) {
+          ASSERT_EQ(res[i], (mp_limb_t)((unsigned __int128)a[i] * b[i] % p))
+              << "index " << i << ", length " << len << ", prime " << p;
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(, VecModKernels,
+                        ::testing::Values(VecMod::SCALAR, VecMod::AVX2, VecMod::AVX512));